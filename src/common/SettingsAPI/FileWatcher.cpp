@@ -1,30 +1,65 @@
 #include "pch.h"
 #include "FileWatcher.h"
 #include <utils/winapi_error.h>
+#include <wil/win32_helpers.h>
 
-std::optional<FILETIME> FileWatcher::MyFileTime()
+std::optional<std::string> FileWatcher::ReadContent() const
 {
-    HANDLE hFile = CreateFileW(m_path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-    std::optional<FILETIME> result;
-    if (hFile != INVALID_HANDLE_VALUE)
+    // The writer may still have the file open, share everything
+    wil::unique_hfile file{ CreateFileW(m_path.c_str(), GENERIC_READ, FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr) };
+    if (!file)
     {
-        FILETIME lastWrite;
-        if (GetFileTime(hFile, nullptr, nullptr, &lastWrite))
-        {
-            result = lastWrite;
-        }
+        return std::nullopt;
+    }
 
-        CloseHandle(hFile);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file.get(), &size) || size.QuadPart > MAXDWORD)
+    {
+        return std::nullopt;
     }
 
-    return result;
+    std::string content(static_cast<size_t>(size.QuadPart), '\0');
+    DWORD bytesRead = 0;
+    if (!ReadFile(file.get(), content.data(), static_cast<DWORD>(content.size()), &bytesRead, nullptr))
+    {
+        return std::nullopt;
+    }
+    content.resize(bytesRead);
+    return content;
 }
 
-FileWatcher::FileWatcher(const std::wstring& path, std::function<void()> callback) :
+FileWatcher::FileWatcher(const std::wstring& path, std::function<void()> callback, std::chrono::milliseconds debounceWindow) :
     m_path(path),
+    m_debounceWindow(debounceWindow),
     m_callback(callback)
 {
-    std::filesystem::path fsPath(path);
+    Start();
+}
+
+FileWatcher::FileWatcher(const std::wstring& path, JsonCallback callback, std::chrono::milliseconds debounceWindow) :
+    m_path(path),
+    m_debounceWindow(debounceWindow),
+    m_jsonCallback(callback)
+{
+    Start();
+}
+
+void FileWatcher::Start()
+{
+    // Changes are compared with the content at the time the watcher starts
+    if (auto content = ReadContent())
+    {
+        m_contentHash = std::hash<std::string>{}(*content);
+    }
+
+    m_debounceTimer.reset(CreateThreadpoolTimer(DebounceTimerCallback, this, nullptr));
+    if (!m_debounceTimer)
+    {
+        Logger::error(L"Failed to create the debounce timer for path {}. {}", m_path, get_last_error_or_default(GetLastError()));
+        return;
+    }
+
+    std::filesystem::path fsPath(m_path);
     m_file_name = fsPath.filename();
     std::transform(m_file_name.begin(), m_file_name.end(), m_file_name.begin(), ::towlower);
     m_folder_change_reader = wil::make_folder_change_reader_nothrow(
@@ -35,32 +70,150 @@ FileWatcher::FileWatcher(const std::wstring& path, std::function<void()> callbac
             std::wstring lowerFileName(fileName);
             std::transform(lowerFileName.begin(), lowerFileName.end(), lowerFileName.begin(), ::towlower);
 
-            if (m_file_name.compare(fileName) == 0)
+            if (m_file_name.compare(lowerFileName) == 0)
             {
-                auto lastWrite = MyFileTime();
-                if (!m_lastWrite.has_value())
-                {
-                    m_lastWrite = lastWrite;
-                }
-                else if (lastWrite.has_value())
-                {
-                    if (m_lastWrite->dwHighDateTime != lastWrite->dwHighDateTime ||
-                        m_lastWrite->dwLowDateTime != lastWrite->dwLowDateTime)
-                    {
-                        m_lastWrite = lastWrite;
-                        m_callback();
-                    }
-                }
+                ArmDebounceTimer();
             }
         });
 
     if (!m_folder_change_reader)
     {
-        Logger::error(L"Failed to start folder change reader for path {}. {}", path, get_last_error_or_default(GetLastError()));
+        Logger::error(L"Failed to start folder change reader for path {}. {}", m_path, get_last_error_or_default(GetLastError()));
+    }
+}
+
+void FileWatcher::ArmDebounceTimer()
+{
+    // Restarts the window if it is already running
+    FILETIME dueTime = wil::filetime::from_int64(-static_cast<int64_t>(wil::filetime_duration::one_millisecond * m_debounceWindow.count()));
+    SetThreadpoolTimer(m_debounceTimer.get(), &dueTime, 0, 0);
+}
+
+void CALLBACK FileWatcher::DebounceTimerCallback(PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER)
+{
+    static_cast<FileWatcher*>(context)->OnDebounceElapsed();
+}
+
+void FileWatcher::OnDebounceElapsed()
+{
+    // The timer can elapse again while the callback runs
+    std::lock_guard lock{ m_mutex };
+
+    auto content = ReadContent();
+    if (!content)
+    {
+        const DWORD error = GetLastError();
+        if (m_stopped)
+        {
+            return;
+        }
+
+        if (m_readRetries < MaxReadRetries)
+        {
+            m_readRetries++;
+            ArmDebounceTimer();
+        }
+        else
+        {
+            Logger::warn(L"Failed to read {} after {} retries. {}", m_path, MaxReadRetries, get_last_error_or_default(error));
+            m_readRetries = 0;
+        }
+        return;
+    }
+    m_readRetries = 0;
+
+    const size_t contentHash = std::hash<std::string>{}(*content);
+    if (m_contentHash == contentHash)
+    {
+        return;
+    }
+    m_contentHash = contentHash;
+
+    if (m_callback)
+    {
+        m_callback();
+    }
+
+    if (m_jsonCallback)
+    {
+        try
+        {
+            const auto settings = json::JsonValue::Parse(winrt::to_hstring(*content)).GetObjectW();
+            m_jsonCallback(settings);
+        }
+        catch (const winrt::hresult_error& e)
+        {
+            Logger::warn(L"Failed to parse {}. {}", m_path, e.message());
+        }
     }
 }
 
 FileWatcher::~FileWatcher()
 {
+    // Stop the events first, they arm the timer
     m_folder_change_reader.reset();
+    {
+        // A failed read arms the timer again from its callback
+        std::lock_guard lock{ m_mutex };
+        m_stopped = true;
+    }
+    m_debounceTimer.reset();
+}
+
+namespace
+{
+    struct SharedJsonWatcher
+    {
+        std::mutex mutex;
+        std::map<size_t, FileWatcher::JsonCallback> callbacks;
+        size_t nextId = 0;
+        std::unique_ptr<FileWatcher> watcher;
+    };
+
+    std::mutex sharedWatchersMutex;
+    std::map<std::wstring, std::weak_ptr<SharedJsonWatcher>> sharedWatchers;
+}
+
+std::shared_ptr<void> FileWatcher::SubscribeJson(const std::wstring& path, JsonCallback callback)
+{
+    std::wstring key = path;
+    std::transform(key.begin(), key.end(), key.begin(), ::towlower);
+
+    std::shared_ptr<SharedJsonWatcher> shared;
+    {
+        std::lock_guard lock{ sharedWatchersMutex };
+
+        // Drop the entries of files nobody watches anymore, so the map doesn't grow with every file ever watched
+        std::erase_if(sharedWatchers, [](const auto& entry) { return entry.second.expired(); });
+
+        shared = sharedWatchers[key].lock();
+        if (!shared)
+        {
+            shared = std::make_shared<SharedJsonWatcher>();
+
+            // The watcher is owned by the shared state, so it can only see it alive
+            shared->watcher = std::make_unique<FileWatcher>(path, [state = shared.get()](const json::JsonObject& settings) {
+                std::lock_guard lock{ state->mutex };
+                for (const auto& [id, subscriber] : state->callbacks)
+                {
+                    subscriber(settings);
+                }
+            });
+            sharedWatchers[key] = shared;
+        }
+    }
+
+    size_t id;
+    {
+        std::lock_guard lock{ shared->mutex };
+        id = shared->nextId++;
+        shared->callbacks.emplace(id, std::move(callback));
+    }
+
+    // Holds the shared watcher alive until the last subscription ends. Must not be released
+    // from the callback.
+    return std::shared_ptr<void>(shared.get(), [shared, id](void*) {
+        std::lock_guard lock{ shared->mutex };
+        shared->callbacks.erase(id);
+    });
 }
@@ -4,24 +4,64 @@
 #define NOMINMAX
 #include <Windows.h>
 
+#include <chrono>
 #include <thread>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <functional>
+#include <vector>
 
 #include <wil/resource.h>
 #include <wil/filesystem.h>
 
+#include "../utils/json.h"
+
+// Calls back when the content of a file changes. Writes within the debounce window of each
+// other are handled once, after the last one, and writes that leave the content as it was
+// are ignored.
 class FileWatcher
 {
+public:
+    using JsonCallback = std::function<void(const json::JsonObject&)>;
+
+    static constexpr std::chrono::milliseconds DefaultDebounceWindow{ 100 };
+
+    // The writer may still hold the file exclusively when the window ends, the read is then
+    // retried after another window.
+    static constexpr int MaxReadRetries = 5;
+
+    FileWatcher(const std::wstring& path, std::function<void()> callback, std::chrono::milliseconds debounceWindow = DefaultDebounceWindow);
+
+    // The callback gets the content parsed as JSON. Content that isn't a JSON object is skipped.
+    FileWatcher(const std::wstring& path, JsonCallback callback, std::chrono::milliseconds debounceWindow = DefaultDebounceWindow);
+
+    ~FileWatcher();
+
+    // Watchers of the same file subscribed this way share a single FileWatcher, which reads
+    // and parses the file once per change for all of them. The subscription ends when the
+    // returned object is destroyed.
+    static std::shared_ptr<void> SubscribeJson(const std::wstring& path, JsonCallback callback);
+
+private:
     std::wstring m_path;
     std::wstring m_file_name;
-    std::optional<FILETIME> m_lastWrite;
+    std::chrono::milliseconds m_debounceWindow;
+    std::mutex m_mutex;
+    std::optional<size_t> m_contentHash;
+    int m_readRetries = 0;
+    bool m_stopped = false;
     std::function<void()> m_callback;
+    JsonCallback m_jsonCallback;
+    wil::unique_threadpool_timer_nothrow m_debounceTimer;
     wil::unique_folder_change_reader_nothrow m_folder_change_reader;
 
-    std::optional<FILETIME> MyFileTime();
-public:
-    FileWatcher(const std::wstring& path, std::function<void()> callback);
-    ~FileWatcher();
+    void Start();
+    void ArmDebounceTimer();
+    void OnDebounceElapsed();
+    std::optional<std::string> ReadContent() const;
+
+    static void CALLBACK DebounceTimerCallback(PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER);
 };
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include <common/interop/async_message_queue.h>
+
+#include <chrono>
+#include <format>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    TEST_CLASS (AsyncMessageQueueTests)
+    {
+    public:
+        TEST_METHOD (MessagesArePoppedInOrder)
+        {
+            AsyncMessageQueue queue;
+            queue.queue_message(L"first");
+            queue.queue_message(L"second");
+
+            Assert::AreEqual(std::wstring(L"first"), queue.pop_message());
+            Assert::AreEqual(std::wstring(L"second"), queue.pop_message());
+        }
+
+        TEST_METHOD (PopBatchReturnsAllAvailableMessages)
+        {
+            AsyncMessageQueue queue;
+            queue.queue_message(L"first");
+            queue.queue_message(L"second");
+            queue.queue_message(L"third");
+
+            auto messages = queue.pop_batch();
+            Assert::AreEqual(size_t{ 3 }, messages.size());
+            Assert::AreEqual(std::wstring(L"first"), messages[0]);
+            Assert::AreEqual(std::wstring(L"third"), messages[2]);
+        }
+
+        TEST_METHOD (InterruptWakesWaitingConsumer)
+        {
+            AsyncMessageQueue queue;
+            std::thread interrupter([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                queue.interrupt();
+            });
+
+            Assert::AreEqual(std::wstring(L""), queue.pop_message());
+            Assert::IsTrue(queue.pop_batch().empty());
+            interrupter.join();
+        }
+
+        TEST_METHOD (InterruptDropsPendingMessages)
+        {
+            AsyncMessageQueue queue;
+            queue.queue_message(L"message");
+            queue.interrupt();
+
+            Assert::AreEqual(std::wstring(L""), queue.pop_message());
+        }
+
+        // Every producer's messages must arrive complete and in order. Also reports the throughput
+        // under contention.
+        TEST_METHOD (ConcurrentProducers)
+        {
+            constexpr int messagesPerProducer = 20000;
+            for (const int producerCount : { 1, 2, 4, 8, 16 })
+            {
+                AsyncMessageQueue queue;
+                std::vector<std::thread> producers;
+                const auto start = std::chrono::steady_clock::now();
+                for (int producer = 0; producer < producerCount; producer++)
+                {
+                    producers.emplace_back([&queue, producer] {
+                        for (int i = 0; i < messagesPerProducer; i++)
+                        {
+                            queue.queue_message(std::to_wstring(producer) + L":" + std::to_wstring(i));
+                        }
+                    });
+                }
+
+                std::vector<int> nextMessage(producerCount, 0);
+                int received = 0;
+                while (received < producerCount * messagesPerProducer)
+                {
+                    for (const auto& message : queue.pop_batch())
+                    {
+                        const auto separator = message.find(L':');
+                        const int producer = std::stoi(message.substr(0, separator));
+                        Assert::AreEqual(nextMessage[producer]++, std::stoi(message.substr(separator + 1)));
+                        received++;
+                    }
+                }
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+                for (auto& producer : producers)
+                {
+                    producer.join();
+                }
+
+                Logger::WriteMessage(std::format(L"{} producers: {} messages in {} us\n", producerCount, received, elapsed.count()).c_str());
+            }
+        }
+    };
+}
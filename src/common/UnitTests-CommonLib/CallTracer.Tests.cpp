@@ -0,0 +1,93 @@
+#include "pch.h"
+#include <common/logger/call_tracer.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <winrt/Windows.Data.Json.h>
+
+using Microsoft::VisualStudio::CppUnitTestFramework::Assert;
+using namespace winrt::Windows::Data::Json;
+
+namespace UnitTestsCommonLib
+{
+    void TracedInner()
+    {
+        _TRACER_;
+    }
+
+    void TracedOuter()
+    {
+        _TRACER_;
+        TracedInner();
+    }
+
+    TEST_CLASS (CallTracerTests)
+    {
+        std::filesystem::path m_file;
+
+        JsonArray ExportEvents()
+        {
+            Assert::IsTrue(CallTracer::exportChromeTrace(m_file));
+
+            std::ifstream file{ m_file, std::ios::binary };
+            std::string content{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+            return JsonObject::Parse(winrt::to_hstring(content)).GetNamedArray(L"traceEvents");
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_file = std::filesystem::temp_directory_path() / (L"CallTracerTests" + std::to_wstring(GetCurrentProcessId()) + L".json");
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            CallTracer::stopSpanRecording();
+
+            std::error_code error;
+            std::filesystem::remove(m_file, error);
+        }
+
+        TEST_METHOD (SpansAreExportedInCallOrder)
+        {
+            CallTracer::startSpanRecording();
+            TracedOuter();
+            CallTracer::stopSpanRecording();
+
+            const auto events = ExportEvents();
+            Assert::AreEqual(4u, events.Size());
+
+            const wchar_t* expected[][2] = { { L"B", L"TracedOuter" }, { L"B", L"TracedInner" }, { L"E", L"TracedInner" }, { L"E", L"TracedOuter" } };
+            for (uint32_t i = 0; i < events.Size(); i++)
+            {
+                const auto event = events.GetObjectAt(i);
+                Assert::AreEqual(std::wstring{ expected[i][0] }, std::wstring{ event.GetNamedString(L"ph") });
+                Assert::IsTrue(std::wstring{ event.GetNamedString(L"name") }.ends_with(expected[i][1]));
+            }
+        }
+
+        TEST_METHOD (EveryThreadHasItsOwnSpans)
+        {
+            CallTracer::startSpanRecording();
+            TracedOuter();
+            std::thread{ TracedOuter }.join();
+            CallTracer::stopSpanRecording();
+
+            const auto events = ExportEvents();
+            Assert::AreEqual(8u, events.Size());
+            Assert::AreNotEqual(events.GetObjectAt(0).GetNamedNumber(L"tid"), events.GetObjectAt(7).GetNamedNumber(L"tid"));
+        }
+
+        TEST_METHOD (NothingIsRecordedWhenStopped)
+        {
+            CallTracer::startSpanRecording();
+            CallTracer::stopSpanRecording();
+            TracedOuter();
+
+            Assert::AreEqual(0u, ExportEvents().Size());
+        }
+    };
+}
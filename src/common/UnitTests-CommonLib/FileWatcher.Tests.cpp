@@ -0,0 +1,170 @@
+#include "pch.h"
+#include <common/SettingsAPI/FileWatcher.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    constexpr std::chrono::milliseconds TestDebounceWindow{ 50 };
+
+    // A callback that is due arrives well within this
+    constexpr std::chrono::milliseconds CallbackTimeout{ 5000 };
+
+    // Long enough for the folder change events and the debounce window to elapse
+    constexpr std::chrono::milliseconds NoCallbackTimeout{ TestDebounceWindow * 4 };
+
+    // Counts the callbacks and lets the test wait for the next one
+    struct CallbackCounter
+    {
+        std::atomic<int> calls = 0;
+        wil::unique_handle called{ CreateEventW(nullptr, false, false, nullptr) };
+
+        void Notify()
+        {
+            calls++;
+            SetEvent(called.get());
+        }
+
+        bool WaitForCall(const std::chrono::milliseconds timeout = CallbackTimeout) const
+        {
+            return WaitForSingleObject(called.get(), static_cast<DWORD>(timeout.count())) == WAIT_OBJECT_0;
+        }
+    };
+
+    void WriteContent(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream{ path, std::ios::binary | std::ios::trunc } << content;
+    }
+
+    TEST_CLASS (FileWatcherTests)
+    {
+        std::filesystem::path m_directory;
+        std::filesystem::path m_file;
+
+    public:
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_directory = std::filesystem::temp_directory_path() / (L"FileWatcherTests" + std::to_wstring(GetCurrentProcessId()));
+            std::filesystem::create_directories(m_directory);
+            m_file = m_directory / L"settings.json";
+            WriteContent(m_file, "{\"value\":0}");
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_directory, error);
+        }
+
+        TEST_METHOD (BurstOfWritesIsHandledOnce)
+        {
+            CallbackCounter counter;
+            FileWatcher watcher(m_file, [&] { counter.Notify(); }, TestDebounceWindow);
+
+            for (int i = 1; i <= 5; i++)
+            {
+                WriteContent(m_file, "{\"value\":" + std::to_string(i) + "}");
+            }
+
+            Assert::IsTrue(counter.WaitForCall());
+            Assert::IsFalse(counter.WaitForCall(NoCallbackTimeout));
+            Assert::AreEqual(1, counter.calls.load());
+        }
+
+        TEST_METHOD (UnchangedContentIsSkipped)
+        {
+            CallbackCounter counter;
+            FileWatcher watcher(m_file, [&] { counter.Notify(); }, TestDebounceWindow);
+
+            WriteContent(m_file, "{\"value\":0}");
+            Assert::IsFalse(counter.WaitForCall(NoCallbackTimeout));
+            Assert::AreEqual(0, counter.calls.load());
+
+            WriteContent(m_file, "{\"value\":1}");
+            Assert::IsTrue(counter.WaitForCall());
+            Assert::AreEqual(1, counter.calls.load());
+        }
+
+        TEST_METHOD (LockedFileIsReadAgain)
+        {
+            CallbackCounter counter;
+            FileWatcher watcher(m_file, [&] { counter.Notify(); }, TestDebounceWindow);
+
+            // The writer keeps the file to itself past the end of the debounce window
+            WriteContent(m_file, "{\"value\":2}");
+            wil::unique_hfile locked{ CreateFileW(m_file.c_str(), GENERIC_READ, 0, nullptr, OPEN_EXISTING, 0, nullptr) };
+            Assert::IsTrue(static_cast<bool>(locked));
+            Assert::IsFalse(counter.WaitForCall(TestDebounceWindow * 2));
+
+            locked.reset();
+            Assert::IsTrue(counter.WaitForCall());
+            Assert::AreEqual(1, counter.calls.load());
+        }
+
+        TEST_METHOD (JsonCallbackGetsParsedContent)
+        {
+            CallbackCounter counter;
+            std::atomic<int> value = -1;
+            FileWatcher watcher(
+                m_file,
+                [&](const json::JsonObject& settings) {
+                    value = static_cast<int>(settings.GetNamedNumber(L"value"));
+                    counter.Notify();
+                },
+                TestDebounceWindow);
+
+            WriteContent(m_file, "not json");
+            Assert::IsFalse(counter.WaitForCall(NoCallbackTimeout));
+            Assert::AreEqual(-1, value.load());
+
+            WriteContent(m_file, "{\"value\":7}");
+            Assert::IsTrue(counter.WaitForCall());
+            Assert::AreEqual(7, value.load());
+        }
+
+        TEST_METHOD (SharedSubscribersAreAllNotified)
+        {
+            CallbackCounter firstCounter;
+            CallbackCounter secondCounter;
+            std::atomic<int> first = 0;
+            std::atomic<int> second = 0;
+            auto firstSubscription = FileWatcher::SubscribeJson(m_file, [&](const json::JsonObject& settings) {
+                first = static_cast<int>(settings.GetNamedNumber(L"value"));
+                firstCounter.Notify();
+            });
+            auto secondSubscription = FileWatcher::SubscribeJson(m_file, [&](const json::JsonObject& settings) {
+                second = static_cast<int>(settings.GetNamedNumber(L"value"));
+                secondCounter.Notify();
+            });
+
+            WriteContent(m_file, "{\"value\":3}");
+            Assert::IsTrue(firstCounter.WaitForCall());
+            Assert::IsTrue(secondCounter.WaitForCall());
+            Assert::AreEqual(3, first.load());
+            Assert::AreEqual(3, second.load());
+
+            secondSubscription.reset();
+            WriteContent(m_file, "{\"value\":4}");
+            Assert::IsTrue(firstCounter.WaitForCall());
+            Assert::AreEqual(4, first.load());
+            Assert::AreEqual(3, second.load());
+            Assert::AreEqual(1, secondCounter.calls.load());
+        }
+
+        TEST_METHOD (SubscriptionAfterTheLastEndedWatchesAgain)
+        {
+            CallbackCounter counter;
+            FileWatcher::SubscribeJson(m_file, [](const json::JsonObject&) {}).reset();
+
+            // The expired entry of the first subscription is replaced by a new watcher
+            auto subscription = FileWatcher::SubscribeJson(m_file, [&](const json::JsonObject&) { counter.Notify(); });
+            WriteContent(m_file, "{\"value\":5}");
+            Assert::IsTrue(counter.WaitForCall());
+        }
+    };
+}
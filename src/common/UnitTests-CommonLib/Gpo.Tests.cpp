@@ -0,0 +1,168 @@
+#include "pch.h"
+#include <common/utils/gpo.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace powertoys_gpo;
+
+namespace UnitTestsCommonLib
+{
+    class FakeRegistryBackend : public policy_registry_backend
+    {
+    public:
+        struct State
+        {
+            policy_registry_key machine;
+            policy_registry_key user;
+            policy_registry_key machine_list;
+            policy_registry_key user_list;
+            bool can_watch = true;
+            HANDLE event = nullptr;
+            int reads = 0;
+        };
+
+        FakeRegistryBackend(State& state) :
+            state(state)
+        {
+        }
+
+        policy_registry_key read_key(HKEY scope, const std::wstring& sub_key) override
+        {
+            state.reads++;
+            if (sub_key == POLICIES_PATH)
+            {
+                return scope == POLICIES_SCOPE_MACHINE ? state.machine : state.user;
+            }
+            return scope == POLICIES_SCOPE_MACHINE ? state.machine_list : state.user_list;
+        }
+
+        bool watch_changes(HANDLE event) override
+        {
+            state.event = event;
+            return state.can_watch;
+        }
+
+    private:
+        State& state;
+    };
+
+    policy_registry_value DwordValue(const std::wstring& name, DWORD value)
+    {
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(&value);
+        return { .name = name, .type = REG_DWORD, .data = { bytes, bytes + sizeof(value) } };
+    }
+
+    policy_registry_value StringValue(const std::wstring& name, const std::wstring& value, DWORD type = REG_SZ)
+    {
+        // Include the terminators, like the registry does
+        std::wstring terminated = value + L'\0';
+        if (type == REG_MULTI_SZ)
+        {
+            terminated += L'\0';
+        }
+        const BYTE* bytes = reinterpret_cast<const BYTE*>(terminated.data());
+        return { .name = name, .type = type, .data = { bytes, bytes + terminated.size() * sizeof(wchar_t) } };
+    }
+
+    policy_registry_key Key(std::vector<policy_registry_value> values)
+    {
+        std::sort(values.begin(), values.end(), [](const auto& lhs, const auto& rhs) { return _wcsicmp(lhs.name.c_str(), rhs.name.c_str()) < 0; });
+        return { .status = ERROR_SUCCESS, .values = std::move(values) };
+    }
+
+    TEST_CLASS (GpoPolicySnapshotTests)
+    {
+    public:
+        TEST_METHOD (MachineValueHasPriorityOverUserValue)
+        {
+            FakeRegistryBackend::State state;
+            state.machine = Key({ DwordValue(L"A", 0) });
+            state.user = Key({ DwordValue(L"A", 1), DwordValue(L"B", 1) });
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            auto snapshot = cache.get();
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_disabled), static_cast<int>(snapshot->configured_value(L"A")));
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_enabled), static_cast<int>(snapshot->configured_value(L"B")));
+        }
+
+        TEST_METHOD (ValueNamesAreCaseInsensitive)
+        {
+            FakeRegistryBackend::State state;
+            state.machine = Key({ DwordValue(L"ConfigureEnabledUtilityPeek", 1) });
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_enabled), static_cast<int>(cache.get()->configured_value(L"configureenabledutilitypeek")));
+        }
+
+        TEST_METHOD (MissingValuesAndKeys)
+        {
+            FakeRegistryBackend::State state;
+            state.machine = Key({ DwordValue(L"Wrong", 2) });
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            auto snapshot = cache.get();
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_wrong_value), static_cast<int>(snapshot->configured_value(L"Wrong")));
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_not_configured), static_cast<int>(snapshot->configured_value(L"Missing")));
+
+            state.user.status = ERROR_ACCESS_DENIED;
+            policy_snapshot_cache deniedCache{ std::make_unique<FakeRegistryBackend>(state) };
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_unavailable), static_cast<int>(deniedCache.get()->configured_value(L"Missing")));
+        }
+
+        TEST_METHOD (StringValues)
+        {
+            FakeRegistryBackend::State state;
+            state.machine = Key({ StringValue(L"Single", L"value"), StringValue(L"Multi", std::wstring(L"first\0second", 12), REG_MULTI_SZ) });
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            auto snapshot = cache.get();
+            Assert::AreEqual(std::wstring(L"value"), *snapshot->machine_policies.string_value(L"Single"));
+            Assert::AreEqual(std::wstring(L"first\r\nsecond"), *snapshot->machine_policies.string_value(L"Multi", true));
+            Assert::IsFalse(snapshot->machine_policies.string_value(L"Single", true).has_value());
+            Assert::IsFalse(snapshot->machine_policies.string_value(L"Missing").has_value());
+        }
+
+        TEST_METHOD (ExpandableStringValuesAreExpanded)
+        {
+            SetEnvironmentVariableW(L"GPO_TESTS_FOLDER", L"C:\\Templates");
+            FakeRegistryBackend::State state;
+            state.machine = Key({ StringValue(L"Expand", L"%GPO_TESTS_FOLDER%\\New", REG_EXPAND_SZ) });
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            auto snapshot = cache.get();
+            Assert::AreEqual(std::wstring(L"C:\\Templates\\New"), *snapshot->machine_policies.string_value(L"Expand"));
+            Assert::IsFalse(snapshot->machine_policies.string_value(L"Expand", true).has_value());
+            SetEnvironmentVariableW(L"GPO_TESTS_FOLDER", nullptr);
+        }
+
+        TEST_METHOD (SnapshotIsReusedUntilTheRegistryChanges)
+        {
+            FakeRegistryBackend::State state;
+            state.machine = Key({ DwordValue(L"A", 0) });
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            auto first = cache.get();
+            const int reads = state.reads;
+            Assert::IsTrue(first == cache.get());
+            Assert::AreEqual(reads, state.reads);
+
+            state.machine = Key({ DwordValue(L"A", 1) });
+            SetEvent(state.event);
+
+            auto second = cache.get();
+            Assert::IsTrue(first != second);
+            Assert::AreEqual(static_cast<int>(gpo_rule_configured_enabled), static_cast<int>(second->configured_value(L"A")));
+        }
+
+        TEST_METHOD (RegistryIsReadEveryTimeWhenChangesCantBeWatched)
+        {
+            FakeRegistryBackend::State state;
+            state.can_watch = false;
+            policy_snapshot_cache cache{ std::make_unique<FakeRegistryBackend>(state) };
+
+            cache.get();
+            const int reads = state.reads;
+            cache.get();
+            Assert::AreEqual(reads * 2, state.reads);
+        }
+    };
+}
@@ -0,0 +1,262 @@
+#include "pch.h"
+#include <common/hooks/HotkeyDispatch.h>
+
+#include <bitset>
+#include <chrono>
+#include <compare>
+#include <format>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace HotkeyDispatch;
+
+namespace UnitTestsCommonLib
+{
+    struct TestHotkey
+    {
+        bool win = false;
+        bool ctrl = false;
+        bool shift = false;
+        bool alt = false;
+        unsigned char key = 0;
+
+        std::strong_ordering operator<=>(const TestHotkey&) const = default;
+    };
+
+    struct TestHotkeyDescriptor
+    {
+        TestHotkey hotkey;
+        std::wstring name;
+    };
+
+    struct RecordedEvent
+    {
+        DWORD vkCode;
+        WPARAM message;
+        bool seenByHook = true; // The hook doesn't see the keys pressed on another desktop
+    };
+
+    // A session with the runner's default hotkeys. The user types, invokes PowerToys Run, Color
+    // Picker, locks the screen with Ctrl held and releases it there, then presses Win and Ctrl on
+    // the lock screen and keeps holding them after unlocking.
+    const std::vector<RecordedEvent> RecordedSession = {
+        { VK_LSHIFT, WM_KEYDOWN },
+        { 'H', WM_KEYDOWN },
+        { 'H', WM_KEYUP },
+        { VK_LSHIFT, WM_KEYUP },
+        { 'I', WM_KEYDOWN },
+        { 'I', WM_KEYUP },
+
+        { VK_LMENU, WM_SYSKEYDOWN },
+        { VK_SPACE, WM_SYSKEYDOWN },
+        { VK_SPACE, WM_SYSKEYUP },
+        { VK_LMENU, WM_KEYUP },
+
+        { VK_LWIN, WM_KEYDOWN },
+        { VK_LSHIFT, WM_KEYDOWN },
+        { 'C', WM_KEYDOWN },
+        { 'C', WM_KEYUP },
+        { VK_LSHIFT, WM_KEYUP },
+        { VK_LWIN, WM_KEYUP },
+
+        { 'C', WM_KEYDOWN },
+        { 'C', WM_KEYUP },
+        { 'A', WM_KEYDOWN },
+        { 'A', WM_KEYUP },
+        { 'T', WM_KEYDOWN },
+        { 'T', WM_KEYUP },
+
+        { VK_LCONTROL, WM_KEYDOWN },
+        { VK_LWIN, WM_KEYDOWN },
+        { 'L', WM_KEYDOWN },
+        { 'L', WM_KEYUP, false },
+        { VK_LWIN, WM_KEYUP, false },
+        { VK_LCONTROL, WM_KEYUP, false },
+
+        { VK_LWIN, WM_KEYDOWN },
+        { VK_LSHIFT, WM_KEYDOWN },
+        { 'T', WM_KEYDOWN },
+        { 'T', WM_KEYUP },
+        { VK_LSHIFT, WM_KEYUP },
+        { VK_LWIN, WM_KEYUP },
+
+        { VK_RWIN, WM_KEYDOWN, false },
+        { VK_RCONTROL, WM_KEYDOWN, false },
+        { 'T', WM_KEYDOWN },
+        { 'T', WM_KEYUP },
+        { VK_RCONTROL, WM_KEYUP },
+        { VK_RWIN, WM_KEYUP },
+    };
+
+    const std::vector<std::wstring> RecordedSessionMatches = { L"PowerToys Run", L"Color Picker", L"Text Extractor", L"Always On Top" };
+
+    Table<TestHotkeyDescriptor> DefaultHotkeys()
+    {
+        return Table<TestHotkeyDescriptor>{ {
+            { .hotkey = { .alt = true, .key = VK_SPACE }, .name = L"PowerToys Run" },
+            { .hotkey = { .win = true, .shift = true, .key = 'C' }, .name = L"Color Picker" },
+            { .hotkey = { .win = true, .shift = true, .key = 'T' }, .name = L"Text Extractor" },
+            { .hotkey = { .win = true, .ctrl = true, .key = 'T' }, .name = L"Always On Top" },
+        } };
+    }
+
+    // Feeds the events to the modifier state and the table like the runner's hook does, the keyboard
+    // state also sees the events the hook misses.
+    std::vector<std::wstring> Replay(const Table<TestHotkeyDescriptor>& table, std::span<const RecordedEvent> events)
+    {
+        std::bitset<256> keyboard;
+        const KeyStateReader isKeyDown = [&](DWORD vkCode) { return keyboard.test(vkCode); };
+
+        ModifierState modifiers;
+        std::vector<std::wstring> matches;
+        for (const auto& event : events)
+        {
+            const bool keyDown = event.message == WM_KEYDOWN || event.message == WM_SYSKEYDOWN;
+            keyboard.set(event.vkCode, keyDown);
+            if (!event.seenByHook)
+            {
+                continue;
+            }
+
+            modifiers.Update(event.vkCode, event.message);
+            if (keyDown)
+            {
+                if (const auto descriptor = table.Match(modifiers, event.vkCode, isKeyDown))
+                {
+                    matches.push_back(descriptor->name);
+                }
+            }
+        }
+        return matches;
+    }
+
+    TEST_CLASS (HotkeyDispatchTests)
+    {
+    public:
+        TEST_METHOD (FindsHotkeyFromTrackedModifiers)
+        {
+            const auto table = DefaultHotkeys();
+            ModifierState modifiers;
+            modifiers.Update(VK_LWIN, WM_KEYDOWN);
+            modifiers.Update(VK_RSHIFT, WM_KEYDOWN);
+
+            const auto descriptor = table.Find(modifiers, 'C');
+            Assert::IsNotNull(descriptor);
+            Assert::AreEqual(std::wstring{ L"Color Picker" }, descriptor->name);
+
+            modifiers.Update(VK_RSHIFT, WM_KEYUP);
+            Assert::IsNull(table.Find(modifiers, 'C'));
+        }
+
+        TEST_METHOD (SideAgnosticModifiers)
+        {
+            const auto table = DefaultHotkeys();
+            ModifierState modifiers;
+
+            // Injected input may only report VK_MENU
+            modifiers.Update(VK_MENU, WM_SYSKEYDOWN);
+            Assert::IsTrue(modifiers.Alt());
+            Assert::IsNotNull(table.Find(modifiers, VK_SPACE));
+
+            modifiers.Update(VK_MENU, WM_KEYUP);
+            Assert::IsFalse(modifiers.Alt());
+        }
+
+        TEST_METHOD (UnusedKeysDontReadTheKeyboard)
+        {
+            const auto table = DefaultHotkeys();
+            int reads = 0;
+            const KeyStateReader isKeyDown = [&](DWORD) {
+                reads++;
+                return false;
+            };
+
+            ModifierState modifiers;
+            Assert::IsNull(table.Match(modifiers, 'Q', isKeyDown));
+            Assert::AreEqual(0, reads);
+
+            Assert::IsNull(table.Match(modifiers, 'T', isKeyDown));
+            Assert::AreEqual(static_cast<int>(ModifierState::ModifierKeys.size()), reads);
+        }
+
+        TEST_METHOD (MissedKeyUpIsCorrected)
+        {
+            const auto table = DefaultHotkeys();
+            ModifierState modifiers;
+            modifiers.Update(VK_LCONTROL, WM_KEYDOWN);
+            modifiers.Update(VK_LMENU, WM_SYSKEYDOWN);
+
+            // Ctrl was released on the lock screen
+            const auto descriptor = table.Match(modifiers, VK_SPACE, [](DWORD vkCode) { return vkCode == VK_LMENU; });
+            Assert::IsNotNull(descriptor);
+            Assert::AreEqual(std::wstring{ L"PowerToys Run" }, descriptor->name);
+            Assert::IsFalse(modifiers.Ctrl());
+        }
+
+        TEST_METHOD (MissedKeyDownIsCorrected)
+        {
+            const auto table = DefaultHotkeys();
+            ModifierState modifiers;
+
+            // Win and Ctrl were pressed on the lock screen, no modifier is tracked
+            Assert::IsNull(table.Find(modifiers, 'T'));
+            const auto descriptor = table.Match(modifiers, 'T', [](DWORD vkCode) { return vkCode == VK_LCONTROL || vkCode == VK_LWIN; });
+            Assert::IsNotNull(descriptor);
+            Assert::AreEqual(std::wstring{ L"Always On Top" }, descriptor->name);
+        }
+
+        TEST_METHOD (FirstRegistrationWins)
+        {
+            const Table<TestHotkeyDescriptor> table{ {
+                { .hotkey = { .win = true, .key = 'Z' }, .name = L"first" },
+                { .hotkey = { .alt = true, .key = 'Z' }, .name = L"other" },
+                { .hotkey = { .win = true, .key = 'Z' }, .name = L"second" },
+            } };
+            ModifierState modifiers;
+            modifiers.Update(VK_LWIN, WM_KEYDOWN);
+
+            Assert::AreEqual(std::wstring{ L"first" }, table.Find(modifiers, 'Z')->name);
+        }
+
+        TEST_METHOD (EmptyTableMatchesNothing)
+        {
+            const Table<TestHotkeyDescriptor> table;
+            ModifierState modifiers;
+            Assert::IsNull(table.Match(modifiers, 'T', [](DWORD) { return true; }));
+            Assert::IsFalse(table.UsesKey(0xFFFF));
+        }
+
+        TEST_METHOD (ReplayRecordedSession)
+        {
+            Assert::IsTrue(RecordedSessionMatches == Replay(DefaultHotkeys(), RecordedSession));
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(ReplayRecordedSessionTiming)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (ReplayRecordedSessionTiming)
+        {
+            constexpr int Replays = 20000;
+            const auto table = DefaultHotkeys();
+
+            size_t matches = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < Replays; i++)
+            {
+                matches += Replay(table, RecordedSession).size();
+            }
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+            Assert::AreEqual(RecordedSessionMatches.size() * Replays, matches);
+            Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(
+                std::format(L"Replayed {} events {} times, {:.0f} ns per event\n",
+                            RecordedSession.size(),
+                            Replays,
+                            elapsed.count() / (static_cast<double>(Replays) * RecordedSession.size()))
+                    .c_str());
+        }
+    };
+}
@@ -0,0 +1,238 @@
+#include "pch.h"
+#include <common/utils/json.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using Microsoft::VisualStudio::CppUnitTestFramework::Assert;
+
+namespace UnitTestsCommonLib
+{
+    TEST_CLASS (JsonTests)
+    {
+        std::filesystem::path m_file;
+
+        static void AssertSameValue(const json::IJsonValue& expected, const json::IJsonValue& actual)
+        {
+            Assert::IsTrue(expected.ValueType() == actual.ValueType());
+            switch (expected.ValueType())
+            {
+            case json::JsonValueType::Boolean:
+                Assert::AreEqual(expected.GetBoolean(), actual.GetBoolean());
+                break;
+            case json::JsonValueType::Number:
+                Assert::AreEqual(expected.GetNumber(), actual.GetNumber());
+                break;
+            case json::JsonValueType::String:
+                Assert::AreEqual(std::wstring{ expected.GetString() }, std::wstring{ actual.GetString() });
+                break;
+            case json::JsonValueType::Array:
+            {
+                const auto expectedArray = expected.GetArray();
+                const auto actualArray = actual.GetArray();
+                Assert::AreEqual(expectedArray.Size(), actualArray.Size());
+                for (uint32_t i = 0; i < expectedArray.Size(); i++)
+                {
+                    AssertSameValue(expectedArray.GetAt(i), actualArray.GetAt(i));
+                }
+                break;
+            }
+            case json::JsonValueType::Object:
+            {
+                const auto expectedObject = expected.GetObjectW();
+                const auto actualObject = actual.GetObjectW();
+                Assert::AreEqual(expectedObject.Size(), actualObject.Size());
+                for (const auto& pair : expectedObject)
+                {
+                    Assert::IsTrue(actualObject.HasKey(pair.Key()));
+                    AssertSameValue(pair.Value(), actualObject.GetNamedValue(pair.Key()));
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        // Shaped like the FancyZones app zone history, about 1 KB per entry
+        static json::JsonObject BuildDocument(int entries)
+        {
+            json::JsonArray history;
+            for (int i = 0; i < entries; i++)
+            {
+                json::JsonArray zones;
+                for (int zone = 0; zone < 8; zone++)
+                {
+                    zones.Append(json::value(zone));
+                }
+
+                json::JsonObject entry;
+                entry.SetNamedValue(L"app-path", json::value(std::format(L"C:\\Program Files\\Application {}\\app\u00e9\u6587 \"quoted\".exe", i)));
+                entry.SetNamedValue(L"zoneset-uuid", json::value(std::format(L"{{{:08X}-4B3C-4E5A-9D2F-1A2B3C4D5E6F}}", i)));
+                entry.SetNamedValue(L"device-id", json::value(std::format(L"DELA0{}#5&1bc3c3e6&0&UID{}_2560_1440_{{00000000-0000-0000-0000-000000000000}}", i % 10, i)));
+                entry.SetNamedValue(L"zone-index-set", zones);
+                entry.SetNamedValue(L"scale", json::value(1.25 + i / 1000.0));
+                entry.SetNamedValue(L"maximized", json::value(i % 2 == 0));
+                entry.SetNamedValue(L"note", json::value(std::format(L"line one\nline two\ttabbed \U0001F600 {}", std::wstring(600, L'x'))));
+                history.Append(entry);
+            }
+
+            json::JsonObject document;
+            document.SetNamedValue(L"app-zone-history", history);
+            return document;
+        }
+
+        std::string ReadFile() const
+        {
+            std::ifstream file{ m_file, std::ios::binary };
+            return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_file = std::filesystem::temp_directory_path() / (L"JsonTests" + std::to_wstring(GetCurrentProcessId()) + L".json");
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::error_code error;
+            std::filesystem::remove(m_file, error);
+        }
+
+        TEST_METHOD (ParsesLikeWindowsDataJson)
+        {
+            const std::string text = "\xEF\xBB\xBF { \"string\": \"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\\u00e9\\ud83d\\ude00 \xC3\xA9\xE6\x96\x87\xF0\x9F\x98\x80\","
+                                     " \"numbers\": [0, -0, 1, -12.5, 3e2, 1.5E-3, 9007199254740993],"
+                                     " \"literals\": [true, false, null], \"nested\": { \"empty\": {}, \"list\": [] } } ";
+
+            const auto actual = json::stream::parse(text);
+            Assert::IsTrue(static_cast<bool>(actual));
+
+            // Windows.Data.Json rejects the BOM
+            const auto expected = json::JsonValue::Parse(winrt::to_hstring(text.substr(3)));
+            AssertSameValue(expected, actual);
+        }
+
+        TEST_METHOD (MalformedDocumentsAreRejected)
+        {
+            const char* documents[] = { "", " ", "{", "}", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "{a:1}", "[1,]", "[1 2]", "01", "1.", "-", ".5", "1e",
+                                        "tru", "nul", "\"abc", "\"\x01\"", "\"\\x\"", "\"\\u12\"", "{} {}", "[] x" };
+            for (const auto document : documents)
+            {
+                Assert::IsFalse(static_cast<bool>(json::stream::parse(document)), winrt::to_hstring(document).c_str());
+            }
+
+            const std::string deep(100000, '[');
+            Assert::IsFalse(static_cast<bool>(json::stream::parse(deep)));
+        }
+
+        TEST_METHOD (OutOfRangeNumbersAreAccepted)
+        {
+            const auto actual = json::stream::parse("[1e400, -1e400, 1e-400]");
+            Assert::IsTrue(static_cast<bool>(actual));
+
+            const auto numbers = actual.GetArray();
+            Assert::IsTrue(std::isinf(numbers.GetNumberAt(0)) && numbers.GetNumberAt(0) > 0);
+            Assert::IsTrue(std::isinf(numbers.GetNumberAt(1)) && numbers.GetNumberAt(1) < 0);
+            Assert::AreEqual(0.0, numbers.GetNumberAt(2));
+        }
+
+        TEST_METHOD (NumbersAreWrittenLikeStringify)
+        {
+            // Integers must stay plain digits, C# readers reject exponents for integer properties
+            const double numbers[] = { 0, 1, -1, 42, 100000, 1000000, 1760000000, 1760000000123, -1760000000123, 9007199254740991,
+                                       0.5, 0.1, -0.25, 1.25, 123.456, 0.001, 3.0000000000000004, 1.5e-3, 2.0 / 3.0 };
+            json::JsonArray array;
+            for (const auto number : numbers)
+            {
+                array.Append(json::value(number));
+            }
+
+            std::ostringstream written;
+            json::stream::Writer{ written }.write_value(array);
+            Assert::AreEqual(winrt::to_string(array.Stringify()), written.str());
+        }
+
+        TEST_METHOD (FileRoundTripKeepsTheDocument)
+        {
+            const auto document = BuildDocument(100);
+            json::to_file(m_file.wstring(), document);
+
+            const auto content = ReadFile();
+            AssertSameValue(document, json::JsonValue::Parse(winrt::to_hstring(content)));
+
+            const auto read = json::from_file(m_file.wstring());
+            Assert::IsTrue(read.has_value());
+            AssertSameValue(document, *read);
+        }
+
+        TEST_METHOD (UnpairedSurrogatesAreKept)
+        {
+            json::JsonObject document;
+            document.SetNamedValue(L"value", json::value(std::wstring{ L"a\xD800z\xDC00" }));
+            json::to_file(m_file.wstring(), document);
+
+            const auto read = json::from_file(m_file.wstring());
+            Assert::IsTrue(read.has_value());
+            Assert::AreEqual(std::wstring{ L"a\xD800z\xDC00" }, std::wstring{ read->GetNamedString(L"value") });
+        }
+
+        TEST_METHOD (MissingOrInvalidFilesReadAsNothing)
+        {
+            Assert::IsFalse(json::from_file(m_file.wstring()).has_value());
+
+            std::ofstream{ m_file, std::ios::binary } << "[1, 2]";
+            Assert::IsFalse(json::from_file(m_file.wstring()).has_value());
+
+            std::ofstream{ m_file, std::ios::binary } << "";
+            Assert::IsFalse(json::from_file(m_file.wstring()).has_value());
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(FileCostStreamingVsHstring)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (FileCostStreamingVsHstring)
+        {
+            // About 8 MB
+            const auto document = BuildDocument(8000);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::ofstream{ m_file, std::ios::binary } << winrt::to_string(document.Stringify());
+            const auto stringifyWrite = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            const auto content = ReadFile();
+            const auto parsed = json::JsonValue::Parse(winrt::to_hstring(content)).GetObjectW();
+            const auto hstringRead = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            json::to_file(m_file.wstring(), document);
+            const auto streamingWrite = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            const auto read = json::from_file(m_file.wstring());
+            const auto streamingRead = std::chrono::high_resolution_clock::now() - start;
+
+            using std::chrono::duration_cast;
+            using std::chrono::milliseconds;
+            Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(
+                std::format(L"{} MB document: write {} ms with Stringify, {} ms streaming; read {} ms with Parse, {} ms streaming\n",
+                            content.size() / (1024 * 1024),
+                            duration_cast<milliseconds>(stringifyWrite).count(),
+                            duration_cast<milliseconds>(streamingWrite).count(),
+                            duration_cast<milliseconds>(hstringRead).count(),
+                            duration_cast<milliseconds>(streamingRead).count())
+                    .c_str());
+
+            Assert::IsTrue(read.has_value());
+            AssertSameValue(parsed, *read);
+        }
+    };
+}
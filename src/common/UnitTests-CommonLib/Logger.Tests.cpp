@@ -0,0 +1,160 @@
+#include "pch.h"
+#include <common/logger/logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Microsoft::VisualStudio::CppUnitTestFramework::Assert;
+
+namespace UnitTestsCommonLib
+{
+    constexpr int MessageCount = 20000;
+
+    TEST_CLASS (LoggerTests)
+    {
+        std::filesystem::path m_directory;
+
+        std::wstring LogFilePath(const std::wstring& name) const
+        {
+            return (m_directory / name / L"log.log").wstring();
+        }
+
+        std::wstring LogSettingsPath() const
+        {
+            return (m_directory / L"log_settings.json").wstring();
+        }
+
+        // The daily sink adds the date to the file name, so read whatever it created
+        std::vector<std::string> ReadLines(const std::wstring& name) const
+        {
+            std::vector<std::string> lines;
+            for (const auto& entry : std::filesystem::directory_iterator(m_directory / name))
+            {
+                std::ifstream file{ entry.path() };
+                for (std::string line; std::getline(file, line);)
+                {
+                    lines.push_back(line);
+                }
+            }
+            return lines;
+        }
+
+        static size_t CountMessages(const std::vector<std::string>& lines)
+        {
+            return std::count_if(lines.begin(), lines.end(), [](const std::string& line) {
+                return line.find("message ") != std::string::npos;
+            });
+        }
+
+        // Average time the calling thread spends in a log call
+        static std::chrono::nanoseconds LogMessages()
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < MessageCount; i++)
+            {
+                ::Logger::info(L"message {}", i);
+            }
+            return (std::chrono::high_resolution_clock::now() - start) / MessageCount;
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            m_directory = std::filesystem::temp_directory_path() / (L"LoggerTests" + std::to_wstring(GetCurrentProcessId()));
+            std::filesystem::create_directories(m_directory);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            ::Logger::shutdown();
+
+            std::error_code error;
+            std::filesystem::remove_all(m_directory, error);
+        }
+
+        TEST_METHOD (AsyncModeWritesEveryMessageOnShutdown)
+        {
+            ::Logger::init("async-block", LogFilePath(L"block"), LogSettingsPath(), ::Logger::AsyncOptions{});
+            LogMessages();
+            ::Logger::shutdown();
+
+            Assert::AreEqual(static_cast<size_t>(MessageCount), CountMessages(ReadLines(L"block")));
+        }
+
+        TEST_METHOD (DropOldestKeepsTheLatestMessages)
+        {
+            ::Logger::AsyncOptions options;
+            options.queueSize = 16;
+            options.overflowPolicy = ::Logger::AsyncOptions::OverflowPolicy::DropOldest;
+            ::Logger::init("async-drop", LogFilePath(L"drop"), LogSettingsPath(), options);
+            LogMessages();
+            ::Logger::shutdown();
+
+            const auto lines = ReadLines(L"drop");
+            Assert::IsTrue(CountMessages(lines) <= static_cast<size_t>(MessageCount));
+            Assert::IsTrue(lines.back().ends_with(std::format("message {}", MessageCount - 1)));
+        }
+
+        TEST_METHOD (ShutdownWhileOtherThreadsLog)
+        {
+            ::Logger::init("async-shutdown", LogFilePath(L"shutdown"), LogSettingsPath(), ::Logger::AsyncOptions{});
+
+            std::atomic_bool stop = false;
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 4; i++)
+            {
+                threads.emplace_back([&stop] {
+                    for (int message = 0; !stop; message++)
+                    {
+                        ::Logger::info(L"message {}", message);
+                    }
+                });
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            ::Logger::shutdown();
+
+            // The threads keep logging into the stopped logger for a while
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            stop = true;
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            const auto written = CountMessages(ReadLines(L"shutdown"));
+            Assert::IsTrue(written > 0);
+
+            ::Logger::info(L"message after shutdown");
+            Assert::AreEqual(written, CountMessages(ReadLines(L"shutdown")));
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(CallerCostSyncVsAsync)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (CallerCostSyncVsAsync)
+        {
+            ::Logger::init("sync-cost", LogFilePath(L"sync"), LogSettingsPath());
+            const auto syncCost = LogMessages();
+            ::Logger::shutdown();
+
+            ::Logger::init("async-cost", LogFilePath(L"async"), LogSettingsPath(), ::Logger::AsyncOptions{});
+            const auto asyncCost = LogMessages();
+            ::Logger::shutdown();
+
+            Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(
+                std::format(L"Per message caller cost: synchronous {} ns, asynchronous {} ns\n", syncCost.count(), asyncCost.count()).c_str());
+
+            Assert::AreEqual(static_cast<size_t>(MessageCount), CountMessages(ReadLines(L"sync")));
+            Assert::AreEqual(static_cast<size_t>(MessageCount), CountMessages(ReadLines(L"async")));
+        }
+    };
+}
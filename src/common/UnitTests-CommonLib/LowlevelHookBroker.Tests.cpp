@@ -0,0 +1,184 @@
+#include "pch.h"
+#include <common/hooks/LowlevelHookBroker.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LowlevelHookBroker;
+
+namespace UnitTestsCommonLib
+{
+    // The subscribers are added to a hook that is never installed, the events are dispatched
+    // the way the hook procedures do it.
+    TEST_CLASS (LowlevelHookBrokerTests)
+    {
+        details::Hook<KeyboardCallback> m_keyboard;
+        details::Hook<MouseCallback> m_mouse;
+        std::vector<std::wstring> m_calls;
+
+        SubscriptionId AddKeyboard(const std::wstring& name, const Priority priority, const bool swallow)
+        {
+            std::lock_guard lock{ details::mutex };
+            return details::Add(m_keyboard, std::wstring{ name }, priority, KeyboardCallback{ [this, name, swallow](LowlevelKeyboardEvent&) {
+                                    m_calls.push_back(name);
+                                    return swallow;
+                                } },
+                                DefaultBudget);
+        }
+
+        bool Remove(const SubscriptionId id)
+        {
+            std::lock_guard lock{ details::mutex };
+            return details::Unsubscribe(m_keyboard, id);
+        }
+
+        bool DispatchKeyDown(const DWORD vkCode)
+        {
+            KBDLLHOOKSTRUCT info{ .vkCode = vkCode };
+            LowlevelKeyboardEvent event{ &info, WM_KEYDOWN };
+            const auto subscribers = m_keyboard.published.load();
+            return details::Dispatch(*subscribers, event);
+        }
+
+        const details::Subscriber<KeyboardCallback>& Find(const SubscriptionId id) const
+        {
+            return *std::find_if(m_keyboard.subscribers.begin(), m_keyboard.subscribers.end(), [id](const auto& subscriber) {
+                return subscriber.id == id;
+            });
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(Init)
+        {
+            // Subscribers over budget are reported in the log
+            ::Logger::init(std::vector<spdlog::sink_ptr>{});
+        }
+
+        TEST_METHOD (ObserversRunFirst)
+        {
+            AddKeyboard(L"normal 1", Priority::Normal, false);
+            AddKeyboard(L"observer 1", Priority::Observer, false);
+            AddKeyboard(L"normal 2", Priority::Normal, false);
+            AddKeyboard(L"observer 2", Priority::Observer, false);
+
+            Assert::IsFalse(DispatchKeyDown('A'));
+
+            // Subscribers with the same priority keep their subscription order
+            const std::vector<std::wstring> expected = { L"observer 1", L"observer 2", L"normal 1", L"normal 2" };
+            Assert::IsTrue(expected == m_calls);
+        }
+
+        TEST_METHOD (SwallowedEventStopsDispatch)
+        {
+            AddKeyboard(L"normal 1", Priority::Normal, true);
+            AddKeyboard(L"normal 2", Priority::Normal, false);
+            AddKeyboard(L"observer", Priority::Observer, false);
+
+            Assert::IsTrue(DispatchKeyDown('A'));
+
+            // The observer subscribed last and still sees the event the first subscriber swallows
+            const std::vector<std::wstring> expected = { L"observer", L"normal 1" };
+            Assert::IsTrue(expected == m_calls);
+        }
+
+        TEST_METHOD (UnsubscribeDuringDispatch)
+        {
+            const auto last = AddKeyboard(L"last", Priority::Normal, false);
+            {
+                std::lock_guard lock{ details::mutex };
+                details::Add(m_keyboard, L"unsubscriber", Priority::Observer, KeyboardCallback{ [this, last](LowlevelKeyboardEvent&) {
+                                 m_calls.push_back(L"unsubscriber");
+                                 Remove(last);
+                                 return false;
+                             } },
+                             DefaultBudget);
+            }
+
+            // The running dispatch keeps its snapshot, the next one doesn't call the removed subscriber
+            DispatchKeyDown('A');
+            DispatchKeyDown('B');
+
+            const std::vector<std::wstring> expected = { L"unsubscriber", L"last", L"unsubscriber" };
+            Assert::IsTrue(expected == m_calls);
+            Assert::AreEqual(size_t{ 1 }, m_keyboard.published.load()->size());
+        }
+
+        TEST_METHOD (UnsubscribeUnknownId)
+        {
+            const auto id = AddKeyboard(L"subscriber", Priority::Normal, false);
+            Assert::IsFalse(Remove(id + 1));
+            Assert::IsTrue(Remove(id));
+            Assert::IsFalse(Remove(id));
+            Assert::IsTrue(m_keyboard.published.load()->empty());
+
+            Assert::IsFalse(DispatchKeyDown('A'));
+            Assert::IsTrue(m_calls.empty());
+        }
+
+        TEST_METHOD (SubscriberSeesTheEvent)
+        {
+            DWORD keyboardKey = 0;
+            WPARAM mouseMessage = 0;
+            POINT mousePoint{};
+            {
+                std::lock_guard lock{ details::mutex };
+                details::Add(m_keyboard, L"keyboard", Priority::Normal, KeyboardCallback{ [&](LowlevelKeyboardEvent& event) {
+                                 keyboardKey = event.lParam->vkCode;
+                                 return false;
+                             } },
+                             DefaultBudget);
+                details::Add(m_mouse, L"mouse", Priority::Normal, MouseCallback{ [&](WPARAM wParam, const MSLLHOOKSTRUCT& info) {
+                                 mouseMessage = wParam;
+                                 mousePoint = info.pt;
+                                 return wParam == WM_RBUTTONDOWN;
+                             } },
+                             DefaultBudget);
+            }
+
+            DispatchKeyDown(VK_ESCAPE);
+            Assert::AreEqual(static_cast<DWORD>(VK_ESCAPE), keyboardKey);
+
+            const MSLLHOOKSTRUCT info{ .pt = { 12, 34 } };
+            WPARAM wParam = WM_RBUTTONDOWN;
+            Assert::IsTrue(details::Dispatch(*m_mouse.published.load(), wParam, info));
+            Assert::AreEqual(static_cast<WPARAM>(WM_RBUTTONDOWN), mouseMessage);
+            Assert::AreEqual(34L, mousePoint.y);
+
+            wParam = WM_MOUSEMOVE;
+            Assert::IsFalse(details::Dispatch(*m_mouse.published.load(), wParam, info));
+        }
+
+        TEST_METHOD (SlowSubscriberIsCounted)
+        {
+            const auto fast = AddKeyboard(L"fast", Priority::Normal, false);
+            SubscriptionId slow;
+            {
+                std::lock_guard lock{ details::mutex };
+                slow = details::Add(m_keyboard, L"slow", Priority::Normal, KeyboardCallback{ [](LowlevelKeyboardEvent&) {
+                                        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                                        return false;
+                                    } },
+                                    std::chrono::microseconds{ 1000 });
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                DispatchKeyDown('A');
+            }
+
+            const auto fastStats = details::GetStats(Find(fast).name, *Find(fast).timing);
+            Assert::AreEqual(uint64_t{ 3 }, fastStats.events);
+            Assert::AreEqual(uint64_t{ 0 }, fastStats.overBudget);
+
+            const auto slowStats = details::GetStats(Find(slow).name, *Find(slow).timing);
+            Assert::AreEqual(uint64_t{ 3 }, slowStats.events);
+            Assert::AreEqual(uint64_t{ 3 }, slowStats.overBudget);
+            Assert::IsTrue(slowStats.maxTime >= std::chrono::milliseconds(5));
+            Assert::IsTrue(slowStats.totalTime >= std::chrono::milliseconds(15));
+        }
+    };
+}
@@ -0,0 +1,192 @@
+#include "pch.h"
+#include <common/interop/two_way_pipe_message_ipc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <wil/resource.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsCommonLib
+{
+    constexpr std::chrono::milliseconds MessageTimeout{ 5000 };
+
+    std::wstring TestPipeName(const std::wstring& name)
+    {
+        return L"\\\\.\\pipe\\powertoys_ipc_tests_" + std::to_wstring(GetCurrentProcessId()) + L"_" + name;
+    }
+
+    // Signals once the expected number of messages arrived
+    struct MessageCounter
+    {
+        std::atomic<int> received = 0;
+        int expected = 1;
+        wil::unique_handle done{ CreateEventW(nullptr, false, false, nullptr) };
+
+        void Receive()
+        {
+            if (++received == expected)
+            {
+                SetEvent(done.get());
+            }
+        }
+
+        bool Wait() const
+        {
+            return WaitForSingleObject(done.get(), static_cast<DWORD>(MessageTimeout.count())) == WAIT_OBJECT_0;
+        }
+    };
+
+    // A message sent before the other side created its pipe is dropped
+    void WaitForPipe(const std::wstring& name)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + MessageTimeout;
+        while (!WaitNamedPipeW(name.c_str(), NMPWAIT_USE_DEFAULT_WAIT) && GetLastError() == ERROR_FILE_NOT_FOUND && std::chrono::steady_clock::now() < deadline)
+        {
+            Sleep(1);
+        }
+    }
+
+    // Two endpoints connected to each other, like the runner and the settings process
+    struct Loopback
+    {
+        TwoWayPipeMessageIPC server;
+        TwoWayPipeMessageIPC client;
+
+        Loopback(const std::wstring& name, TwoWayPipeMessageIPC::callback_function serverCallback, TwoWayPipeMessageIPC::callback_function clientCallback) :
+            server(TestPipeName(name + L"_server"), TestPipeName(name + L"_client"), std::move(serverCallback)),
+            client(TestPipeName(name + L"_client"), TestPipeName(name + L"_server"), std::move(clientCallback))
+        {
+            server.start(nullptr);
+            client.start(nullptr);
+            WaitForPipe(TestPipeName(name + L"_server"));
+            WaitForPipe(TestPipeName(name + L"_client"));
+        }
+
+        void End()
+        {
+            client.end();
+            server.end();
+        }
+    };
+
+    TEST_CLASS (TwoWayPipeMessageIPCTests)
+    {
+    public:
+        TEST_METHOD (EndWhilePeerKeepsConnectionOpen)
+        {
+            MessageCounter counter;
+            Loopback loopback{ L"end", [&](const std::wstring&) { counter.Receive(); }, nullptr };
+
+            // After the first message the client keeps its connection to the server open
+            loopback.client.send(L"hello");
+            Assert::IsTrue(counter.Wait());
+
+            auto ending = std::async(std::launch::async, [&] { loopback.server.end(); });
+            const bool ended = ending.wait_for(MessageTimeout) == std::future_status::ready;
+
+            // Closing the client's connection releases a server that hangs in end()
+            loopback.client.end();
+            ending.wait();
+            Assert::IsTrue(ended);
+        }
+
+        TEST_METHOD (MessagesArriveInOrder)
+        {
+            constexpr int MessageCount = 100;
+            MessageCounter counter;
+            counter.expected = MessageCount;
+            std::vector<std::wstring> messages;
+            Loopback loopback{ L"order", [&](const std::wstring& message) {
+                                  messages.push_back(message);
+                                  counter.Receive();
+                              },
+                               nullptr };
+
+            for (int i = 0; i < MessageCount; i++)
+            {
+                loopback.client.send(std::to_wstring(i));
+            }
+            Assert::IsTrue(counter.Wait());
+            loopback.End();
+
+            for (int i = 0; i < MessageCount; i++)
+            {
+                Assert::AreEqual(std::to_wstring(i), messages[i]);
+            }
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(LoopbackThroughputAndLatency)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (LoopbackThroughputAndLatency)
+        {
+            constexpr int MessageCount = 5000;
+            constexpr size_t MessageLength = 2048;
+            constexpr int RoundTrips = 500;
+
+            // Throughput: the client sends a burst of settings-sized messages
+            {
+                MessageCounter counter;
+                counter.expected = MessageCount;
+                Loopback loopback{ L"throughput", [&](const std::wstring&) { counter.Receive(); }, nullptr };
+                const std::wstring message(MessageLength, L'x');
+
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < MessageCount; i++)
+                {
+                    loopback.client.send(message);
+                }
+                Assert::IsTrue(counter.Wait());
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                loopback.End();
+
+                const double mebibytes = static_cast<double>(MessageCount) * MessageLength * sizeof(wchar_t) / (1024 * 1024);
+                Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(
+                    std::format(L"Throughput: {} messages of {} bytes in {:.1f} ms, {:.0f} messages/s, {:.1f} MiB/s\n",
+                                MessageCount,
+                                MessageLength * sizeof(wchar_t),
+                                elapsed.count() * 1000,
+                                MessageCount / elapsed.count(),
+                                mebibytes / elapsed.count())
+                        .c_str());
+            }
+
+            // Latency: the server echoes every message back to the client
+            {
+                MessageCounter counter;
+                TwoWayPipeMessageIPC* server = nullptr;
+                Loopback loopback{ L"latency", [&](const std::wstring& message) { server->send(message); }, [&](const std::wstring&) { counter.Receive(); } };
+                server = &loopback.server;
+
+                std::vector<std::chrono::microseconds> roundTrips;
+                roundTrips.reserve(RoundTrips);
+                for (int i = 0; i < RoundTrips; i++)
+                {
+                    counter.received = 0;
+                    const auto start = std::chrono::steady_clock::now();
+                    loopback.client.send(L"{\"ping\":" + std::to_wstring(i) + L"}");
+                    Assert::IsTrue(counter.Wait());
+                    roundTrips.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+                }
+                loopback.End();
+
+                std::sort(roundTrips.begin(), roundTrips.end());
+                Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(
+                    std::format(L"Latency over {} round trips: median {} us, 99th percentile {} us, max {} us\n",
+                                RoundTrips,
+                                roundTrips[RoundTrips / 2].count(),
+                                roundTrips[RoundTrips * 99 / 100].count(),
+                                roundTrips.back().count())
+                        .c_str());
+            }
+        }
+    };
+}
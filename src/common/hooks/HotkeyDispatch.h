@@ -0,0 +1,143 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <functional>
+#include <vector>
+
+// Matching of key presses against a set of hotkeys from a low level keyboard hook, without
+// querying the keyboard state on every event.
+namespace HotkeyDispatch
+{
+    // Returns whether the key is currently held down.
+    using KeyStateReader = std::function<bool(DWORD vkCode)>;
+
+    inline bool IsKeyDown(DWORD vkCode)
+    {
+        return GetAsyncKeyState(vkCode) & 0x8000;
+    }
+
+    // Modifier keys state, tracked from the events the hook receives.
+    class ModifierState
+    {
+    public:
+        static constexpr std::array<DWORD, 8> ModifierKeys = { VK_LWIN, VK_RWIN, VK_LCONTROL, VK_RCONTROL, VK_LSHIFT, VK_RSHIFT, VK_LMENU, VK_RMENU };
+
+        void Update(DWORD vkCode, WPARAM wParam)
+        {
+            // Injected input may use the side-agnostic codes
+            switch (vkCode)
+            {
+            case VK_CONTROL:
+                vkCode = VK_LCONTROL;
+                break;
+            case VK_SHIFT:
+                vkCode = VK_LSHIFT;
+                break;
+            case VK_MENU:
+                vkCode = VK_LMENU;
+                break;
+            }
+
+            if (std::find(ModifierKeys.begin(), ModifierKeys.end(), vkCode) == ModifierKeys.end())
+            {
+                return;
+            }
+
+            if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN)
+            {
+                down.set(vkCode);
+            }
+            else if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP)
+            {
+                down.reset(vkCode);
+            }
+        }
+
+        void Sync(const KeyStateReader& isKeyDown)
+        {
+            for (const auto vkCode : ModifierKeys)
+            {
+                down.set(vkCode, isKeyDown(vkCode));
+            }
+        }
+
+        bool Win() const { return down.test(VK_LWIN) || down.test(VK_RWIN); }
+        bool Ctrl() const { return down.test(VK_LCONTROL) || down.test(VK_RCONTROL); }
+        bool Shift() const { return down.test(VK_LSHIFT) || down.test(VK_RSHIFT); }
+        bool Alt() const { return down.test(VK_LMENU) || down.test(VK_RMENU); }
+
+    private:
+        std::bitset<256> down;
+    };
+
+    // Hotkey descriptors sorted by hotkey, built once and then only read. THotkeyDescriptor has a
+    // 'hotkey' member with the win, ctrl, shift, alt and key fields, ordered by operator<.
+    template<typename THotkeyDescriptor>
+    class Table
+    {
+    public:
+        Table() = default;
+
+        explicit Table(std::vector<THotkeyDescriptor> descriptors) :
+            hotkeys(std::move(descriptors))
+        {
+            // Hotkeys registered twice keep their registration order, the first one is matched
+            std::stable_sort(hotkeys.begin(), hotkeys.end(), [](const THotkeyDescriptor& lhs, const THotkeyDescriptor& rhs) {
+                return lhs.hotkey < rhs.hotkey;
+            });
+            for (const auto& descriptor : hotkeys)
+            {
+                hotkeyKeys.set(descriptor.hotkey.key);
+            }
+        }
+
+        // Most key presses are for keys no hotkey uses.
+        bool UsesKey(DWORD vkCode) const
+        {
+            return vkCode < hotkeyKeys.size() && hotkeyKeys.test(vkCode);
+        }
+
+        const THotkeyDescriptor* Find(const ModifierState& modifiers, DWORD vkCode) const
+        {
+            const decltype(THotkeyDescriptor::hotkey) hotkey{ .win = modifiers.Win(),
+                                                              .ctrl = modifiers.Ctrl(),
+                                                              .shift = modifiers.Shift(),
+                                                              .alt = modifiers.Alt(),
+                                                              .key = static_cast<unsigned char>(vkCode) };
+
+            auto it = std::lower_bound(hotkeys.begin(), hotkeys.end(), hotkey, [](const THotkeyDescriptor& descriptor, const auto& hotkey) {
+                return descriptor.hotkey < hotkey;
+            });
+            return it != hotkeys.end() && it->hotkey == hotkey ? &*it : nullptr;
+        }
+
+        // Returns the descriptor of the hotkey a key down completes, if any.
+        // The hook misses key releases and presses that happen on another desktop, e.g. while the
+        // lock screen is shown, so the tracked modifiers are confirmed against the keyboard state
+        // for the keys a hotkey uses, whether they match with the tracked state or not.
+        const THotkeyDescriptor* Match(ModifierState& modifiers, DWORD vkCode, const KeyStateReader& isKeyDown = IsKeyDown) const
+        {
+            if (!UsesKey(vkCode))
+            {
+                return nullptr;
+            }
+
+            modifiers.Sync(isKeyDown);
+            return Find(modifiers, vkCode);
+        }
+
+        const std::vector<THotkeyDescriptor>& Hotkeys() const
+        {
+            return hotkeys;
+        }
+
+    private:
+        std::vector<THotkeyDescriptor> hotkeys;
+        std::bitset<256> hotkeyKeys; // keys used by at least one hotkey
+    };
+}
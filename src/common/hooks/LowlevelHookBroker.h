@@ -0,0 +1,292 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <common/debug_control.h>
+#include <common/hooks/LowlevelKeyboardEvent.h>
+#include <common/logger/logger.h>
+
+// Owns a single WH_KEYBOARD_LL and a single WH_MOUSE_LL hook for the process and dispatches
+// their events to the subscribers by priority, so every input event crosses one hook per
+// process instead of one per component.
+// A hook is installed by the first subscription and runs on that thread, which must pump
+// messages. It's removed with the last subscription.
+// The broker state is defined in this header, so every executable or DLL that includes it has
+// its own broker and its own hooks.
+namespace LowlevelHookBroker
+{
+    enum class Priority
+    {
+        // Subscribers that only watch the input, they see the events other subscribers swallow.
+        Observer,
+        Normal,
+    };
+
+    // Return true to swallow the event, the next subscribers and hooks don't receive it.
+    using KeyboardCallback = std::function<bool(LowlevelKeyboardEvent&)>;
+    using MouseCallback = std::function<bool(WPARAM, const MSLLHOOKSTRUCT&)>;
+
+    using SubscriptionId = size_t;
+
+    // Time a subscriber can spend on an event before it is reported as slowing input down.
+    constexpr std::chrono::microseconds DefaultBudget{ 1000 };
+
+    struct SubscriberStats
+    {
+        std::wstring name;
+        uint64_t events;
+        uint64_t overBudget;
+        std::chrono::microseconds totalTime;
+        std::chrono::microseconds maxTime;
+    };
+
+    namespace details
+    {
+        struct Timing
+        {
+            std::atomic_uint64_t events = 0;
+            std::atomic_uint64_t overBudget = 0;
+            std::atomic_int64_t totalMicroseconds = 0;
+            std::atomic_int64_t maxMicroseconds = 0;
+        };
+
+        template<typename Callback>
+        struct Subscriber
+        {
+            SubscriptionId id;
+            std::wstring name;
+            Priority priority;
+            std::chrono::microseconds budget;
+            Callback callback;
+            std::shared_ptr<Timing> timing;
+        };
+
+        template<typename Callback>
+        using Subscribers = std::vector<Subscriber<Callback>>;
+
+        template<typename Callback>
+        struct Hook
+        {
+            HHOOK handle = nullptr;
+
+            // Changed under the mutex, the hook procedure reads the published copy without locking.
+            Subscribers<Callback> subscribers;
+            std::atomic<std::shared_ptr<const Subscribers<Callback>>> published{ std::make_shared<const Subscribers<Callback>>() };
+        };
+
+        inline std::mutex mutex;
+        inline SubscriptionId nextId = 1;
+        inline Hook<KeyboardCallback> keyboard;
+        inline Hook<MouseCallback> mouse;
+
+        template<typename Callback>
+        void RecordTiming(const Subscriber<Callback>& subscriber, const std::chrono::microseconds elapsed)
+        {
+            // Only the hook thread writes the timings
+            auto& timing = *subscriber.timing;
+            timing.events.fetch_add(1, std::memory_order_relaxed);
+            timing.totalMicroseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+            if (elapsed.count() > timing.maxMicroseconds.load(std::memory_order_relaxed))
+            {
+                timing.maxMicroseconds.store(elapsed.count(), std::memory_order_relaxed);
+            }
+
+            if (elapsed > subscriber.budget)
+            {
+                // Don't flood the log if a subscriber is always slow
+                if (timing.overBudget.fetch_add(1, std::memory_order_relaxed) % 100 == 0)
+                {
+                    Logger::warn(L"{} took {} us to handle a low level input event, budget is {} us", subscriber.name, elapsed.count(), subscriber.budget.count());
+                }
+            }
+        }
+
+        template<typename Callback, typename... Args>
+        bool Dispatch(const Subscribers<Callback>& subscribers, Args&... args)
+        {
+            for (const auto& subscriber : subscribers)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                const bool swallow = subscriber.callback(args...);
+                RecordTiming(subscriber, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+
+                if (swallow)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        inline LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+        {
+            if (nCode == HC_ACTION)
+            {
+                // Holding the snapshot keeps the callbacks alive if one of them unsubscribes
+                const auto subscribers = keyboard.published.load();
+                LowlevelKeyboardEvent event{ reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam), wParam };
+                if (Dispatch(*subscribers, event))
+                {
+                    return 1;
+                }
+            }
+
+            return CallNextHookEx(nullptr, nCode, wParam, lParam);
+        }
+
+        inline LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam)
+        {
+            if (nCode == HC_ACTION)
+            {
+                const auto subscribers = mouse.published.load();
+                const auto& info = *reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
+                if (Dispatch(*subscribers, wParam, info))
+                {
+                    return 1;
+                }
+            }
+
+            return CallNextHookEx(nullptr, nCode, wParam, lParam);
+        }
+
+        // Must be called with the mutex held.
+        template<typename Callback>
+        void Publish(Hook<Callback>& hook)
+        {
+            auto subscribers = std::make_shared<Subscribers<Callback>>(hook.subscribers);
+            std::stable_sort(subscribers->begin(), subscribers->end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.priority < rhs.priority;
+            });
+            hook.published.store(std::move(subscribers));
+        }
+
+        inline SubscriberStats GetStats(const std::wstring& name, const Timing& timing)
+        {
+            return SubscriberStats{ .name = name,
+                                    .events = timing.events.load(),
+                                    .overBudget = timing.overBudget.load(),
+                                    .totalTime = std::chrono::microseconds{ timing.totalMicroseconds.load() },
+                                    .maxTime = std::chrono::microseconds{ timing.maxMicroseconds.load() } };
+        }
+
+        // Must be called with the mutex held. Doesn't install the hook.
+        template<typename Callback>
+        SubscriptionId Add(Hook<Callback>& hook, std::wstring&& name, const Priority priority, Callback&& callback, const std::chrono::microseconds budget)
+        {
+            const SubscriptionId id = nextId++;
+            hook.subscribers.push_back({ .id = id,
+                                         .name = std::move(name),
+                                         .priority = priority,
+                                         .budget = budget,
+                                         .callback = std::move(callback),
+                                         .timing = std::make_shared<Timing>() });
+            Publish(hook);
+            return id;
+        }
+
+        template<typename Callback>
+        std::optional<SubscriptionId> Subscribe(Hook<Callback>& hook, const int idHook, HOOKPROC proc, std::wstring&& name, const Priority priority, Callback&& callback, const std::chrono::microseconds budget)
+        {
+#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
+            if (IsDebuggerPresent())
+            {
+                return std::nullopt;
+            }
+#endif
+            std::lock_guard lock{ mutex };
+            if (!hook.handle)
+            {
+                hook.handle = SetWindowsHookExW(idHook, proc, GetModuleHandleW(nullptr), 0);
+                if (!hook.handle)
+                {
+                    return std::nullopt;
+                }
+            }
+
+            return Add(hook, std::move(name), priority, std::move(callback), budget);
+        }
+
+        // Must be called with the mutex held.
+        template<typename Callback>
+        bool Unsubscribe(Hook<Callback>& hook, const SubscriptionId id)
+        {
+            auto it = std::find_if(hook.subscribers.begin(), hook.subscribers.end(), [id](const auto& subscriber) {
+                return subscriber.id == id;
+            });
+            if (it == hook.subscribers.end())
+            {
+                return false;
+            }
+
+            const auto stats = GetStats(it->name, *it->timing);
+            if (stats.events > 0)
+            {
+                Logger::trace(L"{} handled {} low level input events, average {} us, max {} us, {} over budget",
+                              stats.name,
+                              stats.events,
+                              stats.totalTime.count() / stats.events,
+                              stats.maxTime.count(),
+                              stats.overBudget);
+            }
+
+            hook.subscribers.erase(it);
+            Publish(hook);
+
+            if (hook.subscribers.empty() && hook.handle)
+            {
+                UnhookWindowsHookEx(hook.handle);
+                hook.handle = nullptr;
+            }
+
+            return true;
+        }
+    }
+
+    // Returns nothing if the hook couldn't be installed, GetLastError has the reason.
+    inline std::optional<SubscriptionId> SubscribeKeyboard(std::wstring name, const Priority priority, KeyboardCallback callback, const std::chrono::microseconds budget = DefaultBudget)
+    {
+        return details::Subscribe(details::keyboard, WH_KEYBOARD_LL, details::KeyboardProc, std::move(name), priority, std::move(callback), budget);
+    }
+
+    inline std::optional<SubscriptionId> SubscribeMouse(std::wstring name, const Priority priority, MouseCallback callback, const std::chrono::microseconds budget = DefaultBudget)
+    {
+        return details::Subscribe(details::mouse, WH_MOUSE_LL, details::MouseProc, std::move(name), priority, std::move(callback), budget);
+    }
+
+    inline void Unsubscribe(const SubscriptionId id)
+    {
+        std::lock_guard lock{ details::mutex };
+        if (!details::Unsubscribe(details::keyboard, id))
+        {
+            details::Unsubscribe(details::mouse, id);
+        }
+    }
+
+    // Latency accounting of the current subscribers, to find which one slows input down.
+    inline std::vector<SubscriberStats> GetStats()
+    {
+        std::lock_guard lock{ details::mutex };
+        std::vector<SubscriberStats> result;
+        for (const auto& subscriber : details::keyboard.subscribers)
+        {
+            result.push_back(details::GetStats(subscriber.name, *subscriber.timing));
+        }
+        for (const auto& subscriber : details::mouse.subscribers)
+        {
+            result.push_back(details::GetStats(subscriber.name, *subscriber.timing));
+        }
+        return result;
+    }
+}
@@ -1,54 +1,122 @@
 #pragma once
-#include <queue>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <optional>
 #include <string>
+#include <vector>
 
+// Multi-producer, single-consumer queue of messages. Producers don't take locks: a message is
+// linked in with an atomic exchange and the consumer is woken through an atomic wait.
+// pop_message and pop_batch must always be called from the same thread.
 class AsyncMessageQueue
 {
 private:
-    std::mutex queue_mutex;
-    std::queue<std::wstring> message_queue;
-    std::condition_variable message_ready;
-    bool interrupted = false;
+    struct Node
+    {
+        std::atomic<Node*> next = nullptr;
+        std::wstring message;
+    };
+
+    // Producers append at the head, the consumer removes at the tail. The tail is always a
+    // node whose message was already consumed.
+    std::atomic<Node*> head;
+    Node* tail;
+
+    // Changed after every push and on interrupt, the consumer waits on it when the queue is empty.
+    std::atomic<uint32_t> signal = 0;
+    std::atomic<bool> interrupted = false;
 
     //Disable copy
     AsyncMessageQueue(const AsyncMessageQueue&);
     AsyncMessageQueue& operator=(const AsyncMessageQueue&);
 
+    std::optional<std::wstring> try_pop()
+    {
+        Node* next = this->tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        std::wstring message = std::move(next->message);
+        delete this->tail;
+        this->tail = next;
+        return message;
+    }
+
+    // Blocks until there is a message or the queue is interrupted. Returns false if interrupted.
+    bool wait_for_message()
+    {
+        while (!this->interrupted.load(std::memory_order_acquire))
+        {
+            const uint32_t seen = this->signal.load(std::memory_order_acquire);
+
+            // A message pushed after reading the signal changes it, so the wait can't miss it
+            if (this->tail->next.load(std::memory_order_acquire) != nullptr)
+            {
+                return true;
+            }
+            if (this->interrupted.load(std::memory_order_acquire))
+            {
+                break;
+            }
+            this->signal.wait(seen, std::memory_order_acquire);
+        }
+        return false;
+    }
+
 public:
     AsyncMessageQueue()
     {
+        this->tail = new Node;
+        this->head.store(this->tail, std::memory_order_relaxed);
+    }
+    ~AsyncMessageQueue()
+    {
+        while (this->tail != nullptr)
+        {
+            Node* next = this->tail->next.load(std::memory_order_relaxed);
+            delete this->tail;
+            this->tail = next;
+        }
     }
     void queue_message(std::wstring message)
     {
-        this->queue_mutex.lock();
-        this->message_queue.push(message);
-        this->queue_mutex.unlock();
-        this->message_ready.notify_one();
+        Node* node = new Node;
+        node->message = std::move(message);
+        Node* previous = this->head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+
+        this->signal.fetch_add(1, std::memory_order_release);
+        this->signal.notify_one();
     }
     std::wstring pop_message()
     {
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-        while (message_queue.empty() && !this->interrupted)
-        {
-            this->message_ready.wait(lock);
-        }
-        if (this->interrupted)
+        if (!wait_for_message())
         {
             //Just returns a empty string if the queue was interrupted.
             return std::wstring(L"");
         }
-        std::wstring message = this->message_queue.front();
-        this->message_queue.pop();
-        return message;
+        return std::move(*try_pop());
+    }
+    // Waits for at least one message and returns all the messages available, so a burst is
+    // handled in one wake-up. Returns no messages if the queue was interrupted.
+    std::vector<std::wstring> pop_batch()
+    {
+        std::vector<std::wstring> messages;
+        if (!wait_for_message())
+        {
+            return messages;
+        }
+        while (auto message = try_pop())
+        {
+            messages.push_back(std::move(*message));
+        }
+        return messages;
     }
     void interrupt()
     {
-        this->queue_mutex.lock();
-        this->interrupted = true;
-        this->queue_mutex.unlock();
-        this->message_ready.notify_all();
+        this->interrupted.store(true, std::memory_order_release);
+        this->signal.fetch_add(1, std::memory_order_release);
+        this->signal.notify_all();
     }
 };
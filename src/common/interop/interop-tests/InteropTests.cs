@@ -3,6 +3,7 @@
 // See the LICENSE file in the project root for more information.
 
 using System;
+using System.Collections.Generic;
 using System.Threading;
 
 using Microsoft.VisualStudio.TestTools.UnitTesting;
@@ -61,6 +62,76 @@ namespace Microsoft.Interop.Tests
             }
         }
 
+        [TestMethod]
+        public void TestSendLargeMessage()
+        {
+            // Larger than the pipe buffers, so it's read in more than one step
+            var testString = new string('x', 1024 * 1024) + "\n";
+            using (var reset = new AutoResetEvent(false))
+            {
+                using (var serverPipe = new TwoWayPipeMessageIPCManaged(
+                    ServerSidePipe,
+                    ClientSidePipe,
+                    (string msg) =>
+                    {
+                        Assert.AreEqual(testString, msg);
+                        reset.Set();
+                    }))
+                {
+                    serverPipe.Start();
+                    ClientPipe.Start();
+
+                    Thread.Sleep(100);
+
+                    ClientPipe.Send(testString);
+                    reset.WaitOne();
+
+                    serverPipe.End();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void TestSendKeepsMessageOrder()
+        {
+            const int messageCount = 1000;
+            var received = new List<string>();
+            using (var reset = new AutoResetEvent(false))
+            {
+                using (var serverPipe = new TwoWayPipeMessageIPCManaged(
+                    ServerSidePipe,
+                    ClientSidePipe,
+                    (string msg) =>
+                    {
+                        received.Add(msg);
+                        if (received.Count == messageCount)
+                        {
+                            reset.Set();
+                        }
+                    }))
+                {
+                    serverPipe.Start();
+                    ClientPipe.Start();
+
+                    Thread.Sleep(100);
+
+                    for (int i = 0; i < messageCount; i++)
+                    {
+                        ClientPipe.Send($"message {i}");
+                    }
+
+                    reset.WaitOne();
+
+                    serverPipe.End();
+                }
+            }
+
+            for (int i = 0; i < messageCount; i++)
+            {
+                Assert.AreEqual($"message {i}", received[i]);
+            }
+        }
+
         protected virtual void Dispose(bool disposing)
         {
             if (!disposedValue)
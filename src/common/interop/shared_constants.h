@@ -50,6 +50,12 @@ namespace CommonSharedConstants
 
     const wchar_t SHORTCUT_GUIDE_EXIT_EVENT[] = L"Local\\ShortcutGuide-ExitEvent-35697cdd-a3d2-47d6-a246-34efcc73eac0";
 
+    // Window class of the message-only window of a resident Shortcut Guide, posting it the registered
+    // SHORTCUT_GUIDE_TOGGLE_MESSAGE shows or hides the overlay. lParam holds the steady_clock ticks of the key press.
+    const wchar_t SHORTCUT_GUIDE_RESIDENT_WINDOW_CLASS[] = L"PToyShortcutGuideResident";
+
+    const wchar_t SHORTCUT_GUIDE_TOGGLE_MESSAGE[] = L"ShortcutGuide-ToggleMessage-0f7c5d8e-4b8a-4e51-9a39-6f3c2b1d7e24";
+
     const wchar_t FANCY_ZONES_EDITOR_TOGGLE_EVENT[] = L"Local\\FancyZones-ToggleEditorEvent-1e174338-06a3-472b-874d-073b21c62f14";
 
     // Path to the event used by Workspaces
@@ -1,9 +1,16 @@
 #include "pch.h"
 #include "two_way_pipe_message_ipc_impl.h"
 
+#include <algorithm>
 #include <iterator>
 
-constexpr DWORD BUFSIZE = 1024;
+// Size of the pipe buffers and of the initial read buffer. Larger messages are read in one
+// more step, the frame header tells how much memory they need.
+constexpr DWORD BUFSIZE = 64 * 1024;
+
+// Every message is sent as a frame: the payload size in bytes followed by the UTF-16 payload.
+using frame_header_t = uint32_t;
+constexpr size_t MAX_FRAME_BYTES = 256 * 1024 * 1024;
 
 TwoWayPipeMessageIPC::TwoWayPipeMessageIPC(
     std::wstring _input_pipe_name,
@@ -23,7 +30,7 @@ TwoWayPipeMessageIPC::~TwoWayPipeMessageIPC()
 
 void TwoWayPipeMessageIPC::send(std::wstring msg)
 {
-    impl->send(msg);
+    impl->send(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::start(HANDLE _restricted_pipe_token)
@@ -48,7 +55,7 @@ TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::TwoWayPipeMessageIPCImpl(
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send(std::wstring msg)
 {
-    output_queue.queue_message(msg);
+    output_queue.queue_message(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start(HANDLE _restricted_pipe_token)
@@ -65,30 +72,52 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
     input_queue_thread.join();
     output_queue.interrupt();
     output_queue_thread.join();
-    pipe_connect_handle_mutex.lock();
-    if (current_connect_pipe_handle != NULL)
+    close_output_pipe();
     {
-        //Cancels the Pipe currently waiting for a connection.
-        CancelIoEx(current_connect_pipe_handle, NULL);
+        std::unique_lock lock(pipe_connect_handle_mutex);
+        if (current_connect_pipe_handle != NULL)
+        {
+            //Cancels the Pipe currently waiting for a connection.
+            CancelIoEx(current_connect_pipe_handle, NULL);
+        }
+
+        // The connections read synchronously, DisconnectNamedPipe would wait behind a pending read
+        // until the client writes or closes. Cancelling fails the read, then the connection thread
+        // disconnects and closes the pipe. A read that starts after the cancellation isn't cancelled,
+        // so cancel again until every connection is done.
+        while (!connection_handles.empty())
+        {
+            for (const HANDLE connection_handle : connection_handles)
+            {
+                CancelIoEx(connection_handle, NULL);
+            }
+            for (auto& connection_thread : connection_threads)
+            {
+                CancelSynchronousIo(connection_thread.native_handle());
+            }
+            connections_changed.wait_for(lock, std::chrono::milliseconds(10));
+        }
     }
-    pipe_connect_handle_mutex.unlock();
     input_pipe_thread.join();
+    for (auto& connection_thread : connection_threads)
+    {
+        connection_thread.join();
+    }
+    connection_threads.clear();
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstring message)
+bool TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::connect_output_pipe()
 {
     // Adapted from https://learn.microsoft.com/windows/win32/ipc/named-pipe-client
-    HANDLE output_pipe_handle;
-    const wchar_t* message_send = message.c_str();
-    BOOL fSuccess = FALSE;
-    DWORD cbToWrite, cbWritten, dwMode;
+    HANDLE pipe_handle;
+    DWORD dwMode;
     const wchar_t* lpszPipename = output_pipe_name.c_str();
 
     // Try to open a named pipe; wait for it, if necessary.
 
     while (1)
     {
-        output_pipe_handle = CreateFile(
+        pipe_handle = CreateFile(
             lpszPipename, // pipe name
             GENERIC_READ | // read and write access
                 GENERIC_WRITE,
@@ -100,62 +129,103 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstr
 
         // Break if the pipe handle is valid.
 
-        if (output_pipe_handle != INVALID_HANDLE_VALUE)
+        if (pipe_handle != INVALID_HANDLE_VALUE)
             break;
 
         // Exit if an error other than ERROR_PIPE_BUSY occurs.
         DWORD curr_error = 0;
         if ((curr_error = GetLastError()) != ERROR_PIPE_BUSY)
         {
-            return;
+            return false;
         }
 
         // All pipe instances are busy, so wait for 20 seconds.
 
         if (!WaitNamedPipe(lpszPipename, 20000))
         {
-            return;
+            return false;
         }
     }
     dwMode = PIPE_READMODE_MESSAGE;
-    fSuccess = SetNamedPipeHandleState(
-        output_pipe_handle, // pipe handle
-        &dwMode, // new pipe mode
-        NULL, // don't set maximum bytes
-        NULL); // don't set maximum time
-    if (!fSuccess)
+    if (!SetNamedPipeHandleState(
+            pipe_handle, // pipe handle
+            &dwMode, // new pipe mode
+            NULL, // don't set maximum bytes
+            NULL)) // don't set maximum time
     {
-        return;
+        CloseHandle(pipe_handle);
+        return false;
     }
 
-    // Send a message to the pipe server.
+    output_pipe_handle = pipe_handle;
+    return true;
+}
 
-    cbToWrite = (lstrlen(message_send)) * sizeof(WCHAR); // no need to send final '\0'. Pipe is in message mode.
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::close_output_pipe()
+{
+    if (output_pipe_handle != NULL)
+    {
+        CloseHandle(output_pipe_handle);
+        output_pipe_handle = NULL;
+    }
+}
 
-    fSuccess = WriteFile(
-        output_pipe_handle, // pipe handle
-        message_send, // message
-        cbToWrite, // message length
-        &cbWritten, // bytes written
-        NULL); // not overlapped
-    if (!fSuccess)
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(const std::wstring& message)
+{
+    const size_t payload_bytes = message.size() * sizeof(wchar_t);
+    if (payload_bytes > MAX_FRAME_BYTES)
     {
         return;
     }
-    CloseHandle(output_pipe_handle);
-    return;
+
+    // The frame is written at once, so it stays a single pipe message. The buffer is reused.
+    const frame_header_t header = static_cast<frame_header_t>(payload_bytes);
+    output_frame.resize(sizeof(header) + payload_bytes);
+    memcpy(output_frame.data(), &header, sizeof(header));
+    memcpy(output_frame.data() + sizeof(header), message.data(), payload_bytes);
+
+    // The connection is kept open between messages. If the other side went away, connect again
+    // once, it may have restarted.
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        if (output_pipe_handle == NULL && !connect_output_pipe())
+        {
+            return;
+        }
+
+        DWORD cbWritten = 0;
+        if (WriteFile(output_pipe_handle, output_frame.data(), static_cast<DWORD>(output_frame.size()), &cbWritten, NULL) && cbWritten == output_frame.size())
+        {
+            break;
+        }
+        close_output_pipe();
+    }
+
+    // Don't keep the memory of a large message around
+    if (output_frame.size() > BUFSIZE)
+    {
+        output_frame.resize(BUFSIZE);
+        output_frame.shrink_to_fit();
+    }
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread()
 {
     while (!closed)
     {
-        std::wstring message = output_queue.pop_message();
-        if (message.length() == 0)
+        auto messages = output_queue.pop_batch();
+        if (messages.empty())
         {
             break;
         }
-        send_pipe_message(message);
+        for (const auto& message : messages)
+        {
+            if (message.length() == 0)
+            {
+                return;
+            }
+            send_pipe_message(message);
+        }
     }
 }
 
@@ -353,44 +423,65 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HAND
     {
         return;
     }
-    constexpr DWORD readBlockBytes = BUFSIZE;
-    std::wstring message;
-    size_t iBlock = 0;
-    message.reserve(BUFSIZE);
-    bool ok;
-    do
+
+    // The client keeps the connection open and sends one frame per pipe message.
+    std::vector<BYTE> buffer(BUFSIZE);
+    while (!closed)
     {
-        constexpr size_t charsPerBlock = readBlockBytes / sizeof(message[0]);
-        message.resize(message.size() + charsPerBlock);
         DWORD bytesRead = 0;
-        ok = ReadFile(
-            input_pipe_handle,
-            // read the message directly into the string block by block simultaneously resizing it
-            message.data() + iBlock * charsPerBlock,
-            readBlockBytes,
-            &bytesRead,
-            nullptr);
-
-        if (!ok && GetLastError() != ERROR_MORE_DATA)
+        BOOL ok = ReadFile(input_pipe_handle, buffer.data(), static_cast<DWORD>(buffer.size()), &bytesRead, nullptr);
+        if (!ok && GetLastError() == ERROR_MORE_DATA)
         {
+            // Grow the buffer to the size announced by the header and read the rest of the frame.
+            frame_header_t payload_bytes;
+            memcpy(&payload_bytes, buffer.data(), sizeof(payload_bytes));
+            const size_t frame_bytes = sizeof(payload_bytes) + payload_bytes;
+            if (payload_bytes > MAX_FRAME_BYTES || frame_bytes <= bytesRead)
+            {
+                break;
+            }
+            buffer.resize(frame_bytes);
+
+            DWORD moreBytesRead = 0;
+            ok = ReadFile(input_pipe_handle, buffer.data() + bytesRead, static_cast<DWORD>(frame_bytes - bytesRead), &moreBytesRead, nullptr);
+            bytesRead += moreBytesRead;
+        }
+        if (!ok)
+        {
+            // The client disconnected, or the pipe is closing.
+            break;
+        }
+
+        frame_header_t payload_bytes;
+        if (bytesRead < sizeof(payload_bytes))
+        {
+            break;
+        }
+        memcpy(&payload_bytes, buffer.data(), sizeof(payload_bytes));
+        if (payload_bytes != bytesRead - sizeof(payload_bytes) || payload_bytes % sizeof(wchar_t) != 0)
+        {
+            // Not a frame, drop the connection.
             break;
         }
-        iBlock++;
-    } while (!ok);
-    // trim the message's buffer
-    const auto nullCharPos = message.find_last_not_of(L'\0');
-    if (nullCharPos != std::wstring::npos)
-    {
-        message.resize(nullCharPos + 1);
-    }
 
-    input_queue.queue_message(std::move(message));
+        std::wstring message(reinterpret_cast<const wchar_t*>(buffer.data() + sizeof(payload_bytes)), payload_bytes / sizeof(wchar_t));
+        if (!message.empty())
+        {
+            input_queue.queue_message(std::move(message));
+        }
 
-    // Flush the pipe to allow the client to read the pipe's contents
-    // before disconnecting. Then disconnect the pipe, and close the
-    // handle to this pipe instance.
+        if (buffer.size() > BUFSIZE)
+        {
+            buffer.resize(BUFSIZE);
+            buffer.shrink_to_fit();
+        }
+    }
 
-    FlushFileBuffers(input_pipe_handle);
+    {
+        std::unique_lock lock(pipe_connect_handle_mutex);
+        connection_handles.erase(std::remove(connection_handles.begin(), connection_handles.end(), input_pipe_handle), connection_handles.end());
+    }
+    connections_changed.notify_all();
     DisconnectNamedPipe(input_pipe_handle);
     CloseHandle(input_pipe_handle);
 }
@@ -433,10 +524,18 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HAN
         {
             std::unique_lock lock(pipe_connect_handle_mutex);
             current_connect_pipe_handle = NULL;
+            if (connected && !closed)
+            {
+                // Connections are long lived, their threads are joined when the pipe ends.
+                connection_handles.push_back(connect_pipe_handle);
+                connection_threads.emplace_back(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle);
+                continue;
+            }
         }
         if (connected)
         {
-            std::thread(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle).detach();
+            DisconnectNamedPipe(connect_pipe_handle);
+            CloseHandle(connect_pipe_handle);
         }
         else
         {
@@ -451,18 +550,21 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread(
     while (!closed)
     {
         outgoing_message = L"";
-        std::wstring message = input_queue.pop_message();
-        if (message.length() == 0)
+        auto messages = input_queue.pop_batch();
+        if (messages.empty())
         {
             break;
         }
 
-        // Check if callback method exists first before trying to call it.
-        // otherwise just store the response message in a variable.
-        if (dispatch_inc_message_function != nullptr)
+        for (auto& message : messages)
         {
-            dispatch_inc_message_function(message);
+            // Check if callback method exists first before trying to call it.
+            // otherwise just store the response message in a variable.
+            if (dispatch_inc_message_function != nullptr)
+            {
+                dispatch_inc_message_function(message);
+            }
+            outgoing_message = std::move(message);
         }
-        outgoing_message = message;
     }
 }
@@ -4,7 +4,13 @@
 #include <WinSafer.h>
 #include <accctrl.h>
 #include <aclapi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "two_way_pipe_message_ipc.h"
 
 class TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl
@@ -27,10 +33,17 @@ private:
     std::wstring outgoing_message; // Store the updated json settings.
 
     HANDLE current_connect_pipe_handle = NULL;
-    bool closed = false;
+    std::vector<HANDLE> connection_handles; // Connected clients, guarded by pipe_connect_handle_mutex
+    std::condition_variable connections_changed; // Signaled when a connection ends
+    std::list<std::thread> connection_threads;
+    HANDLE output_pipe_handle = NULL; // Only used by the output queue thread
+    std::vector<BYTE> output_frame;
+    std::atomic_bool closed = false;
     TwoWayPipeMessageIPC::callback_function dispatch_inc_message_function;
 
-    void send_pipe_message(std::wstring message);
+    bool connect_output_pipe();
+    void close_output_pipe();
+    void send_pipe_message(const std::wstring& message);
     void consume_output_queue_thread();
     BOOL GetLogonSID(HANDLE hToken, PSID* ppsid);
     VOID FreeLogonSID(PSID* ppsid);
@@ -1,55 +1,182 @@
 #include "pch.h"
 #include "call_tracer.h"
 
-#include <map>
-#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
 
 namespace
 {
     // Non-localizable
-    const std::string entering = " Enter";
-    const std::string exiting = " Exit";
+    const std::string_view indentationMarker = " - ";
 
-    std::mutex indentLevelMutex;
-    std::map<std::thread::id, int> indentLevel;
+    constexpr int maxIndentLevel = 64;
+    constexpr size_t spanBufferSize = 16384;
 
-    std::string GetIndentation()
-    {
-        std::unique_lock lock(indentLevelMutex);
-        int level = indentLevel[std::this_thread::get_id()];
+    // Call depth of the thread
+    thread_local int indentLevel = 0;
 
+    std::string_view GetIndentation(const int level)
+    {
+        static const std::string spaces(2 * maxIndentLevel, ' ');
         if (level <= 0)
         {
             return {};
         }
-        else
+
+        return std::string_view{ spaces }.substr(0, static_cast<size_t>(2) * (std::min)(level, maxIndentLevel) - 1);
+    }
+
+    void TraceCall(const int level, const char* functionName, const char* action)
+    {
+        if (!Logger::shouldLog(spdlog::level::trace))
         {
-            return std::string(static_cast<int64_t>(2) * min(level, 64) - 1, ' ') + " - ";
+            return;
         }
+
+        Logger::trace("{}{}{} {}", GetIndentation(level), level > 0 ? indentationMarker : std::string_view{}, functionName, action);
     }
 
-    void Indent()
+    struct SpanEvent
+    {
+        const char* name;
+        std::chrono::steady_clock::rep timestamp;
+        bool enter;
+    };
+
+    // Written only by its thread
+    struct SpanBuffer
+    {
+        DWORD threadId = GetCurrentThreadId();
+        std::array<SpanEvent, spanBufferSize> events;
+
+        // Number of events recorded, the next one goes to events[count % spanBufferSize]
+        std::atomic<size_t> count = 0;
+    };
+
+    std::atomic_bool spanRecording = false;
+
+    std::mutex spanBuffersMutex;
+
+    // Kept when their thread exits, so its spans can still be exported
+    std::vector<std::shared_ptr<SpanBuffer>> spanBuffers;
+    thread_local SpanBuffer* threadSpanBuffer = nullptr;
+
+    void RecordSpanEvent(const char* functionName, const bool enter)
     {
-        std::unique_lock lock(indentLevelMutex);
-        indentLevel[std::this_thread::get_id()]++;
+        if (!spanRecording.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        // Allocated once per thread, the first time it records
+        if (threadSpanBuffer == nullptr)
+        {
+            auto buffer = std::make_shared<SpanBuffer>();
+            std::unique_lock lock(spanBuffersMutex);
+            spanBuffers.push_back(buffer);
+            threadSpanBuffer = buffer.get();
+        }
+
+        const size_t count = threadSpanBuffer->count.load(std::memory_order_relaxed);
+        threadSpanBuffer->events[count % spanBufferSize] = SpanEvent{ .name = functionName,
+                                                                      .timestamp = std::chrono::steady_clock::now().time_since_epoch().count(),
+                                                                      .enter = enter };
+        threadSpanBuffer->count.store(count + 1, std::memory_order_release);
     }
 
-    void Unindent()
+    void WriteJsonString(std::ostream& stream, const std::string_view value)
     {
-        std::unique_lock lock(indentLevelMutex);
-        indentLevel[std::this_thread::get_id()]--;
+        stream << '"';
+        for (const char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                stream << ' ';
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
     }
 }
 
 CallTracer::CallTracer(const char* functionName) :
     functionName(functionName)
 {
-    Logger::trace((GetIndentation() + functionName + entering).c_str());
-    Indent();
+    TraceCall(indentLevel, functionName, "Enter");
+    indentLevel++;
+    RecordSpanEvent(functionName, true);
 }
 
 CallTracer::~CallTracer()
 {
-    Unindent();
-    Logger::trace((GetIndentation() + functionName + exiting).c_str());
+    RecordSpanEvent(functionName, false);
+    indentLevel--;
+    TraceCall(indentLevel, functionName, "Exit");
+}
+
+void CallTracer::startSpanRecording()
+{
+    {
+        std::unique_lock lock(spanBuffersMutex);
+        for (auto& buffer : spanBuffers)
+        {
+            buffer->count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    spanRecording.store(true, std::memory_order_release);
+}
+
+void CallTracer::stopSpanRecording()
+{
+    spanRecording.store(false, std::memory_order_release);
+}
+
+bool CallTracer::exportChromeTrace(const std::filesystem::path& path)
+{
+    std::ofstream file{ path, std::ios::binary };
+    if (!file.is_open())
+    {
+        Logger::error(L"Failed to open {} to export the call spans", path.wstring());
+        return false;
+    }
+
+    const DWORD processId = GetCurrentProcessId();
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+    bool firstEvent = true;
+    std::unique_lock lock(spanBuffersMutex);
+    for (const auto& buffer : spanBuffers)
+    {
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        const size_t first = count > spanBufferSize ? count - spanBufferSize : 0;
+        for (size_t i = first; i < count; ++i)
+        {
+            const SpanEvent& event = buffer->events[i % spanBufferSize];
+            const std::chrono::duration<double, std::micro> timestamp = std::chrono::steady_clock::duration{ event.timestamp };
+
+            file << (firstEvent ? "\n" : ",\n") << "{\"name\":";
+            WriteJsonString(file, event.name);
+            file << ",\"ph\":\"" << (event.enter ? 'B' : 'E') << "\",\"ts\":" << timestamp.count()
+                 << ",\"pid\":" << processId << ",\"tid\":" << buffer->threadId << '}';
+            firstEvent = false;
+        }
+    }
+
+    file << "\n]}\n";
+    return file.good();
 }
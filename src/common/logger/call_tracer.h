@@ -1,15 +1,29 @@
 #pragma once
 
+#include <filesystem>
 #include <string>
 
 #include "logger.h"
 
 #define _TRACER_ CallTracer callTracer(__FUNCTION__)
 
+// Logs the enter and exit of a function at trace level, indented by the call depth of the
+// thread. While span recording is on, the enter and exit timestamps are also recorded to a
+// ring buffer of the thread, which can be exported as a Chrome trace (chrome://tracing,
+// https://ui.perfetto.dev) to profile the traced functions.
 class CallTracer
 {
-    std::string functionName;
+    // Must be a string literal, it's kept without copying
+    const char* functionName;
+
 public:
     CallTracer(const char* functionName);
     ~CallTracer();
+
+    static void startSpanRecording();
+    static void stopSpanRecording();
+
+    // Writes the spans recorded by every thread, the oldest ones are overwritten when a thread
+    // records more than its ring buffer holds. Call after stopping the recording.
+    static bool exportChromeTrace(const std::filesystem::path& path);
 };
@@ -4,6 +4,7 @@
 #include "framework.h"
 #include "logger.h"
 #include <unordered_map>
+#include <spdlog/async.h>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
 #include <spdlog/sinks/null_sink.h>
@@ -44,6 +45,33 @@ level_enum getLogLevel(std::wstring_view logSettingsPath)
     return level_enum::trace;
 }
 
+namespace
+{
+    // All the asynchronous loggers of the process share one writer thread and its queue
+    std::shared_ptr<spdlog::details::thread_pool> getWriterThreadPool(const size_t queueSize)
+    {
+        auto threadPool = spdlog::thread_pool();
+        if (threadPool == nullptr)
+        {
+            spdlog::init_thread_pool(queueSize, 1);
+            threadPool = spdlog::thread_pool();
+        }
+
+        return threadPool;
+    }
+
+    spdlog::async_overflow_policy toSpdlogPolicy(const Logger::AsyncOptions::OverflowPolicy policy)
+    {
+        switch (policy)
+        {
+        case Logger::AsyncOptions::OverflowPolicy::DropOldest:
+            return spdlog::async_overflow_policy::overrun_oldest;
+        default:
+            return spdlog::async_overflow_policy::block;
+        }
+    }
+}
+
 std::shared_ptr<spdlog::logger> Logger::logger = spdlog::null_logger_mt("null");
 
 bool Logger::wasLogFailedShown()
@@ -55,7 +83,7 @@ bool Logger::wasLogFailedShown()
     return len;
 }
 
-void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath)
+void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, std::optional<AsyncOptions> asyncOptions)
 {
     auto logLevel = getLogLevel(logSettingsPath);
     bool newLoggerCreated = false;
@@ -64,16 +92,25 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
         logger = spdlog::get(loggerName);
         if (logger == nullptr)
         {
-            auto sink = make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+            std::vector<spdlog::sink_ptr> sinks{ make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention) };
             if (IsDebuggerPresent())
             {
                 auto msvc_sink = make_shared<msvc_sink_mt>();
                 msvc_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [t-%t] [%l] %v");
-                logger = make_shared<spdlog::logger>(loggerName, sinks_init_list{ sink, msvc_sink });
+                sinks.push_back(msvc_sink);
+            }
+
+            if (asyncOptions.has_value())
+            {
+                logger = make_shared<spdlog::async_logger>(loggerName,
+                                                           begin(sinks),
+                                                           end(sinks),
+                                                           getWriterThreadPool(asyncOptions->queueSize),
+                                                           toSpdlogPolicy(asyncOptions->overflowPolicy));
             }
             else
             {
-                logger = make_shared<spdlog::logger>(loggerName, sink);
+                logger = make_shared<spdlog::logger>(loggerName, begin(sinks), end(sinks));
             }
             newLoggerCreated = true;
         }
@@ -99,7 +136,16 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
     {
         logger->set_level(logLevel);
         logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [p-%P] [t-%t] [%l] %v");
-        logger->flush_on(logLevel); // Auto flush on every log message.
+        if (asyncOptions.has_value())
+        {
+            // The writer thread batches the writes, errors are still flushed right away
+            logger->flush_on(level_enum::err);
+            spdlog::flush_every(asyncOptions->flushInterval);
+        }
+        else
+        {
+            logger->flush_on(logLevel); // Auto flush on every log message.
+        }
         spdlog::register_logger(logger);
     }
 
@@ -116,3 +162,13 @@ void Logger::init(std::vector<spdlog::sink_ptr> sinks)
 
     Logger::logger = init_logger;
 }
+
+void Logger::shutdown()
+{
+    // Other threads might still be logging through the logger, so it's kept and only stops accepting messages
+    logger->set_level(level_enum::off);
+    logger->flush();
+
+    // Destroying the writer thread pool waits for the queued messages to be written
+    spdlog::shutdown();
+}
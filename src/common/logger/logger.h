@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <optional>
 #include <spdlog/spdlog.h>
 #include "logger_settings.h"
 
@@ -10,11 +12,41 @@ private:
     static bool wasLogFailedShown();
 
 public:
+    // Options of the asynchronous mode, where the calling thread only formats the message and
+    // queues it, and a background thread writes the queued messages to the sinks.
+    struct AsyncOptions
+    {
+        enum class OverflowPolicy
+        {
+            // The caller waits for the writer to free a slot, no message is lost
+            Block,
+            // The oldest queued message is replaced, the caller never waits
+            DropOldest,
+        };
+
+        // Number of messages the queue can hold, it's allocated once
+        size_t queueSize = 8192;
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+        // Messages below error level reach the file at this interval at the latest
+        std::chrono::seconds flushInterval{ 3 };
+    };
+
     Logger() = delete;
 
-    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath);
+    // Messages are written and flushed on the calling thread, unless asyncOptions are given
+    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, std::optional<AsyncOptions> asyncOptions = std::nullopt);
     static void init(std::vector<spdlog::sink_ptr> sinks);
 
+    // Writes the queued messages and stops the background writer of the asynchronous mode.
+    // Messages logged afterwards are discarded.
+    static void shutdown();
+
+    // Lets callers skip preparing the arguments of messages that would be filtered out
+    static bool shouldLog(const spdlog::level::level_enum level)
+    {
+        return logger->should_log(level);
+    }
+
     // log message should not be localized
     template<typename FormatString, typename... Args>
     static void trace(const FormatString& fmt, const Args&... args)
@@ -57,6 +89,7 @@ public:
         logger->critical(fmt, args...);
     }
 
+    // In the asynchronous mode the flush happens after the messages queued before it are written
     static void flush()
     {
         logger->flush();
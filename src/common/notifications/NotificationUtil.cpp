@@ -20,14 +20,15 @@ namespace notifications
         ReadSettings();
         auto settingsFileName = PTSettingsHelper::get_powertoys_general_save_file_location();
 
-        m_settingsFileWatcher = std::make_unique<FileWatcher>(settingsFileName, [this]() {
-            ReadSettings();
+        // Other watchers of the general settings in this process share the parsed file
+        m_settingsSubscription = FileWatcher::SubscribeJson(settingsFileName, [this](const json::JsonObject& settings) {
+            ReadSettings(settings);
         });
     }
 
     NotificationUtil::~NotificationUtil()
     {
-        m_settingsFileWatcher.reset();
+        m_settingsSubscription.reset();
     }
 
     void NotificationUtil::WarnIfElevationIsRequired(std::wstring title, std::wstring message, std::wstring button1, std::wstring button2)
@@ -50,7 +51,11 @@ namespace notifications
 
     void NotificationUtil::ReadSettings()
     {
-        auto settings = PTSettingsHelper::load_general_settings();
+        ReadSettings(PTSettingsHelper::load_general_settings());
+    }
+
+    void NotificationUtil::ReadSettings(const json::JsonObject& settings)
+    {
         m_warningsElevatedApps = settings.GetNamedBoolean(L"enable_warnings_elevated_apps", true);
     }
 }
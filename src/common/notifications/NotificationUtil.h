@@ -13,10 +13,11 @@ namespace notifications
         void WarnIfElevationIsRequired(std::wstring title, std::wstring message, std::wstring button1, std::wstring button2);
 
     private:
-        std::unique_ptr<FileWatcher> m_settingsFileWatcher;
+        std::shared_ptr<void> m_settingsSubscription;
         bool m_warningsElevatedApps;
         bool m_warningShown = false;
 
         void ReadSettings();
+        void ReadSettings(const json::JsonObject& settings);
     };
 }
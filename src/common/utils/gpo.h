@@ -1,7 +1,12 @@
 #pragma once
 
 #include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace powertoys_gpo
@@ -116,99 +121,328 @@ namespace powertoys_gpo
         }
 
         // RegGetValueW overshoots sometimes. Use a buffer first to not have characters past the string end.
-        wchar_t* temp_buffer = new wchar_t[string_buffer_capacity / sizeof(wchar_t) + 1];
+        std::wstring buffer(string_buffer_capacity / sizeof(wchar_t) + 1, L'\0');
         // Read string
-        if (RegGetValueW(hRootKey, subKey.c_str(), value_name.c_str(), reg_flags, &reg_value_type, temp_buffer, &string_buffer_capacity) != ERROR_SUCCESS)
+        if (RegGetValueW(hRootKey, subKey.c_str(), value_name.c_str(), reg_flags, &reg_value_type, buffer.data(), &string_buffer_capacity) != ERROR_SUCCESS)
         {
-            delete temp_buffer;
             return std::nullopt;
         }
 
-        // Convert buffer to std::wstring
-        std::wstring string_value = L"";
         if (reg_value_type == REG_MULTI_SZ)
         {
-            // If it is REG_MULTI_SZ handle this way
-            wchar_t* currentString = temp_buffer;
-            while (*currentString != L'\0')
+            // If it is REG_MULTI_SZ, join the strings with line breaks
+            std::wstring string_value;
+            for (const wchar_t* currentString = buffer.c_str(); *currentString != L'\0'; currentString += wcslen(currentString) + 1)
             {
-                // If first entry then assign the string, else add to the string
-                string_value = (string_value == L"") ? currentString : (string_value + L"\r\n" + currentString);
-                currentString += wcslen(currentString) + 1; // Move to the next string
+                if (!string_value.empty())
+                {
+                    string_value += L"\r\n";
+                }
+                string_value += currentString;
             }
+            return string_value;
         }
-        else
+
+        // If it is REG_SZ, cut the string at its terminator
+        buffer.resize(wcslen(buffer.c_str()));
+        return buffer;
+    }
+
+    // All the values directly under a registry key, read at once.
+    struct policy_registry_value
+    {
+        std::wstring name;
+        DWORD type = REG_NONE;
+        std::vector<BYTE> data;
+    };
+
+    struct policy_registry_key
+    {
+        LSTATUS status = ERROR_FILE_NOT_FOUND; // Result of opening the key
+        std::vector<policy_registry_value> values; // Sorted by name, case insensitively like the registry
+
+        const policy_registry_value* find(const std::wstring& name) const
         {
-            // If it is REG_SZ handle this way
-            string_value = temp_buffer;
+            auto it = std::lower_bound(values.begin(), values.end(), name, [](const policy_registry_value& value, const std::wstring& name) {
+                return _wcsicmp(value.name.c_str(), name.c_str()) < 0;
+            });
+            return it != values.end() && _wcsicmp(it->name.c_str(), name.c_str()) == 0 ? &*it : nullptr;
         }
 
-        // delete buffer, return string value
-        delete temp_buffer;
-        return string_value;
-    }
+        // Same result as RegQueryValueExW into a DWORD initialized to 0xFFFFFFFE.
+        std::optional<DWORD> dword_value(const std::wstring& name) const
+        {
+            auto value = find(name);
+            if (!value || value->data.size() > sizeof(DWORD))
+            {
+                return std::nullopt;
+            }
 
-    inline gpo_rule_configured_t getConfiguredValue(const std::wstring& registry_value_name)
+            DWORD result = 0xFFFFFFFE;
+            std::copy(value->data.begin(), value->data.end(), reinterpret_cast<BYTE*>(&result));
+            return result;
+        }
+
+        // Same result as readRegistryStringValue, which gets REG_EXPAND_SZ values expanded.
+        std::optional<std::wstring> string_value(const std::wstring& name, const bool is_multi_line_text = false) const
+        {
+            auto value = find(name);
+            const bool type_matches = is_multi_line_text ? value && value->type == REG_MULTI_SZ :
+                                                           value && (value->type == REG_SZ || value->type == REG_EXPAND_SZ);
+            if (!type_matches || value->data.empty())
+            {
+                return std::nullopt;
+            }
+
+            std::wstring buffer(value->data.size() / sizeof(wchar_t) + 2, L'\0');
+            std::copy(value->data.begin(), value->data.end(), reinterpret_cast<BYTE*>(buffer.data()));
+
+            std::wstring string_value;
+            for (const wchar_t* currentString = buffer.c_str(); *currentString != L'\0'; currentString += wcslen(currentString) + 1)
+            {
+                if (!string_value.empty())
+                {
+                    string_value += L"\r\n";
+                }
+                string_value += currentString;
+                if (!is_multi_line_text)
+                {
+                    break;
+                }
+            }
+
+            if (value->type == REG_EXPAND_SZ)
+            {
+                const DWORD expanded_length = ExpandEnvironmentStringsW(string_value.c_str(), nullptr, 0);
+                if (expanded_length == 0)
+                {
+                    return std::nullopt;
+                }
+
+                std::wstring expanded(expanded_length, L'\0');
+                if (ExpandEnvironmentStringsW(string_value.c_str(), expanded.data(), expanded_length) == 0)
+                {
+                    return std::nullopt;
+                }
+                expanded.resize(wcslen(expanded.c_str()));
+                return expanded;
+            }
+            return string_value;
+        }
+    };
+
+    // Registry access of the policy snapshot, replaced in tests.
+    class policy_registry_backend
     {
-        HKEY key{};
-        DWORD value = 0xFFFFFFFE;
-        DWORD valueSize = sizeof(value);
+    public:
+        virtual ~policy_registry_backend() = default;
+
+        virtual policy_registry_key read_key(HKEY scope, const std::wstring& sub_key) = 0;
+
+        // Arms a one time notification that signals the event on the next change of any policy.
+        // Returns false if changes can't be watched.
+        virtual bool watch_changes(HANDLE event) = 0;
+    };
 
-        bool machine_key_found = true;
-        if (auto res = RegOpenKeyExW(POLICIES_SCOPE_MACHINE, POLICIES_PATH.c_str(), 0, KEY_READ, &key); res != ERROR_SUCCESS)
+    class win32_policy_registry_backend : public policy_registry_backend
+    {
+    public:
+        win32_policy_registry_backend()
         {
-            machine_key_found = false;
+            // The PowerToys key may not exist yet, watch its parent
+            RegOpenKeyExW(POLICIES_SCOPE_MACHINE, L"SOFTWARE\\Policies", 0, KEY_NOTIFY, &machine_policies);
+            RegOpenKeyExW(POLICIES_SCOPE_USER, L"SOFTWARE\\Policies", 0, KEY_NOTIFY, &user_policies);
         }
 
-        if (machine_key_found)
+        ~win32_policy_registry_backend()
         {
-            // If the path was found in the machine, we need to check if the value for the policy exists.
-            auto res = RegQueryValueExW(key, registry_value_name.c_str(), nullptr, nullptr, reinterpret_cast<LPBYTE>(&value), &valueSize);
+            if (machine_policies)
+            {
+                RegCloseKey(machine_policies);
+            }
+            if (user_policies)
+            {
+                RegCloseKey(user_policies);
+            }
+        }
 
+        policy_registry_key read_key(HKEY scope, const std::wstring& sub_key) override
+        {
+            policy_registry_key result;
+            HKEY key{};
+            result.status = RegOpenKeyExW(scope, sub_key.c_str(), 0, KEY_READ, &key);
+            if (result.status != ERROR_SUCCESS)
+            {
+                return result;
+            }
+
+            DWORD value_count = 0, max_name_length = 0, max_data_size = 0;
+            if (RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &value_count, &max_name_length, &max_data_size, nullptr, nullptr) == ERROR_SUCCESS)
+            {
+                // The buffers are reused for all the values
+                std::wstring name(max_name_length + 1, L'\0');
+                std::vector<BYTE> data(max_data_size);
+                for (DWORD i = 0; i < value_count; i++)
+                {
+                    DWORD name_length = static_cast<DWORD>(name.size());
+                    DWORD data_size = static_cast<DWORD>(data.size());
+                    DWORD type = REG_NONE;
+                    if (RegEnumValueW(key, i, name.data(), &name_length, nullptr, &type, data.data(), &data_size) == ERROR_SUCCESS)
+                    {
+                        result.values.push_back({ .name = name.substr(0, name_length), .type = type, .data = { data.begin(), data.begin() + data_size } });
+                    }
+                }
+            }
             RegCloseKey(key);
 
-            if (res != ERROR_SUCCESS)
+            std::sort(result.values.begin(), result.values.end(), [](const policy_registry_value& lhs, const policy_registry_value& rhs) {
+                return _wcsicmp(lhs.name.c_str(), rhs.name.c_str()) < 0;
+            });
+            return result;
+        }
+
+        bool watch_changes(HANDLE event) override
+        {
+            // The registrations must outlive the thread that made them
+            const DWORD filter = REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+            return machine_policies && user_policies &&
+                   RegNotifyChangeKeyValue(machine_policies, TRUE, filter, event, TRUE) == ERROR_SUCCESS &&
+                   RegNotifyChangeKeyValue(user_policies, TRUE, filter, event, TRUE) == ERROR_SUCCESS;
+        }
+
+    private:
+        HKEY machine_policies{};
+        HKEY user_policies{};
+    };
+
+    // The policy keys, read at once.
+    struct policy_snapshot
+    {
+        policy_registry_key machine_policies;
+        policy_registry_key user_policies;
+        policy_registry_key machine_plugin_list;
+        policy_registry_key user_plugin_list;
+
+        const policy_registry_key* find_key(HKEY scope, const std::wstring& sub_key) const
+        {
+            if (sub_key == POLICIES_PATH)
+            {
+                return scope == POLICIES_SCOPE_MACHINE ? &machine_policies : scope == POLICIES_SCOPE_USER ? &user_policies : nullptr;
+            }
+            if (sub_key == POWER_LAUNCHER_INDIVIDUAL_PLUGIN_ENABLED_LIST_PATH)
             {
-                // Value not found on the path.
-                machine_key_found = false;
+                return scope == POLICIES_SCOPE_MACHINE ? &machine_plugin_list : scope == POLICIES_SCOPE_USER ? &user_plugin_list : nullptr;
             }
+            return nullptr;
         }
 
-        if (!machine_key_found)
+        gpo_rule_configured_t configured_value(const std::wstring& registry_value_name) const
         {
             // If there's no value found on the machine scope, try to get it from the user scope.
-            if (auto res = RegOpenKeyExW(POLICIES_SCOPE_USER, POLICIES_PATH.c_str(), 0, KEY_READ, &key); res != ERROR_SUCCESS)
+            auto value = machine_policies.dword_value(registry_value_name);
+            if (!value)
             {
-                if (res == ERROR_FILE_NOT_FOUND)
+                if (user_policies.status != ERROR_SUCCESS)
+                {
+                    return user_policies.status == ERROR_FILE_NOT_FOUND ? gpo_rule_configured_not_configured : gpo_rule_configured_unavailable;
+                }
+
+                value = user_policies.dword_value(registry_value_name);
+                if (!value)
                 {
                     return gpo_rule_configured_not_configured;
                 }
-                return gpo_rule_configured_unavailable;
             }
-            auto res = RegQueryValueExW(key, registry_value_name.c_str(), nullptr, nullptr, reinterpret_cast<LPBYTE>(&value), &valueSize);
-            RegCloseKey(key);
 
-            if (res != ERROR_SUCCESS)
+            switch (*value)
             {
-                return gpo_rule_configured_not_configured;
+            case 0:
+                return gpo_rule_configured_disabled;
+            case 1:
+                return gpo_rule_configured_enabled;
+            default:
+                return gpo_rule_configured_wrong_value;
+            }
+        }
+    };
+
+    // Reads the policies once and again only after the registry signals a change, so the
+    // policy getters don't hit the registry on every call. Reads don't take a lock.
+    class policy_snapshot_cache
+    {
+    public:
+        explicit policy_snapshot_cache(std::unique_ptr<policy_registry_backend> registry_backend) :
+            backend(std::move(registry_backend)),
+            changed_event(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+        {
+        }
+
+        ~policy_snapshot_cache()
+        {
+            if (changed_event)
+            {
+                CloseHandle(changed_event);
             }
         }
 
-        switch (value)
+        policy_snapshot_cache(const policy_snapshot_cache&) = delete;
+        policy_snapshot_cache& operator=(const policy_snapshot_cache&) = delete;
+
+        std::shared_ptr<const policy_snapshot> get()
         {
-        case 0:
-            return gpo_rule_configured_disabled;
-        case 1:
-            return gpo_rule_configured_enabled;
-        default:
-            return gpo_rule_configured_wrong_value;
+            auto snapshot = current.load();
+            if (snapshot && WaitForSingleObject(changed_event, 0) == WAIT_TIMEOUT)
+            {
+                return snapshot;
+            }
+
+            std::lock_guard lock{ refresh_mutex };
+
+            // Watch before reading, so a change made while reading isn't missed
+            const bool watching = changed_event && backend->watch_changes(changed_event);
+
+            auto fresh = std::make_shared<policy_snapshot>();
+            fresh->machine_policies = backend->read_key(POLICIES_SCOPE_MACHINE, POLICIES_PATH);
+            fresh->user_policies = backend->read_key(POLICIES_SCOPE_USER, POLICIES_PATH);
+            fresh->machine_plugin_list = backend->read_key(POLICIES_SCOPE_MACHINE, POWER_LAUNCHER_INDIVIDUAL_PLUGIN_ENABLED_LIST_PATH);
+            fresh->user_plugin_list = backend->read_key(POLICIES_SCOPE_USER, POWER_LAUNCHER_INDIVIDUAL_PLUGIN_ENABLED_LIST_PATH);
+
+            // Without a notification the snapshot could get stale, read again next time
+            current.store(watching ? fresh : nullptr);
+            return fresh;
         }
+
+    private:
+        std::unique_ptr<policy_registry_backend> backend;
+        HANDLE changed_event;
+        std::mutex refresh_mutex;
+        std::atomic<std::shared_ptr<const policy_snapshot>> current;
+    };
+
+    inline std::shared_ptr<const policy_snapshot> getPolicySnapshot()
+    {
+        static policy_snapshot_cache cache{ std::make_unique<win32_policy_registry_backend>() };
+        return cache.get();
+    }
+
+    inline gpo_rule_configured_t getConfiguredValue(const std::wstring& registry_value_name)
+    {
+        return getPolicySnapshot()->configured_value(registry_value_name);
     }
 
     inline std::optional<std::wstring> getPolicyListValue(const std::wstring& registry_list_path, const std::wstring& registry_list_value_name)
     {
         // This function returns the value of an entry of an policy list. The user scope is only checked, if the list is not enabled for the machine to not mix the lists.
+        auto snapshot = getPolicySnapshot();
+        auto machine_list = snapshot->find_key(POLICIES_SCOPE_MACHINE, registry_list_path);
+        auto user_list = snapshot->find_key(POLICIES_SCOPE_USER, registry_list_path);
+        if (machine_list && user_list)
+        {
+            return machine_list->status == ERROR_SUCCESS ? machine_list->string_value(registry_list_value_name) :
+                                                           user_list->string_value(registry_list_value_name);
+        }
 
+        // Lists that aren't part of the snapshot are read from the registry.
         HKEY key{};
 
         // Try to read from the machine list.
@@ -600,10 +834,11 @@ namespace powertoys_gpo
     inline std::wstring getConfiguredMwbPolicyDefinedIpMappingRules()
     {
         // Important: HKLM has priority over HKCU
-        auto mapping_rules = readRegistryStringValue(HKEY_LOCAL_MACHINE, POLICIES_PATH, POLICY_MWB_POLICY_DEFINED_IP_MAPPING_RULES, true);
+        auto snapshot = getPolicySnapshot();
+        auto mapping_rules = snapshot->machine_policies.string_value(POLICY_MWB_POLICY_DEFINED_IP_MAPPING_RULES, true);
         if (!mapping_rules.has_value())
         {
-            mapping_rules = readRegistryStringValue(HKEY_CURRENT_USER, POLICIES_PATH, POLICY_MWB_POLICY_DEFINED_IP_MAPPING_RULES, true);
+            mapping_rules = snapshot->user_policies.string_value(POLICY_MWB_POLICY_DEFINED_IP_MAPPING_RULES, true);
         }
 
         // return value
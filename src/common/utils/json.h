@@ -4,6 +4,8 @@
 #include <winrt/Windows.Foundation.Collections.h>
 #include <winrt/Windows.Data.Json.h>
 
+#include "json_stream.h"
+
 #include <optional>
 #include <fstream>
 
@@ -15,12 +17,15 @@ namespace json
     {
         try
         {
-            std::ifstream file(file_name.data(), std::ios::binary);
-            if (file.is_open())
+            // Parsed straight from the UTF-8 file contents
+            const auto contents = stream::read_file(file_name);
+            if (!contents)
+            {
+                return std::nullopt;
+            }
+            if (auto value = stream::parse(*contents); value && value.ValueType() == JsonValueType::Object)
             {
-                using isbi = std::istreambuf_iterator<char>;
-                std::string obj_str{ isbi{ file }, isbi{} };
-                return JsonValue::Parse(winrt::to_hstring(obj_str)).GetObjectW();
+                return value.GetObjectW();
             }
             return std::nullopt;
         }
@@ -32,8 +37,8 @@ namespace json
 
     inline void to_file(std::wstring_view file_name, const JsonObject& obj)
     {
-        std::wstring obj_str{ obj.Stringify().c_str() };
-        std::ofstream{ file_name.data(), std::ios::binary } << winrt::to_string(obj_str);
+        std::ofstream file{ file_name.data(), std::ios::binary };
+        stream::Writer{ file }.write_value(obj);
     }
 
     inline bool has(
@@ -0,0 +1,663 @@
+#pragma once
+
+#include <Windows.h>
+
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
+#include <winrt/Windows.Data.Json.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Reads and writes JSON documents as UTF-8 without the UTF-16 copy of the whole document that
+// JsonValue::Parse and Stringify need. Values are built into and read from the usual
+// Windows.Data.Json object model, so the json helpers work with them as before.
+namespace json::stream
+{
+    using namespace winrt::Windows::Data::Json;
+
+    // Reads a whole file into memory, nullopt if it can't be read. The file is opened and
+    // closed here and not mapped, so writers that truncate it are never blocked by a reader.
+    inline std::optional<std::string> read_file(std::wstring_view file_name)
+    {
+        const HANDLE file = CreateFileW(file_name.data(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return std::nullopt;
+        }
+
+        std::optional<std::string> contents;
+        LARGE_INTEGER size{};
+        if (GetFileSizeEx(file, &size))
+        {
+            contents.emplace(static_cast<size_t>(size.QuadPart), '\0');
+
+            // The size is only a hint, the file may change while it's read
+            size_t length = 0;
+            DWORD read = 0;
+            while (true)
+            {
+                if (length == contents->size())
+                {
+                    contents->resize(length + 4096);
+                }
+                const DWORD chunk = static_cast<DWORD>((std::min)(contents->size() - length, static_cast<size_t>(1 << 30)));
+                if (!ReadFile(file, contents->data() + length, chunk, &read, nullptr))
+                {
+                    contents.reset();
+                    break;
+                }
+                if (read == 0)
+                {
+                    contents->resize(length);
+                    break;
+                }
+                length += read;
+            }
+        }
+
+        CloseHandle(file);
+        return contents;
+    }
+
+    // Recursive descent parser of RFC 8259 JSON. Strings are decoded straight from UTF-8,
+    // invalid UTF-8 sequences become U+FFFD like they do with winrt::to_hstring.
+    class Parser
+    {
+    public:
+        explicit Parser(std::string_view text) :
+            current(text.data()), end(text.data() + text.size())
+        {
+        }
+
+        // Returns nullptr if the text isn't a single JSON value
+        IJsonValue parse()
+        {
+            // Tolerate a UTF-8 BOM
+            if (end - current >= 3 && std::string_view{ current, 3 } == "\xEF\xBB\xBF")
+            {
+                current += 3;
+            }
+
+            auto value = parse_value();
+            skip_whitespace();
+            if (current != end)
+            {
+                return nullptr;
+            }
+            return value;
+        }
+
+    private:
+        // Deeper documents are rejected instead of overflowing the stack
+        static constexpr int max_depth = 512;
+
+        const char* current;
+        const char* end;
+        int depth = 0;
+
+        // Reused by every string
+        std::wstring buffer;
+
+        void skip_whitespace()
+        {
+            while (current != end && (*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r'))
+            {
+                ++current;
+            }
+        }
+
+        bool consume(char c)
+        {
+            if (current != end && *current == c)
+            {
+                ++current;
+                return true;
+            }
+            return false;
+        }
+
+        bool consume(std::string_view word)
+        {
+            if (static_cast<size_t>(end - current) >= word.size() && std::string_view{ current, word.size() } == word)
+            {
+                current += word.size();
+                return true;
+            }
+            return false;
+        }
+
+        // Returns false if there was no digit
+        bool skip_digits()
+        {
+            const char* start = current;
+            while (current != end && *current >= '0' && *current <= '9')
+            {
+                ++current;
+            }
+            return current != start;
+        }
+
+        IJsonValue parse_value()
+        {
+            skip_whitespace();
+            if (current == end)
+            {
+                return nullptr;
+            }
+
+            switch (*current)
+            {
+            case '{':
+                return parse_object();
+            case '[':
+                return parse_array();
+            case '"':
+                if (auto string = parse_string())
+                {
+                    return JsonValue::CreateStringValue(*string);
+                }
+                return nullptr;
+            case 't':
+                if (consume("true"))
+                {
+                    return JsonValue::CreateBooleanValue(true);
+                }
+                return nullptr;
+            case 'f':
+                if (consume("false"))
+                {
+                    return JsonValue::CreateBooleanValue(false);
+                }
+                return nullptr;
+            case 'n':
+                if (consume("null"))
+                {
+                    return JsonValue::CreateNullValue();
+                }
+                return nullptr;
+            default:
+                return parse_number();
+            }
+        }
+
+        IJsonValue parse_object()
+        {
+            if (++depth > max_depth)
+            {
+                return nullptr;
+            }
+
+            ++current;
+            JsonObject object;
+            skip_whitespace();
+            if (!consume('}'))
+            {
+                do
+                {
+                    skip_whitespace();
+                    if (current == end || *current != '"')
+                    {
+                        return nullptr;
+                    }
+                    auto key = parse_string();
+                    if (!key)
+                    {
+                        return nullptr;
+                    }
+                    skip_whitespace();
+                    if (!consume(':'))
+                    {
+                        return nullptr;
+                    }
+                    auto value = parse_value();
+                    if (!value)
+                    {
+                        return nullptr;
+                    }
+                    object.Insert(*key, value);
+                    skip_whitespace();
+                } while (consume(','));
+
+                if (!consume('}'))
+                {
+                    return nullptr;
+                }
+            }
+
+            --depth;
+            return object;
+        }
+
+        IJsonValue parse_array()
+        {
+            if (++depth > max_depth)
+            {
+                return nullptr;
+            }
+
+            ++current;
+            JsonArray array;
+            skip_whitespace();
+            if (!consume(']'))
+            {
+                do
+                {
+                    auto value = parse_value();
+                    if (!value)
+                    {
+                        return nullptr;
+                    }
+                    array.Append(value);
+                    skip_whitespace();
+                } while (consume(','));
+
+                if (!consume(']'))
+                {
+                    return nullptr;
+                }
+            }
+
+            --depth;
+            return array;
+        }
+
+        IJsonValue parse_number()
+        {
+            const char* start = current;
+            consume('-');
+            if (!consume('0') && !skip_digits())
+            {
+                return nullptr;
+            }
+            if (consume('.') && !skip_digits())
+            {
+                return nullptr;
+            }
+            if (consume('e') || consume('E'))
+            {
+                if (!consume('+'))
+                {
+                    consume('-');
+                }
+                if (!skip_digits())
+                {
+                    return nullptr;
+                }
+            }
+
+            double number{};
+            const auto [end_of_number, error] = std::from_chars(start, current, number);
+            if (error == std::errc::result_out_of_range)
+            {
+                // Like JsonValue::Parse, too large numbers become infinite and too small ones zero
+                number = std::strtod(std::string{ start, current }.c_str(), nullptr);
+            }
+            else if (error != std::errc{} || end_of_number != current)
+            {
+                return nullptr;
+            }
+            return JsonValue::CreateNumberValue(number);
+        }
+
+        // The current character is the opening quote
+        std::optional<winrt::hstring> parse_string()
+        {
+            ++current;
+            buffer.clear();
+            while (true)
+            {
+                const char* run = current;
+                while (current != end && *current != '"' && *current != '\\' && static_cast<unsigned char>(*current) >= 0x20)
+                {
+                    ++current;
+                }
+                append_utf8(run, current);
+
+                if (current == end || static_cast<unsigned char>(*current) < 0x20)
+                {
+                    return std::nullopt;
+                }
+                if (*current++ == '"')
+                {
+                    return winrt::hstring{ buffer };
+                }
+
+                if (current == end)
+                {
+                    return std::nullopt;
+                }
+                switch (*current++)
+                {
+                case '"':
+                    buffer.push_back(L'"');
+                    break;
+                case '\\':
+                    buffer.push_back(L'\\');
+                    break;
+                case '/':
+                    buffer.push_back(L'/');
+                    break;
+                case 'b':
+                    buffer.push_back(L'\b');
+                    break;
+                case 'f':
+                    buffer.push_back(L'\f');
+                    break;
+                case 'n':
+                    buffer.push_back(L'\n');
+                    break;
+                case 'r':
+                    buffer.push_back(L'\r');
+                    break;
+                case 't':
+                    buffer.push_back(L'\t');
+                    break;
+                case 'u':
+                {
+                    // Surrogate pairs are escaped as two code units, which is what UTF-16 stores
+                    uint16_t unit{};
+                    if (end - current < 4 || std::from_chars(current, current + 4, unit, 16).ptr != current + 4)
+                    {
+                        return std::nullopt;
+                    }
+                    current += 4;
+                    buffer.push_back(static_cast<wchar_t>(unit));
+                    break;
+                }
+                default:
+                    return std::nullopt;
+                }
+            }
+        }
+
+        // Multi-byte sequences never contain quotes or backslashes, so a run between escapes
+        // always holds complete sequences
+        void append_utf8(const char* first, const char* last)
+        {
+            while (first != last && static_cast<unsigned char>(*first) < 0x80)
+            {
+                buffer.push_back(static_cast<wchar_t>(*first++));
+            }
+            if (first == last)
+            {
+                return;
+            }
+
+            const int length = static_cast<int>(last - first);
+            const int size = MultiByteToWideChar(CP_UTF8, 0, first, length, nullptr, 0);
+            const size_t offset = buffer.size();
+            buffer.resize(offset + size);
+            MultiByteToWideChar(CP_UTF8, 0, first, length, buffer.data() + offset, size);
+        }
+    };
+
+    // Returns nullptr if the text isn't a single JSON value
+    inline IJsonValue parse(std::string_view utf8)
+    {
+        return Parser{ utf8 }.parse();
+    }
+
+    // Encodes the output as UTF-8 and writes it to the stream in large blocks
+    class Writer
+    {
+    public:
+        explicit Writer(std::ostream& stream) :
+            stream(stream)
+        {
+            buffer.reserve(capacity + 8);
+        }
+
+        ~Writer()
+        {
+            flush();
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        void write(char c)
+        {
+            buffer.push_back(c);
+            flush_if_full();
+        }
+
+        void write(std::string_view text)
+        {
+            buffer.append(text);
+            flush_if_full();
+        }
+
+        void write_value(const IJsonValue& value)
+        {
+            switch (value.ValueType())
+            {
+            case JsonValueType::Null:
+                write("null");
+                break;
+            case JsonValueType::Boolean:
+                write(value.GetBoolean() ? "true" : "false");
+                break;
+            case JsonValueType::Number:
+                write_number(value.GetNumber());
+                break;
+            case JsonValueType::String:
+                write_string(value.GetString());
+                break;
+            case JsonValueType::Array:
+            {
+                write('[');
+                bool first = true;
+                for (const auto& item : value.GetArray())
+                {
+                    if (!first)
+                    {
+                        write(',');
+                    }
+                    first = false;
+                    write_value(item);
+                }
+                write(']');
+                break;
+            }
+            case JsonValueType::Object:
+            {
+                write('{');
+                bool first = true;
+                for (const auto& pair : value.GetObjectW())
+                {
+                    if (!first)
+                    {
+                        write(',');
+                    }
+                    first = false;
+                    write_string(pair.Key());
+                    write(':');
+                    write_value(pair.Value());
+                }
+                write('}');
+                break;
+            }
+            }
+        }
+
+        void flush()
+        {
+            stream.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+
+    private:
+        static constexpr size_t capacity = 64 * 1024;
+
+        std::ostream& stream;
+        std::string buffer;
+
+        void flush_if_full()
+        {
+            if (buffer.size() >= capacity)
+            {
+                flush();
+            }
+        }
+
+        void write_escaped(wchar_t unit)
+        {
+            constexpr char hex[] = "0123456789abcdef";
+            const char escaped[] = { '\\', 'u', '0', '0', hex[(unit >> 12) & 0xF], hex[(unit >> 8) & 0xF], hex[(unit >> 4) & 0xF], hex[unit & 0xF] };
+            buffer.append(escaped, sizeof(escaped));
+        }
+
+        // Formats numbers like Stringify does, which follows JavaScript: plain digits from 1e-6
+        // up to 1e21, so integers such as timestamps are never written in exponent form
+        void write_number(double number)
+        {
+            // JSON has no representation for them
+            if (!std::isfinite(number))
+            {
+                write("null");
+                return;
+            }
+            if (number == 0)
+            {
+                write('0');
+                return;
+            }
+
+            // The shortest digits that read back as the same number, as d.ddde+XX
+            char scientific[32];
+            const auto end_of_scientific = std::to_chars(scientific, scientific + sizeof(scientific), number, std::chars_format::scientific).ptr;
+            const std::string_view text{ scientific, static_cast<size_t>(end_of_scientific - scientific) };
+
+            const bool negative = text.front() == '-';
+            const size_t exponent_position = text.find('e');
+            std::string digits;
+            for (const char c : text.substr(negative ? 1 : 0, exponent_position - (negative ? 1 : 0)))
+            {
+                if (c != '.')
+                {
+                    digits.push_back(c);
+                }
+            }
+            int exponent = 0;
+            const auto exponent_text = text.substr(exponent_position + 1);
+            std::from_chars(exponent_text.data() + (exponent_text.front() == '+' ? 1 : 0), exponent_text.data() + exponent_text.size(), exponent);
+
+            // The decimal point goes after this many digits
+            const int point = exponent + 1;
+            const int digit_count = static_cast<int>(digits.size());
+            if (negative)
+            {
+                write('-');
+            }
+            if (digit_count <= point && point <= 21)
+            {
+                write(digits);
+                write(std::string(point - digit_count, '0'));
+            }
+            else if (0 < point && point <= 21)
+            {
+                write(std::string_view{ digits }.substr(0, point));
+                write('.');
+                write(std::string_view{ digits }.substr(point));
+            }
+            else if (-6 < point && point <= 0)
+            {
+                write("0.");
+                write(std::string(-point, '0'));
+                write(digits);
+            }
+            else
+            {
+                write(digits[0]);
+                if (digit_count > 1)
+                {
+                    write('.');
+                    write(std::string_view{ digits }.substr(1));
+                }
+                write(exponent < 0 ? "e-" : "e+");
+                write(std::to_string(exponent < 0 ? -exponent : exponent));
+            }
+        }
+
+        void write_string(std::wstring_view text)
+        {
+            buffer.push_back('"');
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                const wchar_t unit = text[i];
+                if (unit == L'"' || unit == L'\\')
+                {
+                    buffer.push_back('\\');
+                    buffer.push_back(static_cast<char>(unit));
+                }
+                else if (unit < 0x20)
+                {
+                    switch (unit)
+                    {
+                    case L'\b':
+                        buffer.append("\\b");
+                        break;
+                    case L'\f':
+                        buffer.append("\\f");
+                        break;
+                    case L'\n':
+                        buffer.append("\\n");
+                        break;
+                    case L'\r':
+                        buffer.append("\\r");
+                        break;
+                    case L'\t':
+                        buffer.append("\\t");
+                        break;
+                    default:
+                        write_escaped(unit);
+                        break;
+                    }
+                }
+                else if (unit < 0x80)
+                {
+                    buffer.push_back(static_cast<char>(unit));
+                }
+                else if (unit < 0x800)
+                {
+                    buffer.push_back(static_cast<char>(0xC0 | (unit >> 6)));
+                    buffer.push_back(static_cast<char>(0x80 | (unit & 0x3F)));
+                }
+                else if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF)
+                {
+                    const char32_t code_point = 0x10000 + ((static_cast<char32_t>(unit) - 0xD800) << 10) + (static_cast<char32_t>(text[++i]) - 0xDC00);
+                    buffer.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                    buffer.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                    buffer.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    buffer.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+                else if (unit >= 0xD800 && unit <= 0xDFFF)
+                {
+                    // Unpaired surrogates have no UTF-8 encoding, keep them escaped
+                    write_escaped(unit);
+                }
+                else
+                {
+                    buffer.push_back(static_cast<char>(0xE0 | (unit >> 12)));
+                    buffer.push_back(static_cast<char>(0x80 | ((unit >> 6) & 0x3F)));
+                    buffer.push_back(static_cast<char>(0x80 | (unit & 0x3F)));
+                }
+
+                // Long strings are flushed as they are written
+                if (buffer.size() >= capacity)
+                {
+                    flush();
+                }
+            }
+            buffer.push_back('"');
+            flush_if_full();
+        }
+    };
+}
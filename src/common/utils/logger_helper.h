@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
 #include <common/version/version.h>
 #include <common/SettingsAPI/settings_helpers.h>
 
@@ -81,7 +82,7 @@ namespace LoggerHelpers
         return result;
     }
 
-    inline void init_logger(std::wstring moduleName, std::wstring internalPath, std::string loggerName)
+    inline void init_logger(std::wstring moduleName, std::wstring internalPath, std::string loggerName, std::optional<Logger::AsyncOptions> asyncOptions = std::nullopt)
     {
         std::filesystem::path rootFolder(PTSettingsHelper::get_module_save_folder_location(moduleName));
         rootFolder.append(internalPath);
@@ -92,7 +93,7 @@ namespace LoggerHelpers
 
         auto logsPath = currentFolder;
         logsPath.append(L"log.log");
-        Logger::init(loggerName, logsPath.wstring(), PTSettingsHelper::get_log_settings_file_location());
+        Logger::init(loggerName, logsPath.wstring(), PTSettingsHelper::get_log_settings_file_location(), asyncOptions);
 
         delete_other_versions_log_folders(rootFolder.wstring(), currentFolder); 
     }
@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "TestBitmaps.h"
+
+#include <EdgeDetection.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace MeasureToolCoreUnitTests
+{
+    TEST_CLASS (EdgeDetectionTests)
+    {
+        static void AssertSameEdgesEverywhere(const TestBitmap& bitmap, const bool perChannel, const uint8_t tolerance)
+        {
+            const auto view = bitmap.View();
+            for (long y = 0; y < static_cast<long>(bitmap.height); ++y)
+            {
+                for (long x = 0; x < static_cast<long>(bitmap.width); ++x)
+                {
+                    const RECT expected = ReferenceDetectEdges(view, { x, y }, perChannel, tolerance);
+                    const RECT actual = DetectEdges(view, { x, y }, perChannel, tolerance);
+                    if (!EqualRect(&expected, &actual))
+                    {
+                        Assert::Fail(std::format(L"{}x{} at ({}, {}), per channel {}, tolerance {}: expected {}, got {}",
+                                                 bitmap.width,
+                                                 bitmap.height,
+                                                 x,
+                                                 y,
+                                                 perChannel,
+                                                 tolerance,
+                                                 ToString(expected),
+                                                 ToString(actual))
+                                         .c_str());
+                    }
+                }
+            }
+        }
+
+    public:
+        TEST_METHOD (MatchesScalarScanOnScreenLikeBitmap)
+        {
+            // Odd sizes leave partial blocks at both ends of every scan
+            const auto bitmap = MakeScreenBitmap(203, 117);
+            constexpr uint8_t tolerances[] = { 0, 1, 2, 15, 30, 255 };
+            for (const bool perChannel : { false, true })
+            {
+                for (const uint8_t tolerance : tolerances)
+                {
+                    AssertSameEdgesEverywhere(bitmap, perChannel, tolerance);
+                }
+            }
+        }
+
+        TEST_METHOD (MatchesScalarScanWithRowPadding)
+        {
+            const auto bitmap = MakeScreenBitmap(64, 48, 13, 7);
+            for (const bool perChannel : { false, true })
+            {
+                AssertSameEdgesEverywhere(bitmap, perChannel, 15);
+            }
+        }
+
+        TEST_METHOD (MatchesScalarScanOnTinyBitmaps)
+        {
+            for (size_t size = 3; size <= 10; ++size)
+            {
+                const auto bitmap = MakeScreenBitmap(size, 13 - size, 0, static_cast<uint32_t>(size));
+                AssertSameEdgesEverywhere(bitmap, false, 15);
+                AssertSameEdgesEverywhere(bitmap, true, 15);
+            }
+        }
+
+        TEST_METHOD (SummedToleranceKeepsLowByte)
+        {
+            // The summed channel distance is 3 * 0x60 = 0x120, which PixelsClose truncates to 0x20
+            TestBitmap bitmap;
+            bitmap.width = bitmap.pitch = 16;
+            bitmap.height = 3;
+            bitmap.pixels.assign(bitmap.pitch * bitmap.height, 0xFF000000);
+            bitmap.Fill(10, 0, 16, 3, 0xFF606060);
+
+            const auto view = bitmap.View();
+            constexpr uint8_t tolerances[] = { 0x1F, 0x20 };
+            for (const uint8_t tolerance : tolerances)
+            {
+                const RECT expected = ReferenceDetectEdges(view, { 2, 1 }, false, tolerance);
+                const RECT actual = DetectEdges(view, { 2, 1 }, false, tolerance);
+                Assert::AreEqual(ToString(expected), ToString(actual));
+            }
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(ScanCostVectorVsScalar)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (ScanCostVectorVsScalar)
+        {
+            const auto bitmap = MakeScreenBitmap(3840, 2160);
+            const auto view = bitmap.View();
+
+            std::mt19937 random{ 42 };
+            std::vector<POINT> points(20000);
+            for (auto& point : points)
+            {
+                point = { static_cast<long>(random() % bitmap.width), static_cast<long>(random() % bitmap.height) };
+            }
+
+            long scalarSum = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const auto& point : points)
+            {
+                const RECT rect = ReferenceDetectEdges(view, point, false, 15);
+                scalarSum += rect.right - rect.left + rect.bottom - rect.top;
+            }
+            const auto scalarCost = std::chrono::high_resolution_clock::now() - start;
+
+            long vectorSum = 0;
+            start = std::chrono::high_resolution_clock::now();
+            for (const auto& point : points)
+            {
+                const RECT rect = DetectEdges(view, point, false, 15);
+                vectorSum += rect.right - rect.left + rect.bottom - rect.top;
+            }
+            const auto vectorCost = std::chrono::high_resolution_clock::now() - start;
+
+            using std::chrono::duration_cast;
+            using std::chrono::microseconds;
+            Microsoft::VisualStudio::CppUnitTestFramework::Logger::WriteMessage(
+                std::format(L"{} edge searches on a 4K frame: {} us scalar, {} us vectorized\n",
+                            points.size(),
+                            duration_cast<microseconds>(scalarCost).count(),
+                            duration_cast<microseconds>(vectorCost).count())
+                    .c_str());
+
+            Assert::AreEqual(scalarSum, vectorSum);
+        }
+    };
+}
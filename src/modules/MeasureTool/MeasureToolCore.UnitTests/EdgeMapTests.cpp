@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "TestBitmaps.h"
+
+#include <EdgeDetection.h>
+#include <EdgeMap.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace MeasureToolCoreUnitTests
+{
+    TEST_CLASS (EdgeMapTests)
+    {
+        static void AssertSameEdgesEverywhere(EdgeMap& edgeMap, const TestBitmap& bitmap, const bool perChannel, const uint8_t tolerance)
+        {
+            const auto view = bitmap.View();
+            for (long y = 0; y < static_cast<long>(bitmap.height); ++y)
+            {
+                for (long x = 0; x < static_cast<long>(bitmap.width); ++x)
+                {
+                    const RECT expected = ReferenceDetectEdges(view, { x, y }, perChannel, tolerance);
+                    const auto actual = edgeMap.DetectEdges({ x, y }, perChannel, tolerance);
+                    if (!actual || !EqualRect(&expected, &*actual))
+                    {
+                        Assert::Fail(std::format(L"{}x{} at ({}, {}), per channel {}, tolerance {}: expected {}, got {}",
+                                                 bitmap.width,
+                                                 bitmap.height,
+                                                 x,
+                                                 y,
+                                                 perChannel,
+                                                 tolerance,
+                                                 ToString(expected),
+                                                 actual ? ToString(*actual) : L"nothing")
+                                         .c_str());
+                    }
+                }
+            }
+        }
+
+    public:
+        TEST_METHOD (NothingBeforeFirstFrame)
+        {
+            EdgeMap edgeMap;
+            Assert::IsFalse(edgeMap.DetectEdges({ 1, 1 }, false, 15).has_value());
+        }
+
+        TEST_METHOD (MatchesScalarScanOnScreenLikeBitmap)
+        {
+            const auto bitmap = MakeScreenBitmap(203, 117, 5);
+            EdgeMap edgeMap;
+            Assert::IsTrue(edgeMap.Update(bitmap.View()));
+
+            // Changing the settings rebuilds the runs from the same frame
+            constexpr uint8_t tolerances[] = { 0, 2, 15, 255 };
+            for (const bool perChannel : { false, true })
+            {
+                for (const uint8_t tolerance : tolerances)
+                {
+                    AssertSameEdgesEverywhere(edgeMap, bitmap, perChannel, tolerance);
+                }
+            }
+        }
+
+        TEST_METHOD (MatchesScalarScanOnNoise)
+        {
+            // Every pixel differs from its neighbours, so no line keeps its runs
+            TestBitmap bitmap;
+            bitmap.width = bitmap.pitch = 97;
+            bitmap.height = 61;
+            std::mt19937 random{ 3 };
+            for (size_t i = 0; i < bitmap.width * bitmap.height; ++i)
+            {
+                bitmap.pixels.push_back(0xFF000000 | static_cast<uint32_t>(random() & 0x00FFFFFF));
+            }
+
+            EdgeMap edgeMap;
+            edgeMap.Update(bitmap.View());
+            AssertSameEdgesEverywhere(edgeMap, bitmap, false, 0);
+            AssertSameEdgesEverywhere(edgeMap, bitmap, true, 30);
+        }
+
+        TEST_METHOD (MatchesScalarScanOnGradient)
+        {
+            // Every run is within the tolerance of its neighbours, which exhausts the scan budget
+            TestBitmap bitmap;
+            bitmap.width = bitmap.pitch = 300;
+            bitmap.height = 20;
+            for (size_t y = 0; y < bitmap.height; ++y)
+            {
+                for (size_t x = 0; x < bitmap.width; ++x)
+                {
+                    const uint32_t level = static_cast<uint32_t>(x / 2 % 256);
+                    bitmap.pixels.push_back(0xFF000000 | level << 16 | level << 8 | level);
+                }
+            }
+
+            EdgeMap edgeMap;
+            edgeMap.Update(bitmap.View());
+            AssertSameEdgesEverywhere(edgeMap, bitmap, false, 30);
+            AssertSameEdgesEverywhere(edgeMap, bitmap, true, 1);
+        }
+
+        TEST_METHOD (UpdateDetectsChangedContent)
+        {
+            auto bitmap = MakeScreenBitmap(64, 48);
+            EdgeMap edgeMap;
+            Assert::IsTrue(edgeMap.Update(bitmap.View()));
+            Assert::IsFalse(edgeMap.Update(bitmap.View()));
+            AssertSameEdgesEverywhere(edgeMap, bitmap, false, 15);
+
+            bitmap.Fill(10, 10, 30, 20, 0xFF123456);
+            Assert::IsTrue(edgeMap.Update(bitmap.View()));
+            AssertSameEdgesEverywhere(edgeMap, bitmap, false, 15);
+        }
+
+        TEST_METHOD (MatchesDetectEdgesOnTinyBitmaps)
+        {
+            for (size_t width = 3; width <= 5; ++width)
+            {
+                for (size_t height = 3; height <= 5; ++height)
+                {
+                    const auto bitmap = MakeScreenBitmap(width, height, 0, static_cast<uint32_t>(width * 5 + height));
+                    const auto view = bitmap.View();
+                    EdgeMap edgeMap;
+                    edgeMap.Update(view);
+                    for (long y = 0; y < static_cast<long>(height); ++y)
+                    {
+                        for (long x = 0; x < static_cast<long>(width); ++x)
+                        {
+                            const RECT expected = DetectEdges(view, { x, y }, false, 15);
+                            const auto actual = edgeMap.DetectEdges({ x, y }, false, 15);
+                            Assert::IsTrue(actual.has_value());
+                            Assert::AreEqual(ToString(expected), ToString(*actual));
+                        }
+                    }
+                }
+            }
+        }
+    };
+}
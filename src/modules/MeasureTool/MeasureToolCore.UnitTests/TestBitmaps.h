@@ -0,0 +1,160 @@
+#pragma once
+
+#include <BGRATextureView.h>
+
+namespace MeasureToolCoreUnitTests
+{
+    struct TestBitmap
+    {
+        std::vector<uint32_t> pixels;
+        size_t width = 0;
+        size_t height = 0;
+        size_t pitch = 0;
+
+        BGRATextureView View() const
+        {
+            BGRATextureView view;
+            view.pixels = pixels.data();
+            view.width = width;
+            view.height = height;
+            view.pitch = pitch;
+            return view;
+        }
+
+        void Fill(const size_t left, const size_t top, size_t right, const size_t bottom, const uint32_t color)
+        {
+            right = (std::min)(right, width);
+            for (size_t y = top; left < right && y < (std::min)(bottom, height); ++y)
+            {
+                std::fill(pixels.begin() + y * pitch + left, pixels.begin() + y * pitch + right, color);
+            }
+        }
+    };
+
+    // Something like a screen: solid panels, thin borders, text-like strokes, a gradient and
+    // a noisy photo-like area, so every scan finds edges at varied distances. The padding
+    // between rows is filled with a color that never matches, to catch reads past a row.
+    inline TestBitmap MakeScreenBitmap(const size_t width, const size_t height, const size_t padding = 0, const uint32_t seed = 1)
+    {
+        TestBitmap bitmap;
+        bitmap.width = width;
+        bitmap.height = height;
+        bitmap.pitch = width + padding;
+        bitmap.pixels.assign(bitmap.pitch * height, 0xFF00FF00);
+        bitmap.Fill(0, 0, width, height, 0xFFF3F3F3);
+
+        std::mt19937 random{ seed };
+        auto randomIn = [&](const size_t count) { return count == 0 ? 0 : static_cast<size_t>(random() % count); };
+
+        // Panels with 1 pixel borders, and a few nearly identical colors for the tolerance
+        for (int i = 0; i < 24; ++i)
+        {
+            const size_t left = randomIn(width), top = randomIn(height);
+            const size_t right = left + 1 + randomIn(width / 3), bottom = top + 1 + randomIn(height / 3);
+            bitmap.Fill(left, top, right, bottom, 0xFF202020 + static_cast<uint32_t>(randomIn(4)) * 0x00010101);
+            bitmap.Fill(left + 1, top + 1, right - 1, bottom - 1, 0xFF000000 | static_cast<uint32_t>(random() & 0x00FFFFFF));
+        }
+
+        // Text-like strokes
+        for (int i = 0; i < 200; ++i)
+        {
+            const size_t left = randomIn(width), top = randomIn(height);
+            const bool horizontal = i % 2 == 0;
+            bitmap.Fill(left, top, left + (horizontal ? 1 + randomIn(12) : 1), top + (horizontal ? 1 : 1 + randomIn(12)), 0xFF101010);
+        }
+
+        // A gradient, where each step is within a small tolerance of the previous one
+        for (size_t y = height / 2; y < height; ++y)
+        {
+            for (size_t x = 0; x < width / 4; ++x)
+            {
+                const uint32_t level = static_cast<uint32_t>(x % 256);
+                bitmap.pixels[y * bitmap.pitch + x] = 0xFF000000 | level << 16 | level << 8 | level;
+            }
+        }
+
+        // Photo-like noise
+        for (size_t y = 0; y < height / 3; ++y)
+        {
+            for (size_t x = width - width / 4; x < width; ++x)
+            {
+                const uint32_t base = 0x80;
+                const uint32_t noise = static_cast<uint32_t>(random() % 24);
+                bitmap.pixels[y * bitmap.pitch + x] = 0xFF000000 | (base + noise) << 16 | (base + noise / 2) << 8 | (base - noise);
+            }
+        }
+
+        return bitmap;
+    }
+
+    // FindEdge as it was before the scans were vectorized, one PixelsClose call per pixel
+    template<bool PerChannel, bool IsX, bool Increment>
+    long ReferenceFindEdge(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+    {
+        const long maxDim = static_cast<long>(IsX ? texture.width : texture.height);
+
+        long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
+        long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+
+        const uint32_t startPixel = texture.GetPixel(x, y);
+        while (true)
+        {
+            long oldX = x;
+            long oldY = y;
+            if constexpr (IsX)
+            {
+                if constexpr (Increment)
+                {
+                    if (++x == maxDim)
+                        break;
+                }
+                else
+                {
+                    if (--x == 0)
+                        break;
+                }
+            }
+            else
+            {
+                if constexpr (Increment)
+                {
+                    if (++y == maxDim)
+                        break;
+                }
+                else
+                {
+                    if (--y == 0)
+                        break;
+                }
+            }
+
+            const uint32_t nextPixel = texture.GetPixel(x, y);
+            if (!texture.PixelsClose<PerChannel>(startPixel, nextPixel, tolerance))
+            {
+                return IsX ? oldX : oldY;
+            }
+        }
+
+        return Increment ? maxDim - 1 : 0;
+    }
+
+    template<bool PerChannel>
+    RECT ReferenceDetectEdges(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+    {
+        return RECT{ .left = ReferenceFindEdge<PerChannel, true, false>(texture, centerPoint, tolerance),
+                     .top = ReferenceFindEdge<PerChannel, false, false>(texture, centerPoint, tolerance),
+                     .right = ReferenceFindEdge<PerChannel, true, true>(texture, centerPoint, tolerance),
+                     .bottom = ReferenceFindEdge<PerChannel, false, true>(texture, centerPoint, tolerance) };
+    }
+
+    inline RECT ReferenceDetectEdges(const BGRATextureView& texture, const POINT centerPoint, const bool perChannel, const uint8_t tolerance)
+    {
+        return perChannel ? ReferenceDetectEdges<true>(texture, centerPoint, tolerance) :
+                            ReferenceDetectEdges<false>(texture, centerPoint, tolerance);
+    }
+
+    inline std::wstring ToString(const RECT& rect)
+    {
+        return std::format(L"{{{}, {}, {}, {}}}", rect.left, rect.top, rect.right, rect.bottom);
+    }
+}
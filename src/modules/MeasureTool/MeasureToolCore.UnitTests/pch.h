@@ -0,0 +1,26 @@
+#pragma once
+
+#include "targetver.h"
+
+// Headers for CppUnitTest
+#pragma warning(disable : 26466)
+#include "CppUnitTest.h"
+
+// Windows headers
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <d3d11.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <format>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <winrt/base.h>
+#include <wil/resource.h>
+
+#include <common/logger/logger.h>
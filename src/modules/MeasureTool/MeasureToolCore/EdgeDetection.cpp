@@ -3,58 +3,209 @@
 #include "constants.h"
 #include "EdgeDetection.h"
 
-template<bool PerChannel,
-         bool IsX,
-         bool Increment>
-inline long FindEdge(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+#if !defined(_M_ARM64)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
 {
-    using namespace consts;
+#if !defined(_M_ARM64)
+    bool HasAvx2()
+    {
+        static const bool hasAvx2 = [] {
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
 
-    const size_t maxDim = IsX ? texture.width : texture.height;
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+                return false;
 
-    long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
-    long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+        }();
+        return hasAvx2;
+    }
 
-    const uint32_t startPixel = texture.GetPixel(x, y);
-    while (true)
+    // Vector counterparts of BGRATextureView::PixelsClose. Every 32-bit lane of the result
+    // is all ones if the pixel in that lane is NOT close to the start pixel.
+    template<bool PerChannel>
+    inline __m128i MismatchedPixels(const __m128i pixels, const __m128i startPixels, const uint8_t tolerance)
     {
-        long oldX = x;
-        long oldY = y;
-        if constexpr (IsX)
+        const __m128i distances = distance_epu8(pixels, startPixels);
+        if constexpr (PerChannel)
         {
-            if constexpr (Increment)
-            {
-                if (++x == maxDim)
-                    break;
-            }
-            else
-            {
-                if (--x == 0)
-                    break;
-            }
+            const __m128i exceeding = _mm_subs_epu8(distances, _mm_set1_epi8(static_cast<char>(tolerance)));
+            return _mm_xor_si128(_mm_cmpeq_epi32(exceeding, _mm_setzero_si128()), _mm_set1_epi32(-1));
         }
         else
         {
-            if constexpr (Increment)
-            {
-                if (++y == maxDim)
-                    break;
-            }
-            else
+            // Sum the channel distances of each pixel, keeping only the low byte like PixelsClose does
+            const __m128i byteMask = _mm_set1_epi32(0x00FF00FF);
+            const __m128i pairs = _mm_add_epi16(_mm_and_si128(distances, byteMask),
+                                                _mm_and_si128(_mm_srli_epi16(distances, 8), byteMask));
+            const __m128i score = _mm_and_si128(_mm_add_epi32(pairs, _mm_srli_epi32(pairs, 16)), _mm_set1_epi32(0xFF));
+            return _mm_cmpgt_epi32(score, _mm_set1_epi32(tolerance));
+        }
+    }
+
+    template<bool PerChannel>
+    inline __m256i MismatchedPixels(const __m256i pixels, const __m256i startPixels, const uint8_t tolerance)
+    {
+        const __m256i distances = _mm256_or_si256(_mm256_subs_epu8(pixels, startPixels),
+                                                  _mm256_subs_epu8(startPixels, pixels));
+        if constexpr (PerChannel)
+        {
+            const __m256i exceeding = _mm256_subs_epu8(distances, _mm256_set1_epi8(static_cast<char>(tolerance)));
+            return _mm256_xor_si256(_mm256_cmpeq_epi32(exceeding, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+        }
+        else
+        {
+            const __m256i byteMask = _mm256_set1_epi32(0x00FF00FF);
+            const __m256i pairs = _mm256_add_epi16(_mm256_and_si256(distances, byteMask),
+                                                   _mm256_and_si256(_mm256_srli_epi16(distances, 8), byteMask));
+            const __m256i score = _mm256_and_si256(_mm256_add_epi32(pairs, _mm256_srli_epi32(pairs, 16)), _mm256_set1_epi32(0xFF));
+            return _mm256_cmpgt_epi32(score, _mm256_set1_epi32(tolerance));
+        }
+    }
+
+    inline unsigned long LowestBit(const unsigned mask)
+    {
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+    }
+
+    inline unsigned long HighestBit(const unsigned mask)
+    {
+        unsigned long index;
+        _BitScanReverse(&index, mask);
+        return index;
+    }
+
+    // Scans a row, which is contiguous in memory, 8 or 4 pixels at a time. When going
+    // backwards a block is loaded from its lowest address, so the first mismatch in
+    // scanning order is the highest set bit of the mask.
+    template<bool PerChannel, bool Increment>
+    size_t FindFirstMismatchInRow(const uint32_t* first, const size_t count, const uint32_t startPixel, const uint8_t tolerance)
+    {
+        size_t i = 0;
+        if (HasAvx2())
+        {
+            const __m256i start = _mm256_set1_epi32(static_cast<int>(startPixel));
+            for (; i + 8 <= count; i += 8)
             {
-                if (--y == 0)
-                    break;
+                const uint32_t* block = Increment ? first + i : first - i - 7;
+                const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+                const unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(MismatchedPixels<PerChannel>(pixels, start, tolerance)));
+                if (mask)
+                    return Increment ? i + LowestBit(mask) : i + 7 - HighestBit(mask);
             }
         }
 
-        const uint32_t nextPixel = texture.GetPixel(x, y);
-        if (!texture.PixelsClose<PerChannel>(startPixel, nextPixel, tolerance))
+        const __m128i start = _mm_set1_epi32(static_cast<int>(startPixel));
+        for (; i + 4 <= count; i += 4)
+        {
+            const uint32_t* block = Increment ? first + i : first - i - 3;
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+            const unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(MismatchedPixels<PerChannel>(pixels, start, tolerance)));
+            if (mask)
+                return Increment ? i + LowestBit(mask) : i + 3 - HighestBit(mask);
+        }
+
+        for (; i < count; ++i)
+        {
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, Increment ? first[i] : *(first - i), tolerance))
+                return i;
+        }
+        return count;
+    }
+
+    // Scans a column. Each pixel is on a different cache line anyway, so the pixels of
+    // 4 consecutive rows are loaded into a register and compared at once.
+    template<bool PerChannel>
+    size_t FindFirstMismatchInColumn(const uint32_t* first, const ptrdiff_t step, const size_t count, const uint32_t startPixel, const uint8_t tolerance)
+    {
+        const __m128i start = _mm_set1_epi32(static_cast<int>(startPixel));
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const uint32_t* block = first + static_cast<ptrdiff_t>(i) * step;
+            const __m128i pixels = _mm_set_epi32(static_cast<int>(block[3 * step]),
+                                                 static_cast<int>(block[2 * step]),
+                                                 static_cast<int>(block[step]),
+                                                 static_cast<int>(block[0]));
+            const unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(MismatchedPixels<PerChannel>(pixels, start, tolerance)));
+            if (mask)
+                return i + LowestBit(mask);
+        }
+
+        for (; i < count; ++i)
         {
-            return IsX ? oldX : oldY;
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, first[static_cast<ptrdiff_t>(i) * step], tolerance))
+                return i;
         }
+        return count;
+    }
+#endif
+
+    // Returns how many pixels starting from first, advancing by step, are close to the
+    // start pixel before the first one that isn't
+    template<bool PerChannel, bool IsX, bool Increment>
+    size_t FindFirstMismatch(const uint32_t* first, const ptrdiff_t step, const size_t count, const uint32_t startPixel, const uint8_t tolerance)
+    {
+#if !defined(_M_ARM64)
+        if constexpr (IsX)
+            return FindFirstMismatchInRow<PerChannel, Increment>(first, count, startPixel, tolerance);
+        else
+            return FindFirstMismatchInColumn<PerChannel>(first, step, count, startPixel, tolerance);
+#else
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, first[static_cast<ptrdiff_t>(i) * step], tolerance))
+                return i;
+        }
+        return count;
+#endif
+    }
+}
+
+template<bool PerChannel,
+         bool IsX,
+         bool Increment>
+inline long FindEdge(const BGRATextureView& texture, const POINT centerPoint, const uint8_t tolerance)
+{
+    using namespace consts;
+
+    const long maxDim = static_cast<long>(IsX ? texture.width : texture.height);
+
+    long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
+    long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+
+    const uint32_t startPixel = texture.GetPixel(x, y);
+    const long position = IsX ? x : y;
+
+    // Scanning forward includes the last pixel, scanning backward stops before the first one
+    const long count = Increment ? maxDim - 1 - position : position - 1;
+    if (count <= 0)
+    {
+        return Increment ? maxDim - 1 : 0;
     }
 
-    return Increment ? static_cast<long>(IsX ? texture.width : texture.height) - 1 : 0;
+    const ptrdiff_t step = (IsX ? 1 : static_cast<ptrdiff_t>(texture.pitch)) * (Increment ? 1 : -1);
+    const uint32_t* first = texture.pixels + x + texture.pitch * y + step;
+    const size_t similar = FindFirstMismatch<PerChannel, IsX, Increment>(first, step, static_cast<size_t>(count), startPixel, tolerance);
+    if (similar == static_cast<size_t>(count))
+    {
+        return Increment ? maxDim - 1 : 0;
+    }
+
+    // The edge is the last pixel that is still similar
+    return Increment ? position + static_cast<long>(similar) : position - static_cast<long>(similar);
 }
 
 template<bool PerChannel>
@@ -85,3 +236,27 @@ RECT DetectEdges(const BGRATextureView& texture,
 
     return function(texture, centerPoint, tolerance);
 }
+
+size_t CountSimilarPixels(const uint32_t* first,
+                          const ptrdiff_t step,
+                          const size_t count,
+                          const uint32_t startPixel,
+                          const bool perChannel,
+                          const uint8_t tolerance)
+{
+    if (step == 1)
+    {
+        return perChannel ? FindFirstMismatch<true, true, true>(first, step, count, startPixel, tolerance) :
+                            FindFirstMismatch<false, true, true>(first, step, count, startPixel, tolerance);
+    }
+    else if (step == -1)
+    {
+        return perChannel ? FindFirstMismatch<true, true, false>(first, step, count, startPixel, tolerance) :
+                            FindFirstMismatch<false, true, false>(first, step, count, startPixel, tolerance);
+    }
+    else
+    {
+        return perChannel ? FindFirstMismatch<true, false, true>(first, step, count, startPixel, tolerance) :
+                            FindFirstMismatch<false, false, true>(first, step, count, startPixel, tolerance);
+    }
+}
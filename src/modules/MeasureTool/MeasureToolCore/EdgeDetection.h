@@ -5,4 +5,13 @@
 RECT DetectEdges(const BGRATextureView& texture,
                  const POINT centerPoint,
                  const bool perChannel,
-                 const uint8_t tolerance);
\ No newline at end of file
+                 const uint8_t tolerance);;
+
+// Returns how many pixels, starting from first and advancing by step, are close to the
+// start pixel before the first one that isn't
+size_t CountSimilarPixels(const uint32_t* first,
+                          const ptrdiff_t step,
+                          const size_t count,
+                          const uint32_t startPixel,
+                          const bool perChannel,
+                          const uint8_t tolerance);
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "pch.h"
+
+#include "EdgeDetection.h"
+#include "EdgeMap.h"
+
+#include <atomic>
+
+namespace
+{
+    constexpr size_t TRANSPOSE_TILE_SIZE = 32;
+    constexpr size_t LINES_PER_TASK = 16;
+
+    // A line keeps at most one run per this many pixels, which bounds the runs of a 4K frame
+    // to about 25 MB. Noisier lines are scanned when queried, like DetectEdges does.
+    constexpr long PIXELS_PER_RUN = 8;
+
+    // Finding the edges of a line's runs may scan at most this many times its length. Runs
+    // close to each other within the tolerance would otherwise rescan the same pixels.
+    constexpr size_t SCANS_PER_PIXEL = 16;
+
+    template<typename Fn>
+    struct ParallelLines
+    {
+        Fn& fn;
+        size_t count;
+        size_t tasks;
+        std::atomic_size_t nextTask = 0;
+
+        void Run()
+        {
+            for (size_t task = nextTask++; task < tasks; task = nextTask++)
+            {
+                for (size_t line = task * LINES_PER_TASK; line < (std::min)(count, (task + 1) * LINES_PER_TASK); ++line)
+                {
+                    fn(line);
+                }
+            }
+        }
+
+        static void CALLBACK Callback(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WORK)
+        {
+            static_cast<ParallelLines*>(context)->Run();
+        }
+    };
+
+    // Runs fn(line) for every line in [0, count) on this thread and the process thread pool,
+    // whose threads stay around between frames
+    template<typename Fn>
+    void ParallelForEachLine(const size_t count, Fn fn)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        ParallelLines<Fn> lines{ .fn = fn, .count = count, .tasks = (count + LINES_PER_TASK - 1) / LINES_PER_TASK };
+        const size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, lines.tasks);
+
+        PTP_WORK work = workerCount > 1 ? CreateThreadpoolWork(&ParallelLines<Fn>::Callback, &lines, nullptr) : nullptr;
+        if (work)
+        {
+            for (size_t i = 1; i < workerCount; ++i)
+            {
+                SubmitThreadpoolWork(work);
+            }
+        }
+
+        lines.Run();
+
+        if (work)
+        {
+            WaitForThreadpoolWorkCallbacks(work, FALSE);
+            CloseThreadpoolWork(work);
+        }
+    }
+
+    uint64_t HashRow(const uint32_t* row, const size_t width)
+    {
+        // FNV-1a over 32-bit words, in independent lanes so the multiplications can overlap
+        constexpr uint64_t OFFSET_BASIS = 14695981039346656037ull;
+        constexpr uint64_t PRIME = 1099511628211ull;
+        uint64_t lanes[4] = { OFFSET_BASIS, OFFSET_BASIS + 1, OFFSET_BASIS + 2, OFFSET_BASIS + 3 };
+        size_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                lanes[lane] = (lanes[lane] ^ row[x + lane]) * PRIME;
+            }
+        }
+        for (; x < width; ++x)
+        {
+            lanes[0] = (lanes[0] ^ row[x]) * PRIME;
+        }
+        return ((lanes[0] * PRIME ^ lanes[1]) * PRIME ^ lanes[2]) * PRIME ^ lanes[3];
+    }
+
+    uint64_t HashContent(const BGRATextureView& texture)
+    {
+        std::vector<uint64_t> rowHashes(texture.height);
+        ParallelForEachLine(texture.height, [&](const size_t y) {
+            rowHashes[y] = HashRow(texture.pixels + y * texture.pitch, texture.width);
+        });
+
+        uint64_t hash = static_cast<uint64_t>(texture.width) << 32 | texture.height;
+        for (const uint64_t rowHash : rowHashes)
+        {
+            hash = (hash ^ rowHash) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    struct LineEdges
+    {
+        long low;
+        long high;
+        // Pixels compared to find them
+        size_t scanned;
+    };
+
+    // The edges FindEdge finds from any pixel of [start, end], which all have the same color
+    LineEdges FindLineEdges(const uint32_t* line, const long length, const long start, const long end, const bool perChannel, const uint8_t tolerance)
+    {
+        const uint32_t pixel = line[start];
+
+        // Scanning forward includes the last pixel, scanning backward stops before the first one
+        const size_t highCount = static_cast<size_t>(length - 1 - end);
+        const size_t highSimilar = CountSimilarPixels(line + end + 1, 1, highCount, pixel, perChannel, tolerance);
+        const size_t lowCount = static_cast<size_t>(start - 1);
+        const size_t lowSimilar = CountSimilarPixels(line + start - 1, -1, lowCount, pixel, perChannel, tolerance);
+
+        return LineEdges{ .low = lowSimilar == lowCount ? 0 : start - static_cast<long>(lowSimilar),
+                          .high = highSimilar == highCount ? length - 1 : end + static_cast<long>(highSimilar),
+                          .scanned = highSimilar + lowSimilar + 2 };
+    }
+
+    // Computes the edges FindEdge would find from every pixel of a line, except the first
+    // and the last one, which are never used as a starting point. Leaves runs empty if the
+    // line has too many runs or takes too much scanning, then its edges are found per query.
+    template<typename Run>
+    void BuildLineRuns(const uint32_t* line, const long length, const bool perChannel, const uint8_t tolerance, std::vector<Run>& runs)
+    {
+        runs.clear();
+
+        // Counting the runs first rejects noise before any edge is searched
+        size_t runCount = 1;
+        for (long i = 2; i <= length - 2; ++i)
+        {
+            runCount += line[i] != line[i - 1];
+        }
+
+        const size_t maxRuns = static_cast<size_t>((length + PIXELS_PER_RUN - 1) / PIXELS_PER_RUN);
+        if (runCount > maxRuns)
+        {
+            runs.shrink_to_fit();
+            return;
+        }
+        if (runs.capacity() > maxRuns)
+        {
+            runs.shrink_to_fit();
+        }
+        runs.reserve(runCount);
+
+        size_t scanned = 0;
+        for (long start = 1; start <= length - 2;)
+        {
+            long end = start;
+            while (end + 1 <= length - 2 && line[end + 1] == line[start])
+            {
+                ++end;
+            }
+
+            const LineEdges edges = FindLineEdges(line, length, start, end, perChannel, tolerance);
+            scanned += edges.scanned;
+            if (scanned > SCANS_PER_PIXEL * static_cast<size_t>(length))
+            {
+                runs.clear();
+                runs.shrink_to_fit();
+                return;
+            }
+
+            runs.push_back(Run{ .start = start, .lowEdge = edges.low, .highEdge = edges.high });
+            start = end + 1;
+        }
+    }
+
+    template<typename Run>
+    const Run& FindRun(const std::vector<Run>& runs, const long position)
+    {
+        auto it = std::upper_bound(runs.begin(), runs.end(), position, [](const long position, const Run& run) {
+            return position < run.start;
+        });
+        return *std::prev(it);
+    }
+}
+
+bool EdgeMap::Update(const BGRATextureView& texture)
+{
+    const uint64_t newHash = HashContent(texture);
+
+    std::lock_guard lock{ mutex };
+    if (newHash == contentHash && texture.width == width && texture.height == height)
+    {
+        return false;
+    }
+
+    width = texture.width;
+    height = texture.height;
+    contentHash = newHash;
+    pixels.resize(width * height);
+    for (size_t y = 0; y < height; ++y)
+    {
+        std::copy_n(texture.pixels + y * texture.pitch, width, pixels.data() + y * width);
+    }
+
+    tablesValid = false;
+    return true;
+}
+
+std::optional<RECT> EdgeMap::DetectEdges(const POINT centerPoint, const bool perChannel, const uint8_t tolerance)
+{
+    std::lock_guard lock{ mutex };
+    if (pixels.empty())
+    {
+        return std::nullopt;
+    }
+
+    // Too small to have a pixel that isn't on the border, leave it to the regular search
+    if (width < 3 || height < 3)
+    {
+        BGRATextureView view;
+        view.pixels = pixels.data();
+        view.pitch = view.width = width;
+        view.height = height;
+        return ::DetectEdges(view, centerPoint, perChannel, tolerance);
+    }
+
+    if (!tablesValid || tablesPerChannel != perChannel || tablesTolerance != tolerance)
+    {
+        BuildTables(perChannel, tolerance);
+    }
+
+    // Must match the clamping done by DetectEdges
+    const long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(width - 2));
+    const long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(height - 2));
+    auto edgesAt = [&](const std::vector<Run>& runs, const uint32_t* line, const long length, const long position) {
+        if (runs.empty())
+        {
+            const LineEdges edges = FindLineEdges(line, length, position, position, perChannel, tolerance);
+            return std::pair{ edges.low, edges.high };
+        }
+        const Run& run = FindRun(runs, position);
+        return std::pair{ run.lowEdge, run.highEdge };
+    };
+    const auto [left, right] = edgesAt(rowRuns[y], pixels.data() + y * width, static_cast<long>(width), x);
+    const auto [top, bottom] = edgesAt(columnRuns[x], transposedPixels.data() + x * height, static_cast<long>(height), y);
+
+    return RECT{ .left = left,
+                 .top = top,
+                 .right = right,
+                 .bottom = bottom };
+}
+
+void EdgeMap::BuildTables(const bool perChannel, const uint8_t tolerance)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // Columns are scanned as rows of the transposed frame, which keeps the scans sequential
+    transposedPixels.resize(width * height);
+    const size_t tileRows = (height + TRANSPOSE_TILE_SIZE - 1) / TRANSPOSE_TILE_SIZE;
+    ParallelForEachLine(tileRows, [&](const size_t tileRow) {
+        const size_t y0 = tileRow * TRANSPOSE_TILE_SIZE;
+        const size_t y1 = (std::min)(height, y0 + TRANSPOSE_TILE_SIZE);
+        for (size_t x0 = 0; x0 < width; x0 += TRANSPOSE_TILE_SIZE)
+        {
+            const size_t x1 = (std::min)(width, x0 + TRANSPOSE_TILE_SIZE);
+            for (size_t y = y0; y < y1; ++y)
+            {
+                for (size_t x = x0; x < x1; ++x)
+                {
+                    transposedPixels[x * height + y] = pixels[y * width + x];
+                }
+            }
+        }
+    });
+
+    rowRuns.resize(height);
+    columnRuns.resize(width);
+    ParallelForEachLine(height + width, [&](const size_t line) {
+        if (line < height)
+        {
+            BuildLineRuns(pixels.data() + line * width, static_cast<long>(width), perChannel, tolerance, rowRuns[line]);
+        }
+        else
+        {
+            const size_t x = line - height;
+            BuildLineRuns(transposedPixels.data() + x * height, static_cast<long>(height), perChannel, tolerance, columnRuns[x]);
+        }
+    });
+
+    tablesValid = true;
+    tablesPerChannel = perChannel;
+    tablesTolerance = tolerance;
+
+    Logger::trace(L"Built edge map for {}x{} frame in {} ms",
+                  width,
+                  height,
+                  std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count());
+}
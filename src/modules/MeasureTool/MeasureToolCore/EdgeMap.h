@@ -0,0 +1,47 @@
+#pragma once
+
+#include "BGRATextureView.h"
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// Answers DetectEdges queries for any cursor position from a copy of the last captured
+// frame. Rows and columns are split into runs of identical pixels, which share their
+// edges, so the runs' edges are computed once per frame and tolerance and every query
+// is a lookup. Frames whose content didn't change keep the previously built tables.
+class EdgeMap
+{
+public:
+    // Returns false if the frame has the same content as the previous one
+    bool Update(const BGRATextureView& texture);
+
+    // Returns nothing until a frame has been seen
+    std::optional<RECT> DetectEdges(const POINT centerPoint, const bool perChannel, const uint8_t tolerance);
+
+private:
+    // Pixels from start up to the start of the next run have the same edges
+    struct Run
+    {
+        long start;
+        long lowEdge;
+        long highEdge;
+    };
+
+    std::mutex mutex;
+
+    std::vector<uint32_t> pixels;
+    std::vector<uint32_t> transposedPixels;
+    size_t width = 0;
+    size_t height = 0;
+    uint64_t contentHash = 0;
+
+    bool tablesValid = false;
+    bool tablesPerChannel = false;
+    uint8_t tablesTolerance = 0;
+    // Empty for the lines whose edges are found when queried
+    std::vector<std::vector<Run>> rowRuns;
+    std::vector<std::vector<Run>> columnRuns;
+
+    void BuildTables(const bool perChannel, const uint8_t tolerance);
+};
@@ -137,6 +137,7 @@ namespace winrt::PowerToys::MeasureToolCore::implementation
             state.global.drawFeetOnCross = _settings.drawFeetOnCross;
             state.global.pixelTolerance = _settings.pixelTolerance;
             state.global.perColorChannelEdgeDetection = _settings.perColorChannelEdgeDetection;
+            state.global.precomputeEdges = _settings.precomputeEdges;
         });
 
 #if defined(DEBUG_PRIMARY_MONITOR_ONLY)
@@ -4,10 +4,13 @@
 #include "constants.h"
 #include "CoordinateSystemConversion.h"
 #include "EdgeDetection.h"
+#include "EdgeMap.h"
 #include "ScreenCapturing.h"
 
 #include <common/Display/monitors.h>
 
+#include <array>
+
 //#define DEBUG_EDGES
 
 namespace
@@ -27,6 +30,21 @@ namespace
 
         return item;
     }
+
+    // Staging textures reused for continuous capturing. More than one lets the GPU
+    // copy into a texture while the previous one may still be in use.
+    constexpr size_t STAGING_RING_SIZE = 3;
+
+    // How often continuous capturing reports its copy statistics
+    constexpr size_t CAPTURE_STATS_FRAME_INTERVAL = 1000;
+
+    struct CaptureStats
+    {
+        size_t frames = 0;
+        size_t regionFrames = 0;
+        uint64_t bytesCopied = 0;
+        std::chrono::microseconds copyTime = {};
+    };
 }
 
 class D3DCaptureState final
@@ -42,17 +60,29 @@ class D3DCaptureState final
     winrt::Direct3D11CaptureFramePool framePool = nullptr;
     winrt::GraphicsCaptureSession session = nullptr;
 
-    std::function<void(MappedTextureView)> frameCallback;
+    std::function<void(MappedTextureView, POINT)> frameCallback;
+    // The overlay window the continuously captured frames are searched in
+    HWND window = nullptr;
     Box monitorArea;
     bool continuousCapture = false;
+    bool fullFrames = false;
 
     D3DCaptureState(DxgiAPI* dxgiAPI,
                     winrt::com_ptr<IDXGISwapChain1> swapChain,
                     winrt::DirectXPixelFormat pixelFormat,
                     MonitorInfo monitorInfo,
-                    const bool continuousCapture);
+                    const bool continuousCapture,
+                    const bool fullFrames);
+
+    std::array<winrt::com_ptr<ID3D11Texture2D>, STAGING_RING_SIZE> stagingRing;
+    size_t stagingRingIndex = 0;
+    CaptureStats captureStats;
 
     winrt::com_ptr<ID3D11Texture2D> CopyFrameToCPU(const winrt::com_ptr<ID3D11Texture2D>& texture);
+    winrt::com_ptr<ID3D11Texture2D> CopyFrameToStagingRing(const winrt::com_ptr<ID3D11Texture2D>& texture);
+    winrt::com_ptr<ID3D11Texture2D> CopyFrameRegionToCPU(const winrt::com_ptr<ID3D11Texture2D>& texture, const POINT searchCenter);
+    winrt::com_ptr<ID3D11Texture2D> NextStagingTexture(const D3D11_TEXTURE2D_DESC& frameDesc);
+    void ReportCaptureStats();
 
     void OnFrameArrived(const winrt::Direct3D11CaptureFramePool& sender, const winrt::IInspectable&);
 
@@ -64,11 +94,12 @@ public:
     static std::unique_ptr<D3DCaptureState> Create(DxgiAPI* dxgiAPI,
                                                    MonitorInfo monitorInfo,
                                                    const winrt::DirectXPixelFormat pixelFormat,
-                                                   const bool continuousCapture);
+                                                   const bool continuousCapture,
+                                                   const bool fullFrames);
 
     ~D3DCaptureState();
 
-    void StartCapture(std::function<void(MappedTextureView)> _frameCallback);
+    void StartCapture(HWND _window, std::function<void(MappedTextureView, POINT)> _frameCallback);
     MappedTextureView CaptureSingleFrame();
 
     void StopCapture();
@@ -78,14 +109,16 @@ D3DCaptureState::D3DCaptureState(DxgiAPI* dxgiAPI,
                                  winrt::com_ptr<IDXGISwapChain1> _swapChain,
                                  winrt::DirectXPixelFormat pixelFormat_,
                                  MonitorInfo monitorInfo,
-                                 const bool continuousCapture_) :
+                                 const bool continuousCapture_,
+                                 const bool fullFrames_) :
     dxgiAPI{ dxgiAPI },
     device{ dxgiAPI->d3dForCapture.d3dDeviceInspectable.as<winrt::IDirect3DDevice>() },
     swapChain{ std::move(_swapChain) },
     pixelFormat{ std::move(pixelFormat_) },
     monitor{ monitorInfo.GetHandle() },
     monitorArea{ monitorInfo.GetScreenSize(true) },
-    continuousCapture{ continuousCapture_ }
+    continuousCapture{ continuousCapture_ },
+    fullFrames{ fullFrames_ }
 {
 }
 
@@ -102,9 +135,93 @@ winrt::com_ptr<ID3D11Texture2D> D3DCaptureState::CopyFrameToCPU(const winrt::com
     winrt::check_hresult(dxgiAPI->d3dForCapture.d3dDevice->CreateTexture2D(&desc, nullptr, cpuTexture.put()));
     dxgiAPI->d3dForCapture.d3dContext->CopyResource(cpuTexture.get(), frameTexture.get());
 
+    captureStats.bytesCopied += static_cast<uint64_t>(desc.Width) * desc.Height * 4;
+    return cpuTexture;
+}
+
+winrt::com_ptr<ID3D11Texture2D> D3DCaptureState::NextStagingTexture(const D3D11_TEXTURE2D_DESC& frameDesc)
+{
+    auto& texture = stagingRing[stagingRingIndex];
+    stagingRingIndex = (stagingRingIndex + 1) % STAGING_RING_SIZE;
+
+    if (texture)
+    {
+        D3D11_TEXTURE2D_DESC stagingDesc = {};
+        texture->GetDesc(&stagingDesc);
+        if (stagingDesc.Width == frameDesc.Width && stagingDesc.Height == frameDesc.Height && stagingDesc.Format == frameDesc.Format)
+        {
+            return texture;
+        }
+        texture = nullptr;
+    }
+
+    D3D11_TEXTURE2D_DESC desc = frameDesc;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    desc.MiscFlags = 0;
+    desc.BindFlags = 0;
+    winrt::check_hresult(dxgiAPI->d3dForCapture.d3dDevice->CreateTexture2D(&desc, nullptr, texture.put()));
+    return texture;
+}
+
+winrt::com_ptr<ID3D11Texture2D> D3DCaptureState::CopyFrameToStagingRing(const winrt::com_ptr<ID3D11Texture2D>& frameTexture)
+{
+    D3D11_TEXTURE2D_DESC frameDesc = {};
+    frameTexture->GetDesc(&frameDesc);
+
+    auto cpuTexture = NextStagingTexture(frameDesc);
+    dxgiAPI->d3dForCapture.d3dContext->CopyResource(cpuTexture.get(), frameTexture.get());
+
+    captureStats.bytesCopied += static_cast<uint64_t>(frameDesc.Width) * frameDesc.Height * 4;
+    return cpuTexture;
+}
+
+// Edge detection only walks the row and the column going through the search center,
+// so only those are copied. The rest of the staging texture keeps stale pixels.
+winrt::com_ptr<ID3D11Texture2D> D3DCaptureState::CopyFrameRegionToCPU(const winrt::com_ptr<ID3D11Texture2D>& frameTexture,
+                                                                      const POINT searchCenter)
+{
+    D3D11_TEXTURE2D_DESC frameDesc = {};
+    frameTexture->GetDesc(&frameDesc);
+
+    // Degenerate frames are cheaper to copy whole than to special-case
+    if (frameDesc.Width < 3 || frameDesc.Height < 3)
+    {
+        return CopyFrameToCPU(frameTexture);
+    }
+
+    auto cpuTexture = NextStagingTexture(frameDesc);
+
+    // Must match the clamping done by DetectEdges
+    const UINT x = static_cast<UINT>(std::clamp<long>(searchCenter.x, 1, static_cast<long>(frameDesc.Width) - 2));
+    const UINT y = static_cast<UINT>(std::clamp<long>(searchCenter.y, 1, static_cast<long>(frameDesc.Height) - 2));
+
+    const D3D11_BOX row = { .left = 0, .top = y, .front = 0, .right = frameDesc.Width, .bottom = y + 1, .back = 1 };
+    const D3D11_BOX column = { .left = x, .top = 0, .front = 0, .right = x + 1, .bottom = frameDesc.Height, .back = 1 };
+    const auto& context = dxgiAPI->d3dForCapture.d3dContext;
+    context->CopySubresourceRegion(cpuTexture.get(), 0, row.left, row.top, 0, frameTexture.get(), 0, &row);
+    context->CopySubresourceRegion(cpuTexture.get(), 0, column.left, column.top, 0, frameTexture.get(), 0, &column);
+
+    captureStats.bytesCopied += (static_cast<uint64_t>(frameDesc.Width) + frameDesc.Height) * 4;
+    ++captureStats.regionFrames;
     return cpuTexture;
 }
 
+void D3DCaptureState::ReportCaptureStats()
+{
+    if (captureStats.frames == 0)
+    {
+        return;
+    }
+
+    Logger::trace(L"Captured {} frames ({} partial), {} KB per frame, {} us per frame copy",
+                  captureStats.frames,
+                  captureStats.regionFrames,
+                  captureStats.bytesCopied / captureStats.frames / 1024,
+                  captureStats.copyTime.count() / captureStats.frames);
+    captureStats = {};
+}
+
 template<typename T>
 auto GetDXGIInterfaceFromObject(winrt::IInspectable const& object)
 {
@@ -151,16 +268,32 @@ void D3DCaptureState::OnFrameArrived(const winrt::Direct3D11CaptureFramePool& se
             }
 
             winrt::check_hresult(swapChain->GetBuffer(0, winrt::guid_of<ID3D11Texture2D>(), texture.put_void()));
+            const auto copyStart = std::chrono::high_resolution_clock::now();
             auto surface = frame.Surface();
             auto gpuTexture = GetDXGIInterfaceFromObject<ID3D11Texture2D>(surface);
-            texture = CopyFrameToCPU(gpuTexture);
+
+            // A single captured frame is kept and drawn as the background, so it has to be copied whole
+            if (!continuousCapture)
+                texture = CopyFrameToCPU(gpuTexture);
+            else if (fullFrames)
+                texture = CopyFrameToStagingRing(gpuTexture);
+            // The region is around the pixel the callback searches from: the same cursor
+            // snapshot, converted to the window coordinates the same way
+            else
+                texture = CopyFrameRegionToCPU(gpuTexture, convert::FromSystemToWindow(window, cursorPos));
             surface.Close();
             MappedTextureView textureView{ texture,
                                            dxgiAPI->d3dForCapture.d3dContext,
                                            static_cast<size_t>(frameSize.Width),
                                            static_cast<size_t>(frameSize.Height) };
 
-            frameCallback(std::move(textureView));
+            captureStats.copyTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - copyStart);
+            if (++captureStats.frames == CAPTURE_STATS_FRAME_INTERVAL)
+            {
+                ReportCaptureStats();
+            }
+
+            frameCallback(std::move(textureView), cursorPos);
         }
     }
 
@@ -175,7 +308,8 @@ void D3DCaptureState::OnFrameArrived(const winrt::Direct3D11CaptureFramePool& se
 std::unique_ptr<D3DCaptureState> D3DCaptureState::Create(DxgiAPI* dxgiAPI,
                                                          MonitorInfo monitorInfo,
                                                          const winrt::DirectXPixelFormat pixelFormat,
-                                                         const bool continuousCapture)
+                                                         const bool continuousCapture,
+                                                         const bool fullFrames)
 {
     const auto dims = monitorInfo.GetScreenSize(true);
     const DXGI_SWAP_CHAIN_DESC1 desc = {
@@ -197,7 +331,7 @@ std::unique_ptr<D3DCaptureState> D3DCaptureState::Create(DxgiAPI* dxgiAPI,
                                                                                             swapChain.put()));
 
     // We must create the object in a heap, since we need to pin it in memory to receive callbacks
-    auto statePtr = std::unique_ptr<D3DCaptureState>(new D3DCaptureState{ dxgiAPI, std::move(swapChain), pixelFormat, std::move(monitorInfo), continuousCapture });
+    auto statePtr = std::unique_ptr<D3DCaptureState>(new D3DCaptureState{ dxgiAPI, std::move(swapChain), pixelFormat, std::move(monitorInfo), continuousCapture, fullFrames });
 
     return statePtr;
 }
@@ -226,8 +360,9 @@ void D3DCaptureState::StartSessionInPreferredMode()
     session.StartCapture();
 }
 
-void D3DCaptureState::StartCapture(std::function<void(MappedTextureView)> _frameCallback)
+void D3DCaptureState::StartCapture(HWND _window, std::function<void(MappedTextureView, POINT)> _frameCallback)
 {
+    window = _window;
     frameCallback = std::move(_frameCallback);
     StartSessionInPreferredMode();
 }
@@ -237,7 +372,7 @@ MappedTextureView D3DCaptureState::CaptureSingleFrame()
     std::optional<MappedTextureView> result;
     wil::shared_event frameArrivedEvent(wil::EventOptions::ManualReset);
 
-    frameCallback = [frameArrivedEvent, &result, this](MappedTextureView tex) {
+    frameCallback = [frameArrivedEvent, &result, this](MappedTextureView tex, POINT) {
         if (frameArrivedEvent.is_signaled())
             return;
 
@@ -266,16 +401,23 @@ void D3DCaptureState::StopCapture()
     {
         // RPC call might fail here
     }
+
+    ReportCaptureStats();
 }
 
+// detectEdges(cursorPos, perChannel, tolerance) returns the edges around the cursor, if they are known
+template<typename EdgeDetector>
 void UpdateCaptureState(const CommonState& commonState,
                         Serialized<MeasureToolState>& state,
                         HWND window,
-                        const MappedTextureView& textureView)
+                        const size_t frameWidth,
+                        const size_t frameHeight,
+                        const POINT cursorPosSystemSpace,
+                        EdgeDetector detectEdges)
 {
-    const auto cursorPos = convert::FromSystemToWindow(window, commonState.cursorPosSystemSpace);
-    const bool cursorInLeftScreenHalf = cursorPos.x < textureView.view.width / 2;
-    const bool cursorInTopScreenHalf = cursorPos.y < textureView.view.height / 2;
+    const auto cursorPos = convert::FromSystemToWindow(window, cursorPosSystemSpace);
+    const bool cursorInLeftScreenHalf = cursorPos.x < frameWidth / 2;
+    const bool cursorInTopScreenHalf = cursorPos.y < frameHeight / 2;
     uint8_t pixelTolerance = {};
     bool perColorChannelEdgeDetection = {};
     state.Access([&](MeasureToolState& state) {
@@ -290,10 +432,13 @@ void UpdateCaptureState(const CommonState& commonState,
     //          at 20x100, bounds should be [20,100]-[24,104]. We don't include [25,105] or
     //          [19,99], since those pixels are blue. Thus, square dims are equal to
     //          [24-20+1,104-100+1]=[5,5].
-    const RECT bounds = DetectEdges(textureView.view,
-                                    cursorPos,
-                                    perColorChannelEdgeDetection,
-                                    pixelTolerance);
+    const std::optional<RECT> detectedBounds = detectEdges(cursorPos, perColorChannelEdgeDetection, pixelTolerance);
+    if (!detectedBounds)
+    {
+        return;
+    }
+
+    const RECT bounds = *detectedBounds;
     auto px2mmRatio = commonState.GetPhysicalPx2MmRatio(window);
 
 #if defined(DEBUG_EDGES)
@@ -306,8 +451,8 @@ void UpdateCaptureState(const CommonState& commonState,
               bounds.top,
               bounds.right,
               bounds.bottom,
-              textureView.view.width,
-              textureView.view.height,
+              frameWidth,
+              frameHeight,
               px2mmRatio);
     OutputDebugStringA(buffer);
 #endif
@@ -316,6 +461,23 @@ void UpdateCaptureState(const CommonState& commonState,
     });
 }
 
+void UpdateCaptureState(const CommonState& commonState,
+                        Serialized<MeasureToolState>& state,
+                        HWND window,
+                        const MappedTextureView& textureView,
+                        const POINT cursorPosSystemSpace)
+{
+    UpdateCaptureState(commonState,
+                       state,
+                       window,
+                       textureView.view.width,
+                       textureView.view.height,
+                       cursorPosSystemSpace,
+                       [&](const POINT cursorPos, const bool perChannel, const uint8_t tolerance) -> std::optional<RECT> {
+                           return DetectEdges(textureView.view, cursorPos, perChannel, tolerance);
+                       });
+}
+
 std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                                  const CommonState& commonState,
                                  Serialized<MeasureToolState>& state,
@@ -324,14 +486,23 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
 {
     return SpawnLoggedThread(L"Screen Capture thread", [&state, &commonState, monitor, window, dxgiAPI] {
         bool continuousCapture = {};
+        bool precomputeEdges = {};
         state.Read([&](const MeasureToolState& state) {
             continuousCapture = state.global.continuousCapture;
+            precomputeEdges = state.global.precomputeEdges;
         });
 
+        // Must outlive the capture state, which may still be delivering frames to it
+        EdgeMap edgeMap;
+        auto detectFromEdgeMap = [&edgeMap](const POINT cursorPos, const bool perChannel, const uint8_t tolerance) {
+            return edgeMap.DetectEdges(cursorPos, perChannel, tolerance);
+        };
+
         auto captureState = D3DCaptureState::Create(dxgiAPI,
                                                     monitor,
                                                     winrt::DirectXPixelFormat::B8G8R8A8UIntNormalized,
-                                                    continuousCapture);
+                                                    continuousCapture,
+                                                    precomputeEdges);
         const auto monitorArea = monitor.GetScreenSize(true);
         bool mouseOnMonitor = false;
         if (continuousCapture)
@@ -340,6 +511,19 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
             {
                 if (mouseOnMonitor == monitorArea.inside(commonState.cursorPosSystemSpace))
                 {
+                    // New frames only arrive when the screen content changes, the edge map
+                    // lets the measurement follow the cursor in between
+                    if (mouseOnMonitor && precomputeEdges)
+                    {
+                        UpdateCaptureState(commonState,
+                                           state,
+                                           window,
+                                           monitorArea.width(),
+                                           monitorArea.height(),
+                                           commonState.cursorPosSystemSpace,
+                                           detectFromEdgeMap);
+                    }
+
                     std::this_thread::sleep_for(consts::TARGET_FRAME_DURATION);
                     continue;
                 }
@@ -347,8 +531,24 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                 mouseOnMonitor = !mouseOnMonitor;
                 if (mouseOnMonitor)
                 {
-                    captureState->StartCapture([&, window](MappedTextureView textureView) {
-                        UpdateCaptureState(commonState, state, window, textureView);
+                    // Without the edge map only the pixels around the cursor position at
+                    // capture time are copied, so the edges have to be searched from there
+                    captureState->StartCapture(window, [&, window](MappedTextureView textureView, POINT cursorPos) {
+                        if (precomputeEdges)
+                        {
+                            edgeMap.Update(textureView.view);
+                            UpdateCaptureState(commonState,
+                                               state,
+                                               window,
+                                               textureView.view.width,
+                                               textureView.view.height,
+                                               cursorPos,
+                                               detectFromEdgeMap);
+                        }
+                        else
+                        {
+                            UpdateCaptureState(commonState, state, window, textureView, cursorPos);
+                        }
                     });
                 }
                 else
@@ -382,7 +582,7 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                     auto path = std::filesystem::temp_directory_path() / buf;
                     textureView.view.SaveAsBitmap(path.string().c_str());
 #endif
-                    UpdateCaptureState(commonState, state, window, textureView);
+                    UpdateCaptureState(commonState, state, window, textureView, commonState.cursorPosSystemSpace);
                     mouseOnMonitor = true;
                 }
                 else if (mouseOnMonitor)
@@ -14,6 +14,7 @@ namespace
     const wchar_t JSON_KEY_DRAW_FEET_ON_CROSS[] = L"DrawFeetOnCross";
     const wchar_t JSON_KEY_PIXEL_TOLERANCE[] = L"PixelTolerance";
     const wchar_t JSON_KEY_PER_COLOR_CHANNEL_EDGE_DETECTION[] = L"PerColorChannelEdgeDetection";
+    const wchar_t JSON_KEY_PRECOMPUTE_EDGES[] = L"PrecomputeEdges";
     const wchar_t JSON_KEY_MEASURE_CROSS_COLOR[] = L"MeasureCrossColor";
     const wchar_t JSON_KEY_UNITS_OF_MEASURE[] = L"UnitsOfMeasure";
 }
@@ -67,6 +68,14 @@ Settings Settings::LoadFromFile()
         {
         }
 
+        try
+        {
+            result.precomputeEdges = props.GetNamedObject(JSON_KEY_PRECOMPUTE_EDGES).GetNamedBoolean(JSON_KEY_VALUE);
+        }
+        catch (...)
+        {
+        }
+
         try
         {
             auto index = static_cast<int>(props.GetNamedObject(JSON_KEY_UNITS_OF_MEASURE).GetNamedNumber(JSON_KEY_VALUE));
@@ -11,6 +11,7 @@ struct Settings
     bool continuousCapture = false;
     bool drawFeetOnCross = true;
     bool perColorChannelEdgeDetection = false;
+    bool precomputeEdges = false;
     std::array<uint8_t, 3> lineColor = {255, 69, 0};
     Measurement::Unit units = Measurement::Unit::Pixel;
 
@@ -82,6 +82,7 @@ struct MeasureToolState
         bool continuousCapture = false;
         bool drawFeetOnCross = true;
         bool perColorChannelEdgeDetection = false;
+        bool precomputeEdges = false;
         Mode mode = Mode::Cross;
     } global;
 
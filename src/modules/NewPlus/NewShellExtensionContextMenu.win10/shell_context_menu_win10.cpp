@@ -57,9 +57,8 @@ IFACEMETHODIMP shell_context_menu_win10::QueryContextMenu(HMENU menu_handle, UIN
         // Create the New+ Template folder location if it doesn't exist (very rare scenario)
         utilities::create_folder_if_not_exist(template_folder_root);
 
-        // Scan the folder for any files and folders (the templates)
-        templates = new template_folder(template_folder_root);
-        templates->rescan_template_folder();
+        // Get the files and folders (the templates), the folder is only scanned again when it changed
+        templates = template_folder::get_cached(template_folder_root);
         const auto number_of_templates = templates->list_of_templates.size();
 
         // Create the New+ menu item and point to the initial context popup menu
@@ -102,7 +101,7 @@ IFACEMETHODIMP shell_context_menu_win10::QueryContextMenu(HMENU menu_handle, UIN
         for (; index < number_of_templates; index++)
         {
             const auto template_item = templates->get_template_item(index);
-            add_template_item_to_context_menu(sub_menu_of_templates, sub_menu_index, template_item, menu_id, index);
+            add_template_item_to_context_menu(sub_menu_of_templates, sub_menu_index, template_item.get(), menu_id, index);
             menu_id++;
             sub_menu_index++;
         }
@@ -181,7 +180,7 @@ void shell_context_menu_win10::add_separator_to_context_menu(HMENU sub_menu_of_t
     InsertMenuItem(sub_menu_of_templates, sub_menu_index, TRUE, &menu_item_separator);
 }
 
-void shell_context_menu_win10::add_template_item_to_context_menu(HMENU sub_menu_of_templates, int sub_menu_index, newplus::template_item* const template_item, int menu_id, int index)
+void shell_context_menu_win10::add_template_item_to_context_menu(HMENU sub_menu_of_templates, int sub_menu_index, const newplus::template_item* const template_item, int menu_id, int index)
 {
     wchar_t menu_name[256] = { 0 };
     wcscpy_s(menu_name, ARRAYSIZE(menu_name), template_item->get_menu_title(
@@ -246,7 +245,7 @@ IFACEMETHODIMP shell_context_menu_win10::InvokeCommand(CMINVOKECOMMANDINFO* para
         // It's a template menu item
         const auto template_entry = templates->get_template_item(selected_menu_item_index);
 
-        return newplus::utilities::copy_template(template_entry, site_of_folder);
+        return newplus::utilities::copy_template(template_entry.get(), site_of_folder);
     }
     else
     {
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <set>
+#include <string_view>
+#include <wil/resource.h>
 #include "helpers_variables.h"
 
 namespace newplus::helpers::filesystem
@@ -36,23 +40,75 @@ namespace newplus::helpers::filesystem
         return valid_filename;
     }
 
+    // Numbers n for which "stem (n)extension" exists in the folder, from a single listing of the
+    // entries matching that pattern
+    inline std::set<unsigned long> get_used_name_numbers(const std::filesystem::path& folder, const std::wstring& stem, const std::wstring& extension)
+    {
+        std::set<unsigned long> used_numbers;
+        const std::wstring prefix = stem + L" (";
+        const std::wstring suffix = L")" + extension;
+        const std::filesystem::path pattern = folder / (prefix + L"*" + suffix);
+
+        WIN32_FIND_DATAW find_data;
+        wil::unique_hfind find_handle{ FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &find_data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH) };
+        if (!find_handle)
+        {
+            return used_numbers;
+        }
+
+        do
+        {
+            // The pattern also matches short names, so check the long one
+            const std::wstring_view name = find_data.cFileName;
+            if (name.length() <= prefix.length() + suffix.length() ||
+                CompareStringOrdinal(name.data(), static_cast<int>(prefix.length()), prefix.data(), static_cast<int>(prefix.length()), TRUE) != CSTR_EQUAL ||
+                CompareStringOrdinal(name.data() + name.length() - suffix.length(), static_cast<int>(suffix.length()), suffix.data(), static_cast<int>(suffix.length()), TRUE) != CSTR_EQUAL)
+            {
+                continue;
+            }
+
+            // Only "(1)", "(2)", ... can collide, not "(01)"
+            const std::wstring_view digits = name.substr(prefix.length(), name.length() - prefix.length() - suffix.length());
+            if (digits.length() > 9 || digits.front() == L'0' ||
+                !std::all_of(digits.begin(), digits.end(), [](const wchar_t c) { return c >= L'0' && c <= L'9'; }))
+            {
+                continue;
+            }
+
+            used_numbers.insert(std::stoul(std::wstring{ digits }));
+        } while (FindNextFileW(find_handle.get(), &find_data));
+
+        return used_numbers;
+    }
+
     inline std::wstring make_unique_path_name(const std::wstring& initial_path)
     {
         std::filesystem::path folder_path(initial_path);
         std::filesystem::path path_based_on(initial_path);
 
-        int counter = 1;
+        if (!std::filesystem::exists(folder_path))
+        {
+            return folder_path.wstring();
+        }
+
+        // Pick the lowest free number from one listing, instead of probing "name (1)", "name (2)", ...
+        const std::wstring stem = path_based_on.stem().wstring();
+        const std::wstring extension = path_based_on.has_extension() ? path_based_on.extension().wstring() : std::wstring{};
+        const std::set<unsigned long> used_numbers = get_used_name_numbers(path_based_on.parent_path(), stem, extension);
 
-        while (std::filesystem::exists(folder_path))
+        unsigned long counter = 1;
+        do
         {
-            std::wstring new_filename = path_based_on.stem().wstring() + L" (" + std::to_wstring(counter) + L")";
-            if (path_based_on.has_extension())
+            while (used_numbers.contains(counter))
             {
-                new_filename += path_based_on.extension().wstring();
+                counter++;
             }
-            folder_path = path_based_on.parent_path() / new_filename;
+
+            folder_path = path_based_on.parent_path() / (stem + L" (" + std::to_wstring(counter) + L")" + extension);
             counter++;
-        }
+
+            // The name may have been created since the listing, the copy itself fails instead of overwriting
+        } while (std::filesystem::exists(folder_path));
 
         return folder_path.wstring();
     }
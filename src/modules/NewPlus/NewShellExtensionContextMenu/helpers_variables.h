@@ -1,6 +1,5 @@
 #pragma once
 
-#include <regex>
 #include "..\..\powerrename\lib\Helpers.h"
 #include "helpers_filesystem.h"
 
@@ -52,23 +51,32 @@ namespace newplus::helpers::variables
     {
         // Do case-insensitive string replacement of environment variables being consistent with normal %eNV_VaR% behavior
         std::wstring return_string = string;
-        const std::wregex reg_expression(L"%([^%]+)%");
-        std::wsmatch match;
 
-        size_t start = 0;
-        while (std::regex_search(return_string.cbegin() + start, return_string.cend(), match, reg_expression))
+        size_t start = return_string.find(L'%');
+        while (start != std::wstring::npos)
         {
-            std::wstring env_var_name = match[1].str();
-            std::wstring env_var_value = resolve_an_environment_variable(env_var_name);
+            const size_t end = return_string.find(L'%', start + 1);
+            if (end == std::wstring::npos)
+            {
+                break;
+            }
+
+            if (end == start + 1)
+            {
+                // Empty name, the second % may start a variable
+                start = end;
+                continue;
+            }
+
+            const std::wstring env_var_value = resolve_an_environment_variable(return_string.substr(start + 1, end - start - 1));
             if (!env_var_value.empty())
             {
-                size_t match_position = match.position(0) + start;
-                return_string.replace(match_position, match.length(0), env_var_value);
-                start = match_position + env_var_value.length();
+                return_string.replace(start, end - start + 1, env_var_value);
+                start = return_string.find(L'%', start + env_var_value.length());
             }
             else
             {
-                start += match.position(0) + match.length(0);
+                start = return_string.find(L'%', end + 1);
             }
         }
 
@@ -85,11 +93,19 @@ namespace newplus::helpers::variables
 
     inline std::filesystem::path resolve_variables_in_filename(const std::wstring& filename, const std::wstring& parent_folder_name)
     {
-        std::wstring result;
+        // Date, time and parent folder variables start with $ and environment variables with %,
+        // so most names skip the resolving
+        std::wstring result = filename;
 
-        result = resolve_date_time_variables(filename);
-        result = resolve_environment_variables(result);
-        if (!parent_folder_name.empty())
+        if (result.find(L'$') != std::wstring::npos)
+        {
+            result = resolve_date_time_variables(result);
+        }
+        if (result.find(L'%') != std::wstring::npos)
+        {
+            result = resolve_environment_variables(result);
+        }
+        if (!parent_folder_name.empty() && result.find(L'$') != std::wstring::npos)
         {
             result = resolve_parent_folder(result, parent_folder_name);
         }
@@ -128,42 +144,4 @@ namespace newplus::helpers::variables
 
         return result;
     }
-
-    inline void resolve_variables_in_filename_and_rename_files(const std::filesystem::path& path, const bool do_rename = true)
-    {
-        // Depth first recursion, so that we start renaming the leaves, and avoid having to rescan
-        for (const auto& entry : std::filesystem::directory_iterator(path))
-        {
-            if (std::filesystem::is_directory(entry.status()))
-            {
-                resolve_variables_in_filename_and_rename_files(entry.path(), do_rename);
-            }
-        }
-
-        // Perform the actual rename
-        for (const auto& current : std::filesystem::directory_iterator(path))
-        {
-            if (!newplus::helpers::filesystem::is_hidden(current))
-            {
-                const std::filesystem::path resolved_path = resolve_variables_in_path(current.path());
-
-                // Only rename if the filename is actually different
-                const std::wstring non_resolved_leaf = current.path().filename();
-                const std::wstring resolved_leaf = resolved_path.filename();
-
-                if (StrCmpIW(non_resolved_leaf.c_str(), resolved_leaf.c_str()) != 0)
-                {
-                    const std::wstring org_name = current.path();
-                    const std::wstring new_name = current.path().parent_path() / resolved_leaf;
-                    const std::wstring really_new_name = helpers::filesystem::make_unique_path_name(new_name);
-
-                    // To aid with testing, only conditionally rename
-                    if (do_rename)
-                    {
-                        std::filesystem::rename(org_name, really_new_name);
-                    }
-                }
-            }
-        }
-    }
 }
\ No newline at end of file
@@ -373,17 +373,17 @@ namespace newplus::utilities
             // See if our target already exist, and if so then generate a unique name
             target_fullpath = helpers::filesystem::make_unique_path_name(target_fullpath);
 
-            // Finally copy file/folder/subfolders
-            std::filesystem::path target_final_fullpath = template_entry->copy_object_to(GetActiveWindow(), target_fullpath);
-
-            // Resolve variables and rename files in newly copied folders and subfolders and files
-            if (utilities::get_newplus_setting_resolve_variables() && helpers::filesystem::is_directory(target_final_fullpath))
+            // Finally copy file/folder/subfolders, with variables resolved in names and last modified set to "now"
+            std::filesystem::path target_final_fullpath;
+            if (helpers::filesystem::is_directory(source_fullpath))
             {
-                helpers::variables::resolve_variables_in_filename_and_rename_files(target_final_fullpath);
+                target_final_fullpath = template_entry->copy_folder_to(GetActiveWindow(), target_fullpath, utilities::get_newplus_setting_resolve_variables());
+            }
+            else
+            {
+                target_final_fullpath = template_entry->copy_object_to(GetActiveWindow(), target_fullpath);
+                update_last_write_time(target_final_fullpath);
             }
-
-            // Touch all files and set last modified to "now"
-            update_last_write_time(target_final_fullpath);
 
             // Consider copy completed. If we do tracing after enter_rename_mode, then rename mode won't consistently work
             trace.UpdateState(true);
@@ -16,9 +16,8 @@ shell_context_sub_menu::shell_context_sub_menu(const ComPtr<IUnknown> site_of_fo
     // Create the New+ Template folder location if it doesn't exist (very rare scenario)
     utilities::create_folder_if_not_exist(root);
 
-    // Scan the folder for any files and folders (the templates)
-    templates = new template_folder(root);
-    templates->rescan_template_folder();
+    // Get the files and folders (the templates), the folder is only scanned again when it changed
+    templates = template_folder::get_cached(root);
 
     // Add template items to context menu
     const auto number_of_templates = templates->list_of_templates.size();
@@ -24,6 +24,6 @@ public:
 protected:
     std::vector<ComPtr<IExplorerCommand>> explorer_menu_item_commands;
     std::vector<ComPtr<IExplorerCommand>>::const_iterator current_command;
-    template_folder* templates;
+    std::shared_ptr<const template_folder> templates;
     ComPtr<IUnknown> site_of_folder;
 };
@@ -12,7 +12,7 @@ using namespace newplus;
 class shell_context_sub_menu_item : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IExplorerCommand>
 {
 public:
-    shell_context_sub_menu_item(const template_item* template_entry, const ComPtr<IUnknown> site_of_folder);
+    shell_context_sub_menu_item(std::shared_ptr<const template_item> template_entry, const ComPtr<IUnknown> site_of_folder);
 
     // IExplorerCommand
     IFACEMETHODIMP GetTitle(_In_opt_ IShellItemArray* items, _Outptr_result_nullonfailure_ PWSTR* title);
@@ -33,7 +33,7 @@ public:
 
 protected:
     shell_context_sub_menu_item();
-    const template_item* template_entry;
+    std::shared_ptr<const template_item> template_entry;
     ComPtr<IUnknown> site_of_folder;
 };
 
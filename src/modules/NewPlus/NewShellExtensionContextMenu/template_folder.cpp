@@ -1,9 +1,66 @@
 #include "pch.h"
 #include <shellapi.h>
+#include <algorithm>
+#include <mutex>
+#include <wil/resource.h>
+#include <common/utils/winapi_error.h>
 #include "template_folder.h"
 
 using namespace newplus;
 
+namespace
+{
+    struct template_folder_cache
+    {
+        std::mutex mutex;
+        std::filesystem::path watched_folder;
+        wil::unique_hfind_change change_notification;
+        std::shared_ptr<const template_folder> templates;
+    };
+
+    template_folder_cache& get_template_folder_cache()
+    {
+        static template_folder_cache cache;
+        return cache;
+    }
+
+    // Returns true if the folder changed since the last call. The notification is armed again
+    // before the folder is scanned, so a change made during the scan isn't missed.
+    bool template_folder_changed(template_folder_cache& cache)
+    {
+        if (!cache.change_notification)
+        {
+            // Can't know, scan every time like before the cache
+            return true;
+        }
+
+        if (WaitForSingleObject(cache.change_notification.get(), 0) != WAIT_OBJECT_0)
+        {
+            return false;
+        }
+
+        if (!FindNextChangeNotification(cache.change_notification.get()))
+        {
+            Logger::warn(L"Failed to watch the template folder again. {}", get_last_error_or_default(GetLastError()));
+            cache.change_notification.reset();
+        }
+
+        return true;
+    }
+
+    void watch_template_folder(template_folder_cache& cache, const std::filesystem::path& folder)
+    {
+        cache.watched_folder = folder;
+
+        // Hiding or unhiding a template changes its attributes, not its name
+        cache.change_notification.reset(FindFirstChangeNotificationW(folder.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES));
+        if (!cache.change_notification)
+        {
+            Logger::warn(L"Failed to watch the template folder. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+}
+
 template_folder::template_folder(){};
 
 template_folder::template_folder(const std::filesystem::path newplus_template_folder)
@@ -21,37 +78,59 @@ void template_folder::init()
     rescan_template_folder();
 }
 
+std::shared_ptr<const template_folder> template_folder::get_cached(const std::filesystem::path& newplus_template_folder)
+{
+    auto& cache = get_template_folder_cache();
+    std::unique_lock lock(cache.mutex);
+
+    bool rescan = true;
+    if (cache.templates == nullptr || cache.watched_folder != newplus_template_folder)
+    {
+        watch_template_folder(cache, newplus_template_folder);
+    }
+    else
+    {
+        rescan = template_folder_changed(cache);
+    }
+
+    if (rescan)
+    {
+        auto templates = std::make_shared<template_folder>(newplus_template_folder);
+        templates->rescan_template_folder();
+        cache.templates = std::move(templates);
+    }
+
+    return cache.templates;
+}
+
 void template_folder::rescan_template_folder()
 {
     list_of_templates.clear();
 
-    std::list<std::pair<std::wstring, template_item*>> dirs;
-    std::list<std::pair<std::wstring, template_item*>> files;
+    std::vector<std::shared_ptr<const template_item>> files;
     for (const auto& entry : std::filesystem::directory_iterator(template_folder_path))
     {
         if (entry.is_directory())
         {
-            dirs.push_back({ entry.path().wstring(), new template_item(entry) });
+            list_of_templates.push_back(std::make_shared<const template_item>(entry));
         }
         else
         {
             if (!helpers::filesystem::is_hidden(entry.path()))
             {
-                files.push_back({ entry.path().wstring(), new template_item(entry) });
+                files.push_back(std::make_shared<const template_item>(entry));
             }
         }
     }
 
     // List of templates are sorted, with template-directories/folders first then followed by template-files
-    dirs.sort();
-    files.sort();
-    list_of_templates = dirs;
-    list_of_templates.splice(list_of_templates.end(), files);
+    const auto by_path = [](const auto& a, const auto& b) { return a->path.native() < b->path.native(); };
+    std::sort(list_of_templates.begin(), list_of_templates.end(), by_path);
+    std::sort(files.begin(), files.end(), by_path);
+    list_of_templates.insert(list_of_templates.end(), files.begin(), files.end());
 }
 
-template_item* template_folder::get_template_item(const int index) const
+std::shared_ptr<const template_item> template_folder::get_template_item(const int index) const
 {
-    auto it = list_of_templates.begin();
-    std::advance(it, index);
-    return it->second;
+    return list_of_templates[index];
 }
@@ -3,8 +3,9 @@
 #include "pch.h"
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <string>
-#include <list>
+#include <vector>
 #include "template_item.h"
 
 namespace newplus
@@ -15,12 +16,16 @@ namespace newplus
         template_folder(const std::filesystem::path newplus_template_folder);
         ~template_folder();
 
+        // Returns the templates of the folder, shared by every menu of the process. The folder
+        // is only scanned again after a change notification for it.
+        static std::shared_ptr<const template_folder> get_cached(const std::filesystem::path& newplus_template_folder);
+
         void rescan_template_folder();
 
         std::filesystem::path template_folder_path;
-        std::list<std::pair<std::wstring, template_item*>> list_of_templates;
+        std::vector<std::shared_ptr<const template_item>> list_of_templates;
 
-        template_item* get_template_item(const int index) const;
+        std::shared_ptr<const template_item> get_template_item(const int index) const;
 
     protected:
         template_folder();
@@ -66,9 +66,10 @@ std::wstring template_item::remove_starting_digits_from_filename(std::wstring fi
     return filename;
 }
 
-std::wstring template_item::get_explorer_icon() const
+const std::wstring& template_item::get_explorer_icon() const
 {
-    return utilities::get_explorer_icon(path);
+    std::call_once(explorer_icon_resolved, [this] { explorer_icon = utilities::get_explorer_icon(path); });
+    return explorer_icon;
 }
 
 HICON template_item::get_explorer_icon_handle() const
@@ -104,6 +105,52 @@ std::filesystem::path template_item::copy_object_to(const HWND window_handle, co
     return destination;
 }
 
+std::filesystem::path template_item::copy_folder_to(const HWND window_handle, const std::filesystem::path destination, const bool resolve_variables) const
+{
+    // The shell copies the folder, which keeps its elevation prompt, undo record and folder attributes
+    const std::filesystem::path target = copy_object_to(window_handle, destination);
+
+    const std::filesystem::file_time_type now = std::filesystem::file_time_type::clock::now();
+    resolve_and_touch_folder_contents(target, resolve_variables, now);
+    std::filesystem::last_write_time(target, now);
+
+    return target;
+}
+
+void template_item::resolve_and_touch_folder_contents(const std::filesystem::path& folder, const bool resolve_variables, const std::filesystem::file_time_type now)
+{
+    const std::wstring parent_folder_name = folder.filename();
+
+    // Listed before renaming, so that a renamed entry isn't listed again
+    const std::vector<std::filesystem::directory_entry> entries{ std::filesystem::directory_iterator(folder), std::filesystem::directory_iterator() };
+    for (const auto& entry : entries)
+    {
+        std::filesystem::path target = entry.path();
+        if (resolve_variables && !helpers::filesystem::is_hidden(entry.path()))
+        {
+            const std::wstring non_resolved_leaf = entry.path().filename();
+            const std::wstring resolved_leaf = helpers::variables::resolve_variables_in_filename(non_resolved_leaf, parent_folder_name);
+
+            // Only rename if the filename is actually different
+            if (StrCmpIW(non_resolved_leaf.c_str(), resolved_leaf.c_str()) != 0)
+            {
+                // A resolved name may be the same as the name of another entry
+                target = helpers::filesystem::make_unique_path_name(folder / resolved_leaf);
+                std::filesystem::rename(entry.path(), target);
+            }
+        }
+
+        // Renamed before its contents, so that they resolve $PARENT_FOLDER_NAME to its final name
+        if (entry.is_directory())
+        {
+            resolve_and_touch_folder_contents(target, resolve_variables, now);
+        }
+
+        // Set after the contents are renamed, renaming them changes the time of a folder
+        std::filesystem::last_write_time(target, now);
+    }
+}
+
 void template_item::refresh_target(const std::filesystem::path target_final_fullpath) const
 {
     SHChangeNotify(SHCNE_CREATE, SHCNF_PATH | SHCNF_FLUSH, target_final_fullpath.wstring().c_str(), NULL);
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <mutex>
 
 using namespace Microsoft::WRL;
 
@@ -19,12 +20,17 @@ namespace newplus
 
         std::wstring get_target_filename(const bool include_starting_digits) const;
 
-        std::wstring get_explorer_icon() const;
+        // Resolved the first time it's asked for, the item is shared by every menu of the process
+        const std::wstring& get_explorer_icon() const;
         
         HICON get_explorer_icon_handle() const;
 
         std::filesystem::path copy_object_to(const HWND window_handle, const std::filesystem::path destination) const;
 
+        // Copies a folder template, then resolves the variables in the names of what's inside when
+        // asked to and sets the last write time of everything to now, in a single walk of the copy
+        std::filesystem::path copy_folder_to(const HWND window_handle, const std::filesystem::path destination, const bool resolve_variables) const;
+
         void refresh_target(const std::filesystem::path target_final_fullpath) const;
 
         void enter_rename_mode(const std::filesystem::path target_fullpath) const;
@@ -35,5 +41,10 @@ namespace newplus
         static void rename_on_other_thread_workaround(const std::filesystem::path target_fullpath);
 
         std::wstring remove_starting_digits_from_filename(std::wstring filename) const;
+
+        static void resolve_and_touch_folder_contents(const std::filesystem::path& folder, const bool resolve_variables, const std::filesystem::file_time_type now);
+
+        mutable std::once_flag explorer_icon_resolved;
+        mutable std::wstring explorer_icon;
     };
 }
\ No newline at end of file
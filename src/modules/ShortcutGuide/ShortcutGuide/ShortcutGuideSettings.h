@@ -10,4 +10,5 @@ struct ShortcutGuideSettings
     bool shouldReactToPressedWinKey = false;
     int windowsKeyPressTimeForGlobalWindowsShortcuts = 900;
     int windowsKeyPressTimeForTaskbarIconShortcuts = 900;
+    bool keepOverlayResident = false;
 };
@@ -1,9 +1,18 @@
 #include "pch.h"
 #include "d2d_svg.h"
 
+#include <cmath>
+
+namespace
+{
+    // Bitmaps kept per document, a new scale or state beyond that starts over
+    constexpr size_t maxRasterizedBitmaps = 16;
+}
+
 D2DSVG& D2DSVG::load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc)
 {
     svg = nullptr;
+    rasterized.clear();
     winrt::com_ptr<IStream> svg_stream;
     auto h = SHCreateStreamOnFileEx(filename.c_str(),
                                     STGM_READ,
@@ -49,6 +58,7 @@ D2DSVG& D2DSVG::resize(int x, int y, int width, int height, float fill, float ma
 
 D2DSVG& D2DSVG::recolor(uint32_t oldcolor, uint32_t newcolor)
 {
+    rasterized.clear();
     auto new_color = D2D1::ColorF(newcolor & 0xFFFFFF, 1);
     auto old_color = D2D1::ColorF(oldcolor & 0xFFFFFF, 1);
     std::function<void(ID2D1SvgElement * element)> recurse = [&](ID2D1SvgElement* element) {
@@ -91,6 +101,67 @@ D2DSVG& D2DSVG::render(ID2D1DeviceContext5* d2d_dc)
     return *this;
 }
 
+D2DSVG& D2DSVG::rasterize(ID2D1DeviceContext5* d2d_dc, uint64_t state)
+{
+    const auto key = std::make_pair(used_scale, state);
+    if (rasterized.contains(key))
+    {
+        return *this;
+    }
+
+    const auto size = D2D1::SizeU(static_cast<UINT32>(std::ceil(svg_width * used_scale)), static_cast<UINT32>(std::ceil(svg_height * used_scale)));
+    if (size.width == 0 || size.height == 0)
+    {
+        return *this;
+    }
+
+    winrt::com_ptr<ID2D1Bitmap1> bitmap;
+    const auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET,
+                                                    D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
+    winrt::check_hresult(d2d_dc->CreateBitmap(size, nullptr, 0, properties, bitmap.put()));
+
+    // Draw into the bitmap, then restore the target of the frame being drawn
+    winrt::com_ptr<ID2D1Image> target;
+    d2d_dc->GetTarget(target.put());
+    D2D1_MATRIX_3X2_F current;
+    d2d_dc->GetTransform(&current);
+
+    d2d_dc->SetTarget(bitmap.get());
+    d2d_dc->SetTransform(D2D1::Matrix3x2F::Scale(used_scale, used_scale));
+    d2d_dc->Clear();
+    d2d_dc->DrawSvgDocument(svg.get());
+
+    d2d_dc->SetTarget(target.get());
+    d2d_dc->SetTransform(current);
+
+    if (rasterized.size() >= maxRasterizedBitmaps)
+    {
+        rasterized.clear();
+    }
+    rasterized.emplace(key, std::move(bitmap));
+    return *this;
+}
+
+D2DSVG& D2DSVG::render_rasterized(ID2D1DeviceContext5* d2d_dc, uint64_t state)
+{
+    rasterize(d2d_dc, state);
+    const auto bitmap = rasterized.find(std::make_pair(used_scale, state));
+    if (bitmap == rasterized.end())
+    {
+        return *this;
+    }
+
+    // The transform only scales and moves, so the top left corner is enough to place the bitmap.
+    // Snapping it to whole pixels keeps the bitmap sharp.
+    const auto origin = transform.TransformPoint(D2D1::Point2F(0, 0));
+    D2D1_MATRIX_3X2_F current;
+    d2d_dc->GetTransform(&current);
+    d2d_dc->SetTransform(D2D1::Matrix3x2F::Translation(std::round(origin.x), std::round(origin.y)) * current);
+    d2d_dc->DrawBitmap(bitmap->second.get(), nullptr, 1.0f, D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+    d2d_dc->SetTransform(current);
+    return *this;
+}
+
 D2DSVG& D2DSVG::toggle_element(const wchar_t* id, bool visible)
 {
     winrt::com_ptr<ID2D1SvgElement> element;
@@ -2,7 +2,9 @@
 #include <d2d1_3.h>
 #include <d2d1_3helper.h>
 #include <winrt/base.h>
+#include <map>
 #include <string>
+#include <utility>
 
 class D2DSVG
 {
@@ -10,6 +12,11 @@ public:
     D2DSVG& load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc);
     D2DSVG& resize(int x, int y, int width, int height, float fill, float max_scale = -1.0f);
     D2DSVG& render(ID2D1DeviceContext5* d2d_dc);
+    // Rasterizes the document at the current scale and keeps the bitmap, so render_rasterized only
+    // draws it. The state passed must tell apart every combination of attributes changed since loading,
+    // recolor drops all the bitmaps. Moving the document doesn't need a new bitmap.
+    D2DSVG& rasterize(ID2D1DeviceContext5* d2d_dc, uint64_t state = 0);
+    D2DSVG& render_rasterized(ID2D1DeviceContext5* d2d_dc, uint64_t state = 0);
     D2DSVG& recolor(uint32_t oldcolor, uint32_t newcolor);
     float get_scale() const { return used_scale; }
     int width() const { return svg_width; }
@@ -23,4 +30,7 @@ protected:
     winrt::com_ptr<ID2D1SvgDocument> svg;
     int svg_width = -1, svg_height = -1;
     D2D1::Matrix3x2F transform;
+
+    // By scale and state
+    std::map<std::pair<float, uint64_t>, winrt::com_ptr<ID2D1Bitmap1>> rasterized;
 };
@@ -73,6 +73,7 @@ void D2DWindow::base_init()
                                                d2d_factory.put_void()));
     }
     // For all other stuff - assign nullptr first to release the object, to reset the com_ptr.
+    dxgi_swap_chain = nullptr;
     d2d_dc = nullptr;
     d2d_device = nullptr;
     dxgi_factory = nullptr;
@@ -103,6 +104,12 @@ void D2DWindow::base_resize(UINT width, UINT height)
     {
         return;
     }
+    // Showing again at the same size keeps the swap chain, only the layout is refreshed
+    if (dxgi_swap_chain && width == window_width && height == window_height)
+    {
+        resize();
+        return;
+    }
     window_width = width;
     window_height = height;
     if (window_width == 0 || window_height == 0)
@@ -198,6 +205,10 @@ LRESULT __stdcall D2DWindow::d2d_window_proc(HWND window, UINT message, WPARAM w
         return TRUE;
     }
     case WM_MOVE:
+        // lparam holds the position, the size didn't change
+        self->base_resize(self->window_width, self->window_height);
+        self->base_render();
+        return 0;
     case WM_SIZE:
         self->base_resize(static_cast<unsigned>(lparam) & 0xFFFF, static_cast<unsigned>(lparam) >> 16);
         [[fallthrough]];
@@ -16,6 +16,10 @@
 #include "ShortcutGuideConstants.h"
 #include "trace.h"
 
+#include <optional>
+#include <sstream>
+#include <vector>
+
 const std::wstring instanceMutexName = L"Local\\PowerToys_ShortcutGuide_InstanceMutex";
 
 // set current path to the executable path
@@ -67,8 +71,31 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/, _In_opt_ HINSTANCE /*hPrevInst
         return false;
     }
 
+    // The runner pid, then "telemetry" to only send the settings, or an optional "resident" to keep
+    // running hidden between activations, followed by the steady_clock ticks of the key press
+    std::vector<std::wstring> arguments;
+    std::wistringstream argumentStream{ std::wstring(lpCmdLine) };
+    for (std::wstring argument; argumentStream >> argument;)
+    {
+        arguments.push_back(argument);
+    }
+
+    const std::wstring mode = arguments.size() > 1 ? arguments[1] : L"";
+    const bool resident = mode == L"resident";
+    std::optional<std::chrono::steady_clock::time_point> keyDownTime;
+    if (arguments.size() > (resident ? 2u : 1u))
+    {
+        try
+        {
+            keyDownTime = std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ std::stoll(arguments.back()) } };
+        }
+        catch (...)
+        {
+        }
+    }
+
     Trace::RegisterProvider();
-    if (std::wstring(lpCmdLine).find(L' ') != std::wstring::npos)
+    if (mode == L"telemetry")
     {
         Logger::trace("Sending settings telemetry");
         auto settings = OverlayWindow::GetSettings();
@@ -90,7 +117,7 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/, _In_opt_ HINSTANCE /*hPrevInst
         return 0;
     }
 
-    std::wstring pid = std::wstring(lpCmdLine);
+    std::wstring pid = arguments.empty() ? L"" : arguments[0];
     if (!pid.empty())
     {
         auto mainThreadId = GetCurrentThreadId();
@@ -109,10 +136,34 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/, _In_opt_ HINSTANCE /*hPrevInst
         });
     }
 
-    auto hwnd = GetForegroundWindow();
-    auto window = OverlayWindow(hwnd);
+    auto hwnd = resident ? nullptr : GetForegroundWindow();
+    auto window = OverlayWindow(hwnd, resident);
     EventWaiter exitEventWaiter;
-    if (window.IsDisabled())
+    if (resident)
+    {
+        Logger::trace("Starting resident Shortcut Guide");
+        auto mainThreadId = GetCurrentThreadId();
+        exitEventWaiter = EventWaiter(CommonSharedConstants::SHORTCUT_GUIDE_EXIT_EVENT, [mainThreadId](int err) {
+            if (err != ERROR_SUCCESS)
+            {
+                Logger::error(L"Failed to wait for {} event. {}", CommonSharedConstants::SHORTCUT_GUIDE_EXIT_EVENT, get_last_error_or_default(err));
+            }
+            else
+            {
+                Logger::trace(L"{} event was signaled", CommonSharedConstants::SHORTCUT_GUIDE_EXIT_EVENT);
+            }
+
+            PostThreadMessage(mainThreadId, WM_QUIT, 0, 0);
+        });
+
+        window.Prewarm();
+        if (keyDownTime)
+        {
+            // Started by a key press, show it right away
+            window.Toggle(*keyDownTime, false);
+        }
+    }
+    else if (window.IsDisabled())
     {
         Logger::trace("SG is disabled for the current foreground app. Exiting SG");
         Trace::UnregisterProvider();
@@ -133,9 +184,10 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/, _In_opt_ HINSTANCE /*hPrevInst
 
             window.CloseWindow(HideWindowType::THE_SHORTCUT_PRESSED, mainThreadId);
         });
+
+        window.ShowWindow(keyDownTime, false);
     }
 
-    window.ShowWindow();
     run_message_loop();
 
     trace.Flush();
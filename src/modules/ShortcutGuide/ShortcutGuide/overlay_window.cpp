@@ -268,8 +268,9 @@ D2D1_RECT_F D2DOverlaySVG::get_snap_right() const
     return result;
 }
 
-D2DOverlayWindow::D2DOverlayWindow() :
+D2DOverlayWindow::D2DOverlayWindow(bool resident) :
     total_screen({}),
+    tasklist(resident),
     D2DWindow()
 {
     BOOL isEnabledAnimations = GetAnimationsEnabled();
@@ -287,11 +288,15 @@ D2DOverlayWindow::D2DOverlayWindow() :
             task_list_lock.unlock();
             while (running && tasklist_update)
             {
-                std::vector<TasklistButton> buttons;
-                if (tasklist.update_buttons(buttons))
+                // The buttons are only walked again when the taskbar reported a change
+                if (tasklist.changed())
                 {
-                    std::unique_lock lock(mutex);
-                    tasklist_buttons.swap(buttons);
+                    std::vector<TasklistButton> buttons;
+                    if (tasklist.update_buttons(buttons))
+                    {
+                        std::unique_lock lock(mutex);
+                        tasklist_buttons.swap(buttons);
+                    }
                 }
                 std::this_thread::sleep_for(std::chrono::milliseconds(500));
             }
@@ -303,7 +308,6 @@ void D2DOverlayWindow::show(HWND window, bool snappable)
 {
     std::unique_lock lock(mutex);
     hidden = false;
-    tasklist_buttons.clear();
     active_window = window;
     active_window_snappable = snappable;
     auto old_bck = colors.start_color_menu;
@@ -357,6 +361,15 @@ void D2DOverlayWindow::show(HWND window, bool snappable)
     total_screen.rect.top += monitor_dy;
     total_screen.rect.bottom += monitor_dy;
     tasklist.update();
+    // Check if taskbar is auto-hidden. If so, don't display the number arrows
+    APPBARDATA param = {};
+    param.cbSize = sizeof(APPBARDATA);
+    const bool taskbar_auto_hidden = static_cast<UINT>(SHAppBarMessage(ABM_GETSTATE, &param)) == ABS_AUTOHIDE;
+    // Buttons found by an earlier show are kept until the taskbar changes
+    if (taskbar_auto_hidden || tasklist.changed())
+    {
+        tasklist_buttons.clear();
+    }
     if (window)
     {
         // Ignore errors, if this fails we will just not show the thumbnail
@@ -389,10 +402,7 @@ void D2DOverlayWindow::show(HWND window, bool snappable)
     shown_start_time = std::chrono::steady_clock::now();
     lock.unlock();
     D2DWindow::show(primary_size.left(), primary_size.top(), primary_size.width(), primary_size.height());
-    // Check if taskbar is auto-hidden. If so, don't display the number arrows
-    APPBARDATA param = {};
-    param.cbSize = sizeof(APPBARDATA);
-    if (static_cast<UINT>(SHAppBarMessage(ABM_GETSTATE, &param)) != ABS_AUTOHIDE)
+    if (!taskbar_auto_hidden)
     {
         tasklist_cv_mutex.lock();
         tasklist_update = true;
@@ -416,7 +426,9 @@ void D2DOverlayWindow::on_hide()
     if (thumbnail)
     {
         DwmUnregisterThumbnail(thumbnail);
+        thumbnail = nullptr;
     }
+    show_key_down_time.reset();
     std::chrono::steady_clock::time_point shown_end_time = std::chrono::steady_clock::now();
     // Trace the event only if the overlay window was visible.
     if (shown_start_time.time_since_epoch().count() > 0)
@@ -485,9 +497,39 @@ void D2DOverlayWindow::quick_hide()
     if (thumbnail)
     {
         DwmUnregisterThumbnail(thumbnail);
+        thumbnail = nullptr;
     }
 }
 
+void D2DOverlayWindow::prerender()
+{
+    auto primary_size = MonitorInfo::GetPrimaryMonitor().GetScreenSize(false);
+    base_resize(primary_size.width(), primary_size.height());
+
+    std::unique_lock lock(mutex);
+    if (use_overlay && d2d_dc)
+    {
+        d2d_dc->BeginDraw();
+        // With a restored window, a maximized window and without an active window
+        use_overlay->rasterize(d2d_dc.get(), apply_overlay_state(true, false, false, false, false));
+        use_overlay->rasterize(d2d_dc.get(), apply_overlay_state(true, true, false, false, false));
+        use_overlay->rasterize(d2d_dc.get(), apply_overlay_state(false, true, true, true, true));
+        no_active.rasterize(d2d_dc.get());
+        winrt::check_hresult(d2d_dc->EndDraw());
+    }
+    lock.unlock();
+
+    // The window is created visible, keep it hidden until the first show
+    ShowWindow(hwnd, SW_HIDE);
+}
+
+void D2DOverlayWindow::measure_show_latency(std::chrono::steady_clock::time_point key_down_time, bool warm)
+{
+    std::unique_lock lock(mutex);
+    show_key_down_time = key_down_time;
+    show_warm = warm;
+}
+
 HWND D2DOverlayWindow::get_window_handle()
 {
     return hwnd;
@@ -498,6 +540,18 @@ float D2DOverlayWindow::get_overlay_opacity()
     return overlay_opacity;
 }
 
+// Sets the attributes of the overlay SVG that depend on the active window, returns the state of its rasterized layer
+uint64_t D2DOverlayWindow::apply_overlay_state(bool window_group_active, bool up_disabled, bool down_disabled, bool left_disabled, bool right_disabled)
+{
+    use_overlay->toggle_window_group(window_group_active);
+    use_overlay->find_element(L"KeyUpGroup")->SetAttributeValue(L"fill-opacity", up_disabled ? 0.3f : 1.0f);
+    use_overlay->find_element(L"KeyDownGroup")->SetAttributeValue(L"fill-opacity", down_disabled ? 0.3f : 1.0f);
+    use_overlay->find_element(L"KeyLeftGroup")->SetAttributeValue(L"fill-opacity", left_disabled ? 0.3f : 1.0f);
+    use_overlay->find_element(L"KeyRightGroup")->SetAttributeValue(L"fill-opacity", right_disabled ? 0.3f : 1.0f);
+    return static_cast<uint64_t>(window_group_active) | (static_cast<uint64_t>(up_disabled) << 1) | (static_cast<uint64_t>(down_disabled) << 2) |
+           (static_cast<uint64_t>(left_disabled) << 3) | (static_cast<uint64_t>(right_disabled) << 4);
+}
+
 void D2DOverlayWindow::init()
 {
     colors.update();
@@ -565,6 +619,8 @@ void D2DOverlayWindow::resize()
 void render_arrow(D2DSVG& arrow, TasklistButton& button, RECT window, float max_scale, ID2D1DeviceContext5* d2d_dc, int x_offset, int y_offset)
 {
     int dx = 0, dy = 0;
+    // The visible arrows are the state of the rasterized layer
+    uint64_t directions = 0;
     // Calculate taskbar orientation
     arrow.toggle_element(L"left", false);
     arrow.toggle_element(L"right", false);
@@ -573,21 +629,25 @@ void render_arrow(D2DSVG& arrow, TasklistButton& button, RECT window, float max_
     if (button.x <= window.left)
     { // taskbar on left
         dx = 1;
+        directions |= 1;
         arrow.toggle_element(L"left", true);
     }
     if (button.x >= window.right)
     { // taskbar on right
         dx = -1;
+        directions |= 2;
         arrow.toggle_element(L"right", true);
     }
     if (button.y <= window.top)
     { // taskbar on top
         dy = 1;
+        directions |= 4;
         arrow.toggle_element(L"top", true);
     }
     if (button.y >= window.bottom)
     { // taskbar on bottom
         dy = -1;
+        directions |= 8;
         arrow.toggle_element(L"bottom", true);
     }
     double arrow_ratio = static_cast<double>(arrow.height()) / arrow.width();
@@ -602,7 +662,7 @@ void render_arrow(D2DSVG& arrow, TasklistButton& button, RECT window, float max_
                      render_arrow_height,
                      0.95f,
                      max_scale)
-            .render(d2d_dc);
+            .render_rasterized(d2d_dc, directions);
     }
     else
     {
@@ -615,7 +675,7 @@ void render_arrow(D2DSVG& arrow, TasklistButton& button, RECT window, float max_
                      render_arrow_height,
                      0.95f,
                      max_scale)
-            .render(d2d_dc);
+            .render_rasterized(d2d_dc, directions);
     }
 }
 
@@ -809,10 +869,10 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_device_context)
             }
         }
         // Finalize the overlay - dimm the buttons if no thumbnail is present and show "No active window"
-        use_overlay->toggle_window_group(miniature_shown || window_state == MINIMIZED);
-        if (!miniature_shown && window_state != MINIMIZED)
+        const bool window_group_active = miniature_shown || window_state == MINIMIZED;
+        if (!window_group_active)
         {
-            no_active.render(d2d_device_context);
+            no_active.render_rasterized(d2d_device_context);
             window_state = UNKNOWN;
         }
 
@@ -847,9 +907,7 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_device_context)
             }
             ++id;
         }
-        // Finally: render the overlay...
-        use_overlay->render(d2d_device_context);
-        // ... window arrows texts ...
+        // The window arrows texts and which keys are disabled...
         std::wstring left, right, up, down;
         bool left_disabled = false;
         bool right_disabled = false;
@@ -925,14 +983,21 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_device_context)
             down = GET_RESOURCE_STRING(IDS_NO_ACTION);
             down_disabled = true;
         }
+        // ... then render the overlay, from its rasterized layer unless keys are being animated ...
+        const auto overlay_state = apply_overlay_state(window_group_active, up_disabled, down_disabled, left_disabled, right_disabled);
+        if (key_animations.empty())
+        {
+            use_overlay->render_rasterized(d2d_device_context, overlay_state);
+        }
+        else
+        {
+            use_overlay->render(d2d_device_context);
+        }
+        // ... and the texts
         auto text_color = D2D1::ColorF(light_mode ? 0x222222 : 0xDDDDDD, active_window_snappable && (miniature_shown || window_state == MINIMIZED) ? 1.0f : 0.3f);
-        use_overlay->find_element(L"KeyUpGroup")->SetAttributeValue(L"fill-opacity", up_disabled ? 0.3f : 1.0f);
         text.set_alignment_center().write(d2d_device_context, text_color, use_overlay->get_maximize_label(), up);
-        use_overlay->find_element(L"KeyDownGroup")->SetAttributeValue(L"fill-opacity", down_disabled ? 0.3f : 1.0f);
         text.write(d2d_device_context, text_color, use_overlay->get_minimize_label(), down);
-        use_overlay->find_element(L"KeyLeftGroup")->SetAttributeValue(L"fill-opacity", left_disabled ? 0.3f : 1.0f);
         text.set_alignment_right().write(d2d_device_context, text_color, use_overlay->get_snap_left(), left);
-        use_overlay->find_element(L"KeyRightGroup")->SetAttributeValue(L"fill-opacity", right_disabled ? 0.3f : 1.0f);
         text.set_alignment_left().write(d2d_device_context, text_color, use_overlay->get_snap_right(), right);
     }
     else
@@ -944,4 +1009,12 @@ void D2DOverlayWindow::render(ID2D1DeviceContext5* d2d_device_context)
             global_windows_shortcuts_animation.reset();
         }
     }
+
+    if (show_key_down_time)
+    {
+        const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - *show_key_down_time).count();
+        Logger::info(L"First frame drawn {} ms after the key press, {} start", latency, show_warm ? L"warm" : L"cold");
+        Trace::SendShowLatency(latency, show_warm);
+        show_key_down_time.reset();
+    }
 }
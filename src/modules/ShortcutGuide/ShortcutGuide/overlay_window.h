@@ -8,6 +8,8 @@
 #include <common/themes/windows_colors.h>
 #include "tasklist_positions.h"
 
+#include <optional>
+
 struct ScaleResult
 {
     double scale;
@@ -47,7 +49,8 @@ struct AnimateKeys
 class D2DOverlayWindow : public D2DWindow
 {
 public:
-    D2DOverlayWindow();
+    // A resident overlay tracks the taskbar changes instead of walking its buttons on every show
+    explicit D2DOverlayWindow(bool resident = false);
     void show(HWND window, bool snappable);
     ~D2DOverlayWindow();
     void apply_overlay_opacity(float opacity);
@@ -55,6 +58,10 @@ public:
     void apply_press_time_for_taskbar_icon_shortcuts(int press_time);
     void set_theme(const std::wstring& theme);
     void quick_hide();
+    // Sizes the hidden window for the primary monitor and rasterizes the most used overlay layers
+    void prerender();
+    // Logs and sends the time from the key press to the first frame of the next show
+    void measure_show_latency(std::chrono::steady_clock::time_point key_down_time, bool warm);
 
     HWND get_window_handle();
     void SetWindowCloseType(std::wstring wCloseType)
@@ -72,6 +79,7 @@ private:
     virtual void on_show() override;
     virtual void on_hide() override;
     float get_overlay_opacity();
+    uint64_t apply_overlay_state(bool window_group_active, bool up_disabled, bool down_disabled, bool left_disabled, bool right_disabled);
 
     bool running = true;
     std::vector<AnimateKeys> key_animations;
@@ -101,6 +109,8 @@ private:
     D2DSVG no_active;
     std::vector<D2DSVG> arrows;
     std::chrono::steady_clock::time_point shown_start_time;
+    std::optional<std::chrono::steady_clock::time_point> show_key_down_time;
+    bool show_warm = false;
     float overlay_opacity = 0.9f;
     enum
     {
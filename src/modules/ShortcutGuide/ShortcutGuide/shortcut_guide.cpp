@@ -17,7 +17,7 @@
 #include <common/utils/winapi_error.h>
 #include <common/utils/window.h>
 #include <Psapi.h>
-#include <common/hooks/LowlevelKeyboardEvent.h>
+#include <common/hooks/LowlevelHookBroker.h>
 
 // TODO: refactor singleton
 OverlayWindow* overlay_window_instance = nullptr;
@@ -125,63 +125,66 @@ namespace
         return event.wParam == WM_KEYDOWN || event.wParam == WM_SYSKEYDOWN;
     }
 
-    LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+    bool LowLevelKeyboardProc(LowlevelKeyboardEvent& event)
     {
-        LowlevelKeyboardEvent event;
-        if (nCode == HC_ACTION)
+        if (event.lParam->vkCode == VK_ESCAPE)
         {
-            event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-            event.wParam = wParam;
+            Logger::trace(L"ESC key was pressed");
+            overlay_window_instance->CloseWindow(HideWindowType::ESC_PRESSED);
+        }
 
-            if (event.lParam->vkCode == VK_ESCAPE)
-            {
-                Logger::trace(L"ESC key was pressed");
-                overlay_window_instance->CloseWindow(HideWindowType::ESC_PRESSED);
-            }
+        if (wasWinPressed && !isKeyDown(event) && isWin(event.lParam->vkCode))
+        {
+            Logger::trace(L"Win key was released");
+            overlay_window_instance->CloseWindow(HideWindowType::WIN_RELEASED);
+        }
 
-            if (wasWinPressed && !isKeyDown(event) && isWin(event.lParam->vkCode))
-            {
-                Logger::trace(L"Win key was released");
-                overlay_window_instance->CloseWindow(HideWindowType::WIN_RELEASED);
-            }
+        if (isKeyDown(event) && isWin(event.lParam->vkCode))
+        {
+            wasWinPressed = true;
+        }
 
-            if (isKeyDown(event) && isWin(event.lParam->vkCode))
-            {
-                wasWinPressed = true;
-            }
+        if (onlyWinPressed() && isKeyDown(event) && !isWin(event.lParam->vkCode))
+        {
+            Logger::trace(L"Shortcut with win key was pressed");
+            overlay_window_instance->CloseWindow(HideWindowType::WIN_SHORTCUT_PRESSED);
+        }
+
+        return false;
+    }
 
-            if (onlyWinPressed() && isKeyDown(event) && !isWin(event.lParam->vkCode))
+    bool LowLevelMouseProc(WPARAM wParam, const MSLLHOOKSTRUCT& /*info*/)
+    {
+        switch (wParam)
+        {
+        case WM_LBUTTONUP:
+        case WM_RBUTTONUP:
+        case WM_MBUTTONUP:
+        case WM_XBUTTONUP:
+            // Don't close with mouse click if activation is windows key and the key is pressed
+            if (!overlay_window_instance->win_key_activation() || !isWinPressed())
             {
-                Logger::trace(L"Shortcut with win key was pressed");
-                overlay_window_instance->CloseWindow(HideWindowType::WIN_SHORTCUT_PRESSED);
+                overlay_window_instance->CloseWindow(HideWindowType::MOUSE_BUTTONUP);
             }
+            break;
+        default:
+            break;
         }
 
-        return CallNextHookEx(NULL, nCode, wParam, lParam);
+        return false;
     }
 
-    LRESULT CALLBACK LowLevelMouseProc(int nCode, WPARAM wParam, LPARAM lParam)
+    LRESULT CALLBACK ResidentWindowProc(HWND window, UINT message, WPARAM wParam, LPARAM lParam)
     {
-        if (nCode >= 0)
+        static const UINT toggleMessage = RegisterWindowMessageW(CommonSharedConstants::SHORTCUT_GUIDE_TOGGLE_MESSAGE);
+        if (message == toggleMessage && overlay_window_instance)
         {
-            switch (wParam)
-            {
-            case WM_LBUTTONUP:
-            case WM_RBUTTONUP:
-            case WM_MBUTTONUP:
-            case WM_XBUTTONUP:
-                // Don't close with mouse click if activation is windows key and the key is pressed
-                if (!overlay_window_instance->win_key_activation() || !isWinPressed())
-                {
-                    overlay_window_instance->CloseWindow(HideWindowType::MOUSE_BUTTONUP);
-                }
-                break;
-            default:
-                break;
-            }
+            const std::chrono::steady_clock::time_point keyDownTime{ std::chrono::steady_clock::duration{ lParam } };
+            overlay_window_instance->Toggle(keyDownTime, true);
+            return 0;
         }
 
-        return CallNextHookEx(0, nCode, wParam, lParam);
+        return DefWindowProc(window, message, wParam, lParam);
     }
 
     std::wstring ToWstring(HideWindowType type)
@@ -204,30 +207,111 @@ namespace
     }
 }
 
-OverlayWindow::OverlayWindow(HWND activeWindow)
+OverlayWindow::OverlayWindow(HWND activeWindow, bool resident)
 {
     overlay_window_instance = this;
     this->activeWindow = activeWindow;
+    this->resident = resident;
     app_name = GET_RESOURCE_STRING(IDS_SHORTCUT_GUIDE);
 
     Logger::info("Overlay Window is creating");
     init_settings();
-    keyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(NULL), NULL);
-    if (!keyboardHook)
+
+    if (resident)
     {
-        Logger::warn(L"Failed to create low level keyboard hook. {}", get_last_error_or_default(GetLastError()));
+        // The hooks are only installed while the overlay is shown
+        WNDCLASS wc = {};
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = CommonSharedConstants::SHORTCUT_GUIDE_RESIDENT_WINDOW_CLASS;
+        wc.lpfnWndProc = ResidentWindowProc;
+        RegisterClass(&wc);
+        residentWindow = CreateWindowExW(0, wc.lpszClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, wc.hInstance, nullptr);
+        if (!residentWindow)
+        {
+            Logger::error(L"Failed to create the resident window. {}", get_last_error_or_default(GetLastError()));
+        }
     }
+    else
+    {
+        install_hooks();
+    }
+}
 
-    mouseHook = SetWindowsHookEx(WH_MOUSE_LL, LowLevelMouseProc, GetModuleHandle(NULL), NULL);
-    if (!mouseHook)
+void OverlayWindow::ShowWindow(std::optional<std::chrono::steady_clock::time_point> keyDownTime, bool warm)
+{
+    install_hooks();
+    if (!winkey_popup && !create_popup())
     {
-        Logger::warn(L"Failed to create low level mouse hook. {}", get_last_error_or_default(GetLastError()));
+        return;
     }
+
+    apply_settings_to_popup();
+    if (keyDownTime)
+    {
+        winkey_popup->measure_show_latency(*keyDownTime, warm);
+    }
+
+    target_state->toggle_force_shown();
 }
 
-void OverlayWindow::ShowWindow()
+void OverlayWindow::Prewarm()
+{
+    if (!winkey_popup && !create_popup())
+    {
+        return;
+    }
+
+    try
+    {
+        winkey_popup->prerender();
+    }
+    catch (...)
+    {
+        Logger::warn("Failed to prerender the winkey popup");
+    }
+}
+
+void OverlayWindow::Toggle(std::chrono::steady_clock::time_point keyDownTime, bool warm)
+{
+    if (winkey_popup && target_state && target_state->active())
+    {
+        CloseWindow(HideWindowType::THE_SHORTCUT_PRESSED);
+        return;
+    }
+
+    // Pick up the settings changed since the last show
+    init_settings();
+    activeWindow = GetForegroundWindow();
+    if (IsDisabled())
+    {
+        Logger::trace("SG is disabled for the current foreground app");
+        return;
+    }
+
+    ShowWindow(keyDownTime, warm);
+}
+
+bool OverlayWindow::create_popup()
+{
+    winkey_popup = std::make_unique<D2DOverlayWindow>(resident);
+    apply_settings_to_popup();
+
+    target_state = std::make_unique<TargetState>();
+    try
+    {
+        winkey_popup->initialize();
+    }
+    catch (...)
+    {
+        Logger::critical("Winkey popup failed to initialize");
+        return false;
+    }
+
+    return true;
+}
+
+void OverlayWindow::apply_settings_to_popup()
 {
-    winkey_popup = std::make_unique<D2DOverlayWindow>();
     winkey_popup->apply_overlay_opacity(overlayOpacity.value / 100.0f);
     winkey_popup->set_theme(theme.value);
 
@@ -242,19 +326,44 @@ void OverlayWindow::ShowWindow()
         winkey_popup->apply_press_time_for_global_windows_shortcuts(0);
         winkey_popup->apply_press_time_for_taskbar_icon_shortcuts(0);
     }
+}
 
-    target_state = std::make_unique<TargetState>();
-    try
+void OverlayWindow::install_hooks()
+{
+    // The overlay only watches the input, so it observes the events before anything swallows them
+    if (!keyboardSubscription)
     {
-        winkey_popup->initialize();
+        wasWinPressed = false;
+        keyboardSubscription = LowlevelHookBroker::SubscribeKeyboard(L"ShortcutGuide", LowlevelHookBroker::Priority::Observer, LowLevelKeyboardProc);
+        if (!keyboardSubscription)
+        {
+            Logger::warn(L"Failed to create low level keyboard hook. {}", get_last_error_or_default(GetLastError()));
+        }
     }
-    catch (...)
+
+    if (!mouseSubscription)
     {
-        Logger::critical("Winkey popup failed to initialize");
-        return;
+        mouseSubscription = LowlevelHookBroker::SubscribeMouse(L"ShortcutGuide", LowlevelHookBroker::Priority::Observer, LowLevelMouseProc);
+        if (!mouseSubscription)
+        {
+            Logger::warn(L"Failed to create low level mouse hook. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+}
+
+void OverlayWindow::remove_hooks()
+{
+    if (keyboardSubscription)
+    {
+        LowlevelHookBroker::Unsubscribe(*keyboardSubscription);
+        keyboardSubscription.reset();
     }
 
-    target_state->toggle_force_shown();
+    if (mouseSubscription)
+    {
+        LowlevelHookBroker::Unsubscribe(*mouseSubscription);
+        mouseSubscription.reset();
+    }
 }
 
 void OverlayWindow::CloseWindow(HideWindowType type, int mainThreadId)
@@ -276,6 +385,19 @@ void OverlayWindow::CloseWindow(HideWindowType type, int mainThreadId)
             SendInput(1, dummyEvent, sizeof(INPUT));
         }
         this->winkey_popup->SetWindowCloseType(ToWstring(type));
+        if (resident)
+        {
+            // Called from the hooks or the toggle message, both on the main thread
+            Logger::trace(L"Hiding resident overlay");
+            remove_hooks();
+            if (target_state->active())
+            {
+                target_state->toggle_force_shown();
+            }
+            winkey_popup->hide();
+            return;
+        }
+
         Logger::trace(L"Terminating process");
         PostThreadMessage(mainThreadId, WM_QUIT, 0, 0);
     }
@@ -316,9 +438,11 @@ OverlayWindow::~OverlayWindow()
         winkey_popup.reset();
     }
 
-    if (keyboardHook)
+    remove_hooks();
+
+    if (residentWindow)
     {
-        UnhookWindowsHookEx(keyboardHook);
+        DestroyWindow(residentWindow);
     }
 }
 
@@ -501,5 +625,13 @@ ShortcutGuideSettings OverlayWindow::GetSettings() noexcept
     {
     }
 
+    try
+    {
+        settings.keepOverlayResident = properties.GetNamedObject(KeepOverlayResident::name).GetNamedBoolean(L"value");
+    }
+    catch (...)
+    {
+    }
+
     return settings;
 }
@@ -6,6 +6,8 @@
 #include "ShortcutGuideSettings.h"
 #include "ShortcutGuideConstants.h"
 
+#include <common/hooks/LowlevelHookBroker.h>
+
 #include "Generated Files/resource.h"
 
 // We support only one instance of the overlay
@@ -25,11 +27,18 @@ enum class HideWindowType
 class OverlayWindow
 {
 public:
-    OverlayWindow(HWND activeWindow);
-    void ShowWindow();
+    // A resident overlay keeps running hidden between activations: closing it only hides the popup,
+    // and the toggle message of its message-only window shows it again.
+    OverlayWindow(HWND activeWindow, bool resident = false);
+    void ShowWindow(std::optional<std::chrono::steady_clock::time_point> keyDownTime = std::nullopt, bool warm = false);
     void CloseWindow(HideWindowType type, int mainThreadId = 0);
     bool IsDisabled();
 
+    // Initializes the popup and rasterizes its layers ahead of the first show
+    void Prewarm();
+    // Hides the resident overlay if visible, otherwise shows it for the current foreground window
+    void Toggle(std::chrono::steady_clock::time_point keyDownTime, bool warm);
+
     void on_held();
     void quick_hide();
     void was_hidden();
@@ -52,9 +61,15 @@ private:
     std::vector<std::wstring> disabled_apps_array;
     void init_settings();
     void update_disabled_apps();
+    bool create_popup();
+    void apply_settings_to_popup();
+    void install_hooks();
+    void remove_hooks();
     HWND activeWindow;
-    HHOOK keyboardHook;
-    HHOOK mouseHook;
+    std::optional<LowlevelHookBroker::SubscriptionId> keyboardSubscription;
+    std::optional<LowlevelHookBroker::SubscriptionId> mouseSubscription;
+    bool resident = false;
+    HWND residentWindow = nullptr;
 
     struct OverlayOpacity
     {
@@ -103,4 +118,9 @@ private:
     {
         static inline PCWSTR name = L"open_shortcutguide";
     } openShortcut;
+
+    struct KeepOverlayResident
+    {
+        static inline PCWSTR name = L"keep_overlay_resident";
+    } keepOverlayResident;
 };
@@ -1,6 +1,93 @@
 #include "pch.h"
 #include "tasklist_positions.h"
 
+IFACEMETHODIMP TasklistChangeHandler::QueryInterface(REFIID riid, void** ppv)
+{
+    if (!ppv)
+    {
+        return E_POINTER;
+    }
+    if (riid == __uuidof(IUnknown) || riid == __uuidof(IUIAutomationStructureChangedEventHandler))
+    {
+        *ppv = static_cast<IUIAutomationStructureChangedEventHandler*>(this);
+    }
+    else if (riid == __uuidof(IUIAutomationPropertyChangedEventHandler))
+    {
+        *ppv = static_cast<IUIAutomationPropertyChangedEventHandler*>(this);
+    }
+    else
+    {
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+    AddRef();
+    return S_OK;
+}
+
+IFACEMETHODIMP_(ULONG) TasklistChangeHandler::AddRef()
+{
+    return ++ref_count;
+}
+
+IFACEMETHODIMP_(ULONG) TasklistChangeHandler::Release()
+{
+    auto count = --ref_count;
+    if (count == 0)
+    {
+        delete this;
+    }
+    return count;
+}
+
+IFACEMETHODIMP TasklistChangeHandler::HandleStructureChangedEvent(IUIAutomationElement*, StructureChangeType, SAFEARRAY*)
+{
+    is_changed = true;
+    return S_OK;
+}
+
+IFACEMETHODIMP TasklistChangeHandler::HandlePropertyChangedEvent(IUIAutomationElement*, PROPERTYID, VARIANT)
+{
+    is_changed = true;
+    return S_OK;
+}
+
+namespace
+{
+    bool add_change_handlers(TasklistChangeHandler* handler, HWND window, winrt::com_ptr<IUIAutomation>& automation, winrt::com_ptr<IUIAutomationElement>& element)
+    {
+        if (FAILED(CoCreateInstance(CLSID_CUIAutomation, nullptr, CLSCTX_INPROC_SERVER, IID_IUIAutomation, automation.put_void())) ||
+            FAILED(automation->ElementFromHandle(window, element.put())))
+        {
+            Logger::warn(L"Failed to get the taskbar element to track its changes");
+            return false;
+        }
+        const auto scope = static_cast<TreeScope>(TreeScope_Element | TreeScope_Children);
+        if (FAILED(automation->AddStructureChangedEventHandler(element.get(), scope, nullptr, handler)))
+        {
+            Logger::warn(L"Failed to track the taskbar buttons changes");
+            return false;
+        }
+        PROPERTYID bounding_rectangle = UIA_BoundingRectanglePropertyId;
+        if (FAILED(automation->AddPropertyChangedEventHandlerNativeArray(element.get(), scope, nullptr, handler, &bounding_rectangle, 1)))
+        {
+            Logger::warn(L"Failed to track the taskbar buttons positions");
+            automation->RemoveStructureChangedEventHandler(element.get(), handler);
+            return false;
+        }
+        return true;
+    }
+}
+
+Tasklist::Tasklist(bool track_changes_enabled) :
+    track_changes_enabled(track_changes_enabled)
+{
+}
+
+Tasklist::~Tasklist()
+{
+    stop_tracking_changes();
+}
+
 void Tasklist::update()
 {
     // Get HWND of the tasklist
@@ -24,19 +111,103 @@ void Tasklist::update()
                                               IID_IUIAutomation,
                                               automation.put_void()));
         winrt::check_hresult(automation->CreateTrueCondition(true_condition.put()));
+        // The properties of the buttons are fetched together with them, instead of one call each
+        winrt::check_hresult(automation->CreateCacheRequest(cache_request.put()));
+        winrt::check_hresult(cache_request->AddProperty(UIA_BoundingRectanglePropertyId));
+        winrt::check_hresult(cache_request->AddProperty(UIA_AutomationIdPropertyId));
     }
+    // The element and its change events are kept while the taskbar window is the same
+    if (element && tasklist_hwnd == tasklist_window)
+    {
+        return;
+    }
+    stop_tracking_changes();
     element = nullptr;
     winrt::check_hresult(automation->ElementFromHandle(tasklist_hwnd, element.put()));
+    tasklist_window = tasklist_hwnd;
+    if (track_changes_enabled)
+    {
+        track_changes();
+    }
+}
+
+void Tasklist::track_changes()
+{
+    auto handler = winrt::com_ptr<TasklistChangeHandler>();
+    handler.attach(new TasklistChangeHandler());
+    std::promise<bool> registered;
+    auto registered_future = registered.get_future();
+    stop_tracking = {};
+    tracking_thread = std::thread([handler, window = tasklist_window, registered = std::move(registered), stop = stop_tracking.get_future()]() mutable {
+        winrt::init_apartment(winrt::apartment_type::multi_threaded);
+        {
+            // The automation objects of this apartment are only used on this thread
+            winrt::com_ptr<IUIAutomation> events_automation;
+            winrt::com_ptr<IUIAutomationElement> events_element;
+            const bool added = add_change_handlers(handler.get(), window, events_automation, events_element);
+            registered.set_value(added);
+            if (added)
+            {
+                stop.wait();
+                events_automation->RemoveStructureChangedEventHandler(events_element.get(), handler.get());
+                events_automation->RemovePropertyChangedEventHandler(events_element.get(), handler.get());
+            }
+        }
+        winrt::uninit_apartment();
+    });
+
+    if (registered_future.get())
+    {
+        change_handler = std::move(handler);
+    }
+    else
+    {
+        tracking_thread.join();
+    }
+}
+
+void Tasklist::stop_tracking_changes()
+{
+    if (!change_handler)
+    {
+        return;
+    }
+    stop_tracking.set_value();
+    tracking_thread.join();
+    change_handler = nullptr;
+}
+
+bool Tasklist::changed() const
+{
+    return !change_handler || change_handler->changed();
 }
 
 bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
+{
+    // Changes reported during the walk need another one
+    if (change_handler)
+    {
+        change_handler->set_changed(false);
+    }
+    if (!find_buttons(buttons))
+    {
+        if (change_handler)
+        {
+            change_handler->set_changed(true);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Tasklist::find_buttons(std::vector<TasklistButton>& buttons)
 {
     if (!automation || !element)
     {
         return false;
     }
     winrt::com_ptr<IUIAutomationElementArray> elements;
-    if (element->FindAll(TreeScope_Children, true_condition.get(), elements.put()) < 0)
+    if (element->FindAllBuildCache(TreeScope_Children, true_condition.get(), cache_request.get(), elements.put()) < 0)
         return false;
     if (!elements)
         return false;
@@ -52,7 +223,7 @@ bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
         if (elements->GetElement(i, child.put()) < 0)
             return false;
         TasklistButton button;
-        if (VARIANT var_rect; child->GetCurrentPropertyValue(UIA_BoundingRectanglePropertyId, &var_rect) >= 0)
+        if (VARIANT var_rect; child->GetCachedPropertyValue(UIA_BoundingRectanglePropertyId, &var_rect) >= 0)
         {
             if (var_rect.vt == (VT_R8 | VT_ARRAY))
             {
@@ -77,7 +248,7 @@ bool Tasklist::update_buttons(std::vector<TasklistButton>& buttons)
         {
             return false;
         }
-        if (BSTR automation_id; child->get_CurrentAutomationId(&automation_id) >= 0)
+        if (BSTR automation_id; child->get_CachedAutomationId(&automation_id) >= 0)
         {
             button.name = automation_id;
             SysFreeString(automation_id);
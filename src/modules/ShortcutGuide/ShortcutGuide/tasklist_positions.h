@@ -1,4 +1,7 @@
 #pragma once
+#include <atomic>
+#include <future>
+#include <thread>
 #include <vector>
 #include <unordered_set>
 #include <string>
@@ -15,15 +18,57 @@ struct TasklistButton
     long keynum{};
 };
 
+// Marks the tasklist as changed when UI Automation reports its buttons were added, removed or moved
+class TasklistChangeHandler : public IUIAutomationStructureChangedEventHandler, public IUIAutomationPropertyChangedEventHandler
+{
+public:
+    // IUnknown
+    IFACEMETHODIMP QueryInterface(REFIID riid, void** ppv) override;
+    IFACEMETHODIMP_(ULONG) AddRef() override;
+    IFACEMETHODIMP_(ULONG) Release() override;
+
+    // IUIAutomationStructureChangedEventHandler
+    IFACEMETHODIMP HandleStructureChangedEvent(IUIAutomationElement* sender, StructureChangeType change_type, SAFEARRAY* runtime_id) override;
+
+    // IUIAutomationPropertyChangedEventHandler
+    IFACEMETHODIMP HandlePropertyChangedEvent(IUIAutomationElement* sender, PROPERTYID property_id, VARIANT new_value) override;
+
+    bool changed() const { return is_changed.load(); }
+    void set_changed(bool value) { is_changed = value; }
+
+private:
+    std::atomic<ULONG> ref_count = 1;
+    std::atomic_bool is_changed = true;
+};
+
 class Tasklist
 {
 public:
+    // Without tracking the changes the buttons are walked on every update, which is enough
+    // for an overlay that is only shown once
+    explicit Tasklist(bool track_changes_enabled = false);
+    ~Tasklist();
     void update();
     std::vector<TasklistButton> get_buttons();
     bool update_buttons(std::vector<TasklistButton>& buttons);
+    // True if the buttons may have changed since they were last updated
+    bool changed() const;
 
 private:
+    bool find_buttons(std::vector<TasklistButton>& buttons);
+    void track_changes();
+    void stop_tracking_changes();
+
     winrt::com_ptr<IUIAutomation> automation;
     winrt::com_ptr<IUIAutomationElement> element;
     winrt::com_ptr<IUIAutomationCondition> true_condition;
+    winrt::com_ptr<IUIAutomationCacheRequest> cache_request;
+    HWND tasklist_window = nullptr;
+    bool track_changes_enabled = false;
+    // Null when the change events aren't registered, then the buttons are always updated
+    winrt::com_ptr<TasklistChangeHandler> change_handler;
+    // UI Automation event handlers must not be added or removed on a UI thread. They are
+    // registered on this MTA thread, which removes them when stop_tracking is set.
+    std::thread tracking_thread;
+    std::promise<void> stop_tracking;
 };
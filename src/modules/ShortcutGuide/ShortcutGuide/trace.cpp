@@ -34,6 +34,19 @@ void Trace::SendSettings(ShortcutGuideSettings settings) noexcept
         TraceLoggingBoolean(settings.shouldReactToPressedWinKey, "ShouldReactToPressedWinKey"),
         TraceLoggingInt32(settings.windowsKeyPressTimeForGlobalWindowsShortcuts, "WindowsKeyPressTimeForGlobalWindowsShortcuts"),
         TraceLoggingInt32(settings.windowsKeyPressTimeForTaskbarIconShortcuts, "WindowsKeyPressTimeForTaskbarIconShortcuts"),
+        TraceLoggingBoolean(settings.keepOverlayResident, "KeepOverlayResident"),
+        ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
+        TraceLoggingBoolean(TRUE, "UTCReplace_AppSessionGuid"),
+        TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE));
+}
+
+void Trace::SendShowLatency(const __int64 latency_ms, const bool warm) noexcept
+{
+    TraceLoggingWriteWrapper(
+        g_hProvider,
+        "ShortcutGuide_ShowLatency",
+        TraceLoggingInt64(latency_ms, "LatencyInMs"),
+        TraceLoggingBoolean(warm, "Warm"),
         ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
         TraceLoggingBoolean(TRUE, "UTCReplace_AppSessionGuid"),
         TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE));
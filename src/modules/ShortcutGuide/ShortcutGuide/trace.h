@@ -8,4 +8,5 @@ class Trace : public telemetry::TraceBase
 public:
     static void SendGuideSession(const __int64 duration_ms, const wchar_t* close_type) noexcept;
     static void SendSettings(ShortcutGuideSettings settings) noexcept;
+    static void SendShowLatency(const __int64 latency_ms, const bool warm) noexcept;
 };
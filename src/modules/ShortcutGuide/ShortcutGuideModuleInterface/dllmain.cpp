@@ -1,6 +1,7 @@
 // dllmain.cpp : Defines the entry point for the DLL application.
 #include "pch.h"
 
+#include <chrono>
 #include <mutex>
 #include <common/SettingsAPI/settings_helpers.h>
 #include <common/utils/winapi_error.h>
@@ -77,6 +78,7 @@ public:
                 PowerToysSettings::PowerToyValues::from_json_string(config, get_key());
 
             ParseSettings(values);
+            UpdateResidentProcess();
         }
         catch (std::exception& ex)
         {
@@ -91,6 +93,7 @@ public:
         if (!_enabled)
         {
             _enabled = true;
+            UpdateResidentProcess();
         }
         else
         {
@@ -146,9 +149,17 @@ public:
             return;
         }
 
+        const auto keyDownTime = GetKeyDownTime();
         if (IsProcessActive())
         {
-            TerminateProcess();
+            if (m_processIsResident)
+            {
+                ToggleResidentOverlay(keyDownTime);
+            }
+            else
+            {
+                TerminateProcess();
+            }
             return;
         }
 
@@ -158,7 +169,8 @@ public:
             m_hProcess = nullptr;
         }
 
-        StartProcess();
+        const auto keyDownTicks = std::to_wstring(keyDownTime.time_since_epoch().count());
+        StartProcess(m_keepResident ? L"resident " + keyDownTicks : keyDownTicks);
     }
 
     virtual void send_settings_telemetry() override
@@ -197,6 +209,10 @@ private:
     UINT m_millisecondsWinKeyPressTimeForGlobalWindowsShortcuts = DEFAULT_MILLISECONDS_WIN_KEY_PRESS_TIME_FOR_GLOBAL_WINDOWS_SHORTCUTS;
     UINT m_millisecondsWinKeyPressTimeForTaskbarIconShortcuts = DEFAULT_MILLISECONDS_WIN_KEY_PRESS_TIME_FOR_TASKBAR_ICON_SHORTCUTS;
 
+    // Keep the overlay process running between activations, so showing it only toggles its window
+    bool m_keepResident = false;
+    bool m_processIsResident = false;
+
     HANDLE triggerEvent;
     HANDLE exitEvent;
     EventWaiter triggerEventWaiter;
@@ -235,7 +251,19 @@ private:
         }
 
         Logger::trace(L"Started SG process with pid={}", GetProcessId(sei.hProcess));
+        if (args == L"telemetry")
+        {
+            // Don't lose track of a running overlay process
+            CloseHandle(sei.hProcess);
+            return true;
+        }
+
+        if (m_hProcess)
+        {
+            CloseHandle(m_hProcess);
+        }
         m_hProcess = sei.hProcess;
+        m_processIsResident = args.starts_with(L"resident");
         return true;
     }
 
@@ -268,6 +296,49 @@ private:
         return m_hProcess && WaitForSingleObject(m_hProcess, 0) != WAIT_OBJECT_0;
     }
 
+    // Time of the key press that invoked the module. steady_clock reads QueryPerformanceCounter,
+    // so the overlay process can compare it with its own clock to measure the show latency.
+    std::chrono::steady_clock::time_point GetKeyDownTime()
+    {
+        auto time = std::chrono::steady_clock::now();
+        if (m_shouldReactToPressedWinKey)
+        {
+            // The runner invokes the module once the win key was held long enough
+            time -= std::chrono::milliseconds(milliseconds_win_key_must_be_pressed());
+        }
+        return time;
+    }
+
+    void ToggleResidentOverlay(std::chrono::steady_clock::time_point keyDownTime)
+    {
+        static const UINT toggleMessage = RegisterWindowMessageW(CommonSharedConstants::SHORTCUT_GUIDE_TOGGLE_MESSAGE);
+        HWND window = FindWindowExW(HWND_MESSAGE, nullptr, CommonSharedConstants::SHORTCUT_GUIDE_RESIDENT_WINDOW_CLASS, nullptr);
+        if (!window || !PostMessageW(window, toggleMessage, 0, static_cast<LPARAM>(keyDownTime.time_since_epoch().count())))
+        {
+            // Still starting, the press is dropped rather than starting a second process
+            Logger::warn(L"Failed to toggle the resident SG process. {}", get_last_error_or_default(GetLastError()));
+        }
+    }
+
+    // Starts or stops the resident overlay process to follow the settings
+    void UpdateResidentProcess()
+    {
+        if (!_enabled)
+        {
+            return;
+        }
+
+        if (m_keepResident && !IsProcessActive())
+        {
+            StartProcess(L"resident");
+        }
+        else if (!m_keepResident && m_processIsResident)
+        {
+            TerminateProcess();
+            m_processIsResident = false;
+        }
+    }
+
     void InitSettings()
     {
         try
@@ -290,6 +361,7 @@ private:
     void ParseSettings(PowerToysSettings::PowerToyValues& settings)
     {
         m_shouldReactToPressedWinKey = false;
+        m_keepResident = false;
         m_millisecondsWinKeyPressTimeForGlobalWindowsShortcuts = DEFAULT_MILLISECONDS_WIN_KEY_PRESS_TIME_FOR_GLOBAL_WINDOWS_SHORTCUTS;
         m_millisecondsWinKeyPressTimeForTaskbarIconShortcuts = DEFAULT_MILLISECONDS_WIN_KEY_PRESS_TIME_FOR_TASKBAR_ICON_SHORTCUTS;
 
@@ -358,6 +430,14 @@ private:
             {
                 Logger::warn("Failed to get legacy win key behavior settings");
             }
+            try
+            {
+                m_keepResident = settingsObject.GetNamedObject(L"properties").GetNamedObject(L"keep_overlay_resident").GetNamedBoolean(L"value");
+            }
+            catch (...)
+            {
+                // Settings saved before the option existed
+            }
         }
         else
         {
@@ -10,12 +10,44 @@
 #include <AppLauncher.h>
 #include <WorkspacesLib/AppUtils.h>
 
+#include <filesystem>
+
+namespace NonLocalizable
+{
+    const std::wstring OutlookFilename = L"outlook.exe";
+}
+
+namespace
+{
+    constexpr std::chrono::milliseconds MaxWaitTime{ 3000 };
+
+    // Resolves an issue when Outlook does not launch when launching one after another.
+    // Launching Outlook instances right one after another causes error message.
+    // Launching Outlook instances with less than 1-second delay causes the second window not to appear
+    // even though there wasn't a launch error.
+    constexpr std::chrono::milliseconds ConflictingAppDelay{ 1000 };
+
+    bool IsSameApp(const WorkspacesData::WorkspacesProject::Application& first, const WorkspacesData::WorkspacesProject::Application& second)
+    {
+        return first.name == second.name || first.path == second.path;
+    }
+
+    // Apps that can't be launched next to each other, they're serialized with the delay in between.
+    bool IsConflictingApp(const WorkspacesData::WorkspacesProject::Application& app)
+    {
+        std::wstring filename = std::filesystem::path(app.path).filename();
+        return _wcsicmp(filename.c_str(), NonLocalizable::OutlookFilename.c_str()) == 0;
+    }
+}
+
 Launcher::Launcher(const WorkspacesData::WorkspacesProject& project, 
     std::vector<WorkspacesData::WorkspacesProject>& workspaces,
-    InvokePoint invokePoint) :
+    InvokePoint invokePoint,
+    unsigned int maxParallelLaunches) :
     m_project(project),
     m_workspaces(workspaces),
     m_invokePoint(invokePoint),
+    m_maxParallelLaunches((std::max)(1u, maxParallelLaunches)),
     m_start(std::chrono::high_resolution_clock::now()),
     m_uiHelper(std::make_unique<LauncherUIHelper>(std::bind(&Launcher::handleUIMessage, this, std::placeholders::_1))),
     m_windowArrangerHelper(std::make_unique<WindowArrangerHelper>(std::bind(&Launcher::handleWindowArrangerMessage, this, std::placeholders::_1))),
@@ -97,41 +129,102 @@ Launcher::~Launcher()
 
 void Launcher::Launch() // Launching thread
 {
-    const long maxWaitTimeMs = 3000;
-    const long ms = 100;
-
-    // Launch apps
-    for (auto appState = m_launchingStatus.GetNext(LaunchingState::Waiting);appState.has_value();appState = m_launchingStatus.GetNext(LaunchingState::Waiting))
+    // Split apps into sequences. Instances of the same app are launched one after another,
+    // each waiting for the previous one to be moved. Conflicting apps share a single sequence.
+    // Independent sequences are launched concurrently.
+    std::vector<std::vector<WorkspacesData::WorkspacesProject::Application>> sequences;
+    std::vector<WorkspacesData::WorkspacesProject::Application> conflictingApps;
+    for (const auto& app : m_project.apps)
     {
-        auto app = appState.value().application;
-        
-        long waitingTime = 0;
-        bool additionalWait = false;
-        while (!m_launchingStatus.AllInstancesOfTheAppLaunchedAndMoved(app) && waitingTime < maxWaitTimeMs)
+        if (IsConflictingApp(app))
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-            waitingTime += ms;
-            additionalWait = true;
+            conflictingApps.push_back(app);
+            continue;
         }
 
-        if (additionalWait)
+        // An app can match sequences that don't match each other (the name of one and the path
+        // of another), those are merged so that no two instances of the same app race.
+        std::vector<WorkspacesData::WorkspacesProject::Application> sequence;
+        std::erase_if(sequences, [&](std::vector<WorkspacesData::WorkspacesProject::Application>& apps) {
+            if (std::none_of(apps.begin(), apps.end(), [&](const WorkspacesData::WorkspacesProject::Application& other) { return IsSameApp(other, app); }))
+            {
+                return false;
+            }
+
+            sequence.insert(sequence.end(), apps.begin(), apps.end());
+            return true;
+        });
+
+        sequence.push_back(app);
+        sequences.push_back(std::move(sequence));
+    }
+
+    if (!conflictingApps.empty())
+    {
+        // start the slowest sequence first
+        sequences.insert(sequences.begin(), conflictingApps);
+    }
+
+    std::atomic<size_t> nextSequence{ 0 };
+    auto worker = [&]() {
+        for (size_t index = nextSequence++; index < sequences.size(); index = nextSequence++)
         {
-            // Resolves an issue when Outlook does not launch when launching one after another.
-            // Launching Outlook instances right one after another causes error message.
-            // Launching Outlook instances with less than 1-second delay causes the second window not to appear
-            // even though there wasn't a launch error.
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+            LaunchSequence(sequences[index]);
         }
+    };
+
+    const size_t workersCount = (std::min<size_t>)(m_maxParallelLaunches, sequences.size());
+    Logger::trace(L"Launching {} apps in {} sequences, {} at a time", m_project.apps.size(), sequences.size(), workersCount);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workersCount; i++)
+    {
+        workers.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+}
 
-        if (waitingTime >= maxWaitTimeMs)
+void Launcher::LaunchSequence(const std::vector<WorkspacesData::WorkspacesProject::Application>& apps) // Launching worker thread
+{
+    for (size_t i = 0; i < apps.size(); i++)
+    {
+        const auto& app = apps[i];
+        auto waitStart = std::chrono::high_resolution_clock::now();
+
+        // Instances of the same app are still spaced when the previous one had to be waited for
+        const bool waited = !m_launchingStatus.AllInstancesOfTheAppLaunchedAndMoved(app);
+        if (waited && !m_launchingStatus.WaitForAllInstancesOfTheAppLaunchedAndMoved(app, MaxWaitTime))
         {
             Logger::info(L"Waiting time for launching next {} instance expired", app.name);
         }
 
-        bool launched{ false };
+        if (waited || (i > 0 && IsConflictingApp(app)))
+        {
+            std::this_thread::sleep_for(ConflictingAppDelay);
+        }
+
+        // skip the apps canceled while waiting
+        auto currentStatus = m_launchingStatus.Get(app);
+        if (!currentStatus.has_value() || currentStatus.value().state != LaunchingState::Waiting)
+        {
+            continue;
+        }
+
+        auto launchStart = std::chrono::high_resolution_clock::now();
+        AppLauncher::ErrorList launchErrors{};
+        bool launched = AppLauncher::Launch(app, launchErrors);
+        auto launchEnd = std::chrono::high_resolution_clock::now();
+
+        if (!launchErrors.empty())
         {
             std::lock_guard lock(m_launchErrorsMutex);
-            launched = AppLauncher::Launch(app, m_launchErrors);
+            m_launchErrors.insert(m_launchErrors.end(), launchErrors.begin(), launchErrors.end());
         }
 
         if (launched)
@@ -145,6 +238,11 @@ void Launcher::Launch() // Launching thread
             m_launchedSuccessfully = false;
         }
 
+        std::chrono::duration<double> waitTime = launchStart - waitStart;
+        std::chrono::duration<double> launchTime = launchEnd - launchStart;
+        Logger::trace(L"{} waited {} s, launched in {} s", app.name, waitTime.count(), launchTime.count());
+        Trace::Workspaces::AppLaunch(launched, app.isElevated, waitTime.count(), launchTime.count());
+
         auto status = m_launchingStatus.Get(app); // updated after launch status 
         if (status.has_value())
         {
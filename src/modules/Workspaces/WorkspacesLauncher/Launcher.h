@@ -11,13 +11,17 @@
 class Launcher
 {
 public:
-    Launcher(const WorkspacesData::WorkspacesProject& project, std::vector<WorkspacesData::WorkspacesProject>& workspaces, InvokePoint invokePoint);
+    // Number of independent apps launched at the same time.
+    static constexpr unsigned int DefaultMaxParallelLaunches = 4;
+
+    Launcher(const WorkspacesData::WorkspacesProject& project, std::vector<WorkspacesData::WorkspacesProject>& workspaces, InvokePoint invokePoint, unsigned int maxParallelLaunches = DefaultMaxParallelLaunches);
     ~Launcher();
 
 private:
     WorkspacesData::WorkspacesProject m_project;
     std::vector<WorkspacesData::WorkspacesProject>& m_workspaces;
     const InvokePoint m_invokePoint;
+    const unsigned int m_maxParallelLaunches;
     const std::chrono::steady_clock::time_point m_start;
     std::atomic<bool> m_launchedSuccessfully{};
     LaunchingStatus m_launchingStatus;
@@ -32,6 +36,7 @@ private:
     std::mutex m_launchErrorsMutex;
 
     void Launch();
+    void LaunchSequence(const std::vector<WorkspacesData::WorkspacesProject::Application>& apps);
     void handleWindowArrangerMessage(const std::wstring& msg);
     void handleUIMessage(const std::wstring& msg);
 };
@@ -0,0 +1,74 @@
+#include "pch.h"
+
+#include <WorkspacesWindowArranger/WindowAttributesCache.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace WorkspacesLibUnitTests
+{
+    TEST_CLASS (WindowAttributesCacheTests)
+    {
+        const HWND m_window = reinterpret_cast<HWND>(0x1234);
+
+        static WindowAttributes Resolved()
+        {
+            return WindowAttributes{ .pid = 2,
+                                     .processPath = L"C:\\Program Files\\WindowsApps\\Microsoft.WindowsCalculator\\CalculatorApp.exe",
+                                     .title = L"Calculator",
+                                     .appData = Utils::Apps::AppData{ .name = L"Calculator" } };
+        }
+
+    public:
+        TEST_METHOD (ApplicationFrameHostIsCollectedAgain)
+        {
+            // A UWP window that was just launched belongs to ApplicationFrameHost until its CoreWindow is attached
+            std::vector<WindowAttributes> results = {
+                WindowAttributes{ .pid = 1, .processPath = L"C:\\Windows\\System32\\ApplicationFrameHost.exe", .title = L"Calculator" },
+                Resolved(),
+            };
+            size_t calls = 0;
+            WindowAttributesCache cache([&](HWND) { return results[(std::min)(calls++, results.size() - 1)]; });
+
+            Assert::IsFalse(cache.Get(m_window).appData.has_value());
+            Assert::AreEqual(std::wstring(L"Calculator"), cache.Get(m_window).appData->name);
+            Assert::AreEqual(size_t{ 2 }, calls);
+
+            // Resolved attributes are collected once
+            Assert::AreEqual(std::wstring(L"Calculator"), cache.Get(m_window).appData->name);
+            Assert::AreEqual(size_t{ 2 }, calls);
+        }
+
+        TEST_METHOD (UnresolvedAttributesAreNotCached)
+        {
+            size_t calls = 0;
+            WindowAttributesCache cache([&](HWND) {
+                calls++;
+                return WindowAttributes{ .pid = 3, .processPath = L"C:\\Tools\\unknown.exe" };
+            });
+
+            cache.Get(m_window);
+            cache.Get(m_window);
+            Assert::AreEqual(size_t{ 2 }, calls);
+
+            Assert::IsFalse(WindowAttributesCache::IsResolved(WindowAttributes{}));
+            Assert::IsTrue(WindowAttributesCache::IsResolved(Resolved()));
+        }
+
+        TEST_METHOD (InvalidateCollectsAgain)
+        {
+            size_t calls = 0;
+            WindowAttributesCache cache([&](HWND) {
+                calls++;
+                return Resolved();
+            });
+
+            cache.Get(m_window);
+            cache.Get(m_window);
+            Assert::AreEqual(size_t{ 1 }, calls);
+
+            cache.Invalidate(m_window);
+            cache.Get(m_window);
+            Assert::AreEqual(size_t{ 2 }, calls);
+        }
+    };
+}
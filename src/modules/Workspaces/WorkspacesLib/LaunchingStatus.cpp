@@ -45,7 +45,17 @@ bool LaunchingStatus::AllLaunchedAndMoved() noexcept
 bool LaunchingStatus::AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& application) noexcept
 {
     std::shared_lock lock(m_mutex);
+    return AllInstancesOfTheAppLaunchedAndMovedUnsafe(application);
+}
 
+bool LaunchingStatus::WaitForAllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& application, std::chrono::milliseconds timeout) noexcept
+{
+    std::shared_lock lock(m_mutex);
+    return m_stateChanged.wait_for(lock, timeout, [&] { return AllInstancesOfTheAppLaunchedAndMovedUnsafe(application); });
+}
+
+bool LaunchingStatus::AllInstancesOfTheAppLaunchedAndMovedUnsafe(const WorkspacesData::WorkspacesProject::Application& application) const noexcept
+{
     for (const auto& [app, state] : m_appsState)
     {
         if (app.name == application.name || app.path == application.path)
@@ -60,7 +70,7 @@ bool LaunchingStatus::AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData:
     return true;
 }
 
-const WorkspacesData::LaunchingAppStateMap& LaunchingStatus::Get() noexcept
+WorkspacesData::LaunchingAppStateMap LaunchingStatus::Get() noexcept
 {
     std::shared_lock lock(m_mutex);
     return m_appsState;
@@ -116,6 +126,8 @@ void LaunchingStatus::Update(const WorkspacesData::WorkspacesProject::Applicatio
     }
 
     m_appsState[app].state = state;
+    lock.unlock();
+    m_stateChanged.notify_all();
 }
 
 void LaunchingStatus::Update(const WorkspacesData::WorkspacesProject::Application& app, HWND window, LaunchingState state)
@@ -129,6 +141,8 @@ void LaunchingStatus::Update(const WorkspacesData::WorkspacesProject::Applicatio
 
     m_appsState[app].state = state;
     m_appsState[app].window = window;
+    lock.unlock();
+    m_stateChanged.notify_all();
 }
 
 void LaunchingStatus::Cancel()
@@ -141,4 +155,7 @@ void LaunchingStatus::Cancel()
             state.state = LaunchingState::Canceled;
         }
     }
+
+    lock.unlock();
+    m_stateChanged.notify_all();
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <shared_mutex>
 
 #include <WorkspacesLib/WorkspacesData.h>
@@ -14,7 +16,12 @@ public:
     bool AllLaunchedAndMoved() noexcept;
     bool AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& app) noexcept;
 
-    const WorkspacesData::LaunchingAppStateMap& Get() noexcept;
+    // Blocks until every instance of the app is moved (or failed/canceled) or the timeout expires.
+    // Woken up by state updates instead of polling. Returns false on timeout.
+    bool WaitForAllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& app, std::chrono::milliseconds timeout) noexcept;
+
+    // Returns a copy, the states keep changing on other threads
+    WorkspacesData::LaunchingAppStateMap Get() noexcept;
     std::optional<WorkspacesData::LaunchingAppState> Get(const WorkspacesData::WorkspacesProject::Application& app) noexcept;
     std::optional<WorkspacesData::LaunchingAppState> GetNext(LaunchingState state) noexcept;
     
@@ -27,4 +34,7 @@ public:
 private:
     WorkspacesData::LaunchingAppStateMap m_appsState;
     std::shared_mutex m_mutex;
+    std::condition_variable_any m_stateChanged;
+
+    bool AllInstancesOfTheAppLaunchedAndMovedUnsafe(const WorkspacesData::WorkspacesProject::Application& app) const noexcept;
 };
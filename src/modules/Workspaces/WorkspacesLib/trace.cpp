@@ -83,3 +83,20 @@ void Trace::Workspaces::Launch(bool success,
         TraceLoggingWideString(errorStr.c_str(), "failures") // List of errors encountered when applicable. Collects .exe name and error message in String fields
         );
 }
+
+void Trace::Workspaces::AppLaunch(bool success,
+    bool isElevated,
+    double waitTimeSeconds,
+    double launchTimeSeconds) noexcept
+{
+    TraceLoggingWriteWrapper(
+        g_hProvider,
+        "Workspaces_AppLaunchEvent",
+        ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
+        TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE),
+        TraceLoggingBoolean(success, "successful"), // True if the app was launched successfully.
+        TraceLoggingBoolean(isElevated, "elevated"), // True if the app was launched as admin.
+        TraceLoggingFloat64(waitTimeSeconds, "waitTime"), // The time, in seconds, the app waited for previous instances of the same app to be moved.
+        TraceLoggingFloat64(launchTimeSeconds, "launchTime") // The time, in seconds, the launch call itself took.
+        );
+}
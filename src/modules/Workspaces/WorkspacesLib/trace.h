@@ -20,5 +20,9 @@ public:
                            double launchTimeSeconds,
                            bool setupIsDifferent,
                            const std::vector<std::pair<std::wstring, std::wstring>> errors) noexcept;
+        static void AppLaunch(bool success,
+                              bool isElevated,
+                              double waitTimeSeconds,
+                              double launchTimeSeconds) noexcept;
     };
 };
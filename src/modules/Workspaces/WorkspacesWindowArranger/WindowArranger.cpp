@@ -3,7 +3,6 @@
 
 #include <common/logger/logger.h>
 #include <common/utils/OnThreadExecutor.h>
-#include <common/utils/process_path.h>
 #include <common/utils/winapi_error.h>
 
 #include <workspaces-common/MonitorUtils.h>
@@ -12,13 +11,41 @@
 #include <workspaces-common/WindowUtils.h>
 
 #include <WindowProperties/WorkspacesWindowPropertyUtils.h>
-#include <WorkspacesLib/PwaHelper.h>
 
 namespace NonLocalizable
 {
     const std::wstring ApplicationFrameHost = L"ApplicationFrameHost.exe";
 }
 
+namespace
+{
+    void ResolvePwa(HWND window, Utils::Apps::AppData& appData, std::unique_ptr<Utils::PwaHelper>& pwaHelper)
+    {
+        bool isEdge = appData.IsEdge();
+        bool isChrome = appData.IsChrome();
+        if (!isEdge && !isChrome)
+        {
+            return;
+        }
+
+        if (!pwaHelper)
+        {
+            pwaHelper = std::make_unique<Utils::PwaHelper>();
+        }
+
+        auto windowAumid = pwaHelper->GetAUMIDFromWindow(window);
+        std::optional<std::wstring> pwaAppId = isEdge ? pwaHelper->GetEdgeAppId(windowAumid) : pwaHelper->GetChromeAppId(windowAumid);
+        if (pwaAppId.has_value())
+        {
+            auto pwaName = pwaHelper->SearchPwaName(pwaAppId.value(), windowAumid);
+            Logger::info(L"Found {} PWA app with name {}, appId: {}", (isEdge ? L"Edge" : L"Chrome"), pwaName, pwaAppId.value());
+
+            appData.pwaAppId = pwaAppId.value();
+            appData.name = pwaName + L" (" + appData.name + L")";
+        }
+    }
+}
+
 namespace PlacementHelper
 {
     // When calculating the coordinates difference (== 'distance') between 2 windows, there are additional values added to the real distance
@@ -155,126 +182,124 @@ bool WindowArranger::TryMoveWindow(const WorkspacesData::WorkspacesProject::Appl
     return success;
 }
 
-std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& movedWindows, Utils::PwaHelper& pwaHelper)
+std::map<WorkspacesData::WorkspacesProject::Application, std::vector<HWND>> WindowArranger::GetCandidateWindows()
 {
-    std::optional<Utils::Apps::AppData> appDataNearest = std::nullopt;
-    WindowWithDistance nearestWindowWithDistance{};
-
+    std::vector<WindowAttributes> attributes{};
+    std::unordered_map<std::wstring, std::vector<size_t>> windowsByTitle{};
+    attributes.reserve(m_windowsBefore.size());
     for (HWND window : m_windowsBefore)
     {
-        if (WindowFilter::FilterPopup(window))
-        {
-            continue;
-        }
+        attributes.push_back(m_windowAttributes.Get(window));
+        windowsByTitle[attributes.back().title].push_back(attributes.size() - 1);
+    }
 
-        if (std::find(movedWindows.begin(), movedWindows.end(), window) != movedWindows.end())
-        {
-            continue;
-        }
+    // bucket the windows by app name and path once, so each app only looks at its own windows
+    std::vector<std::optional<Utils::Apps::AppData>> windowApps(m_windowsBefore.size());
+    std::unordered_map<std::wstring, std::vector<size_t>> windowsByName{};
+    std::unordered_map<std::wstring, std::vector<size_t>> windowsByPath{};
+    std::unique_ptr<Utils::PwaHelper> pwaHelper{};
 
-        std::wstring processPath = get_process_path(window);
-        if (processPath.empty())
+    for (size_t i = 0; i < m_windowsBefore.size(); i++)
+    {
+        HWND window = m_windowsBefore[i];
+        if (attributes[i].processPath.empty() || WindowFilter::FilterPopup(window))
         {
             continue;
         }
 
-        DWORD pid{};
-        GetWindowThreadProcessId(window, &pid);
-        std::wstring title = WindowUtils::GetWindowTitle(window);
+        auto appData = attributes[i].appData;
 
         // fix for the packaged apps that are not caught when minimized, e.g. Settings, Microsoft ToDo, ...
-        if (processPath.ends_with(NonLocalizable::ApplicationFrameHost))
+        if (attributes[i].processPath.ends_with(NonLocalizable::ApplicationFrameHost))
         {
-            for (auto otherWindow : m_windowsBefore)
+            // searching for the window with the same title but different PID
+            for (size_t other : windowsByTitle[attributes[i].title])
             {
-                DWORD otherPid{};
-                GetWindowThreadProcessId(otherWindow, &otherPid);
-
-                // searching for the window with the same title but different PID
-                if (pid != otherPid && title == WindowUtils::GetWindowTitle(otherWindow))
+                if (attributes[other].pid != attributes[i].pid)
                 {
-                    processPath = get_process_path(otherPid);
+                    appData = Utils::Apps::GetApp(attributes[other].processPath, attributes[i].pid, m_installedApps);
                     break;
                 }
             }
         }
 
-        auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps);
-
-        if (!data->IsSteamGame() && !WindowUtils::HasThickFrame(window))
+        if (!appData.has_value())
         {
-            // Only care about steam games if it has no thick frame to remain consistent with 
-            // the behavior as before.
             continue;
         }
 
-        if (!data.has_value())
+        if (!appData->IsSteamGame() && !WindowUtils::HasThickFrame(window))
         {
+            // Only care about steam games if it has no thick frame to remain consistent with
+            // the behavior as before.
             continue;
         }
 
-        auto appData = data.value();
+        ResolvePwa(window, appData.value(), pwaHelper);
+        windowsByName[appData->name].push_back(i);
+        windowsByPath[appData->installPath].push_back(i);
+        windowApps[i] = std::move(appData);
+    }
 
-        // PWA apps
-        bool isEdge = appData.IsEdge();
-        bool isChrome = appData.IsChrome();
-        if (isEdge || isChrome)
+    std::map<WorkspacesData::WorkspacesProject::Application, std::vector<HWND>> result{};
+    for (const auto& app : m_project.apps)
+    {
+        std::vector<size_t> indexes{};
+        if (auto iter = windowsByName.find(app.name); iter != windowsByName.end())
         {
-            auto windowAumid = pwaHelper.GetAUMIDFromWindow(window);
-            std::optional<std::wstring> pwaAppId{};
-
-            if (isEdge)
-            {
-                pwaAppId = pwaHelper.GetEdgeAppId(windowAumid);
-            }
-            else if (isChrome)
-            {
-                pwaAppId = pwaHelper.GetChromeAppId(windowAumid);
-            }
-
-            if (pwaAppId.has_value())
-            {
-                auto pwaName = pwaHelper.SearchPwaName(pwaAppId.value(), windowAumid);
-                Logger::info(L"Found {} PWA app with name {}, appId: {}", (isEdge ? L"Edge" : (isChrome ? L"Chrome" : L"unknown")), pwaName, pwaAppId.value());
+            indexes.insert(indexes.end(), iter->second.begin(), iter->second.end());
+        }
 
-                appData.pwaAppId = pwaAppId.value();
-                appData.name = pwaName + L" (" + appData.name + L")";
-            }
+        if (auto iter = windowsByPath.find(app.path); iter != windowsByPath.end())
+        {
+            indexes.insert(indexes.end(), iter->second.begin(), iter->second.end());
         }
 
-        if ((app.name == appData.name || app.path == appData.installPath) && (app.pwaAppId == appData.pwaAppId))
+        // keep the enumeration order, so the nearest window is chosen the same way as before
+        std::sort(indexes.begin(), indexes.end());
+        indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+        auto& windows = result[app];
+        for (size_t index : indexes)
         {
-            if (!appDataNearest.has_value())
+            if (windowApps[index]->pwaAppId == app.pwaAppId)
             {
-                appDataNearest = data;
-                nearestWindowWithDistance.distance = PlacementHelper::CalculateDistance(app, window);
-                nearestWindowWithDistance.window = window;
-            }
-            else
-            {
-                int currentDistance = PlacementHelper::CalculateDistance(app, window);
-                if (currentDistance < nearestWindowWithDistance.distance)
-                {
-                    appDataNearest = data;
-                    nearestWindowWithDistance.distance = currentDistance;
-                    nearestWindowWithDistance.window = window;
-                }
+                windows.push_back(m_windowsBefore[index]);
             }
         }
     }
 
-    if (appDataNearest.has_value())
+    return result;
+}
+
+std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& candidateWindows, const std::vector<HWND>& movedWindows)
+{
+    std::optional<WindowWithDistance> nearestWindowWithDistance = std::nullopt;
+
+    for (HWND window : candidateWindows)
     {
-        return nearestWindowWithDistance;
+        if (std::find(movedWindows.begin(), movedWindows.end(), window) != movedWindows.end())
+        {
+            continue;
+        }
+
+        int currentDistance = PlacementHelper::CalculateDistance(app, window);
+        if (!nearestWindowWithDistance.has_value() || currentDistance < nearestWindowWithDistance.value().distance)
+        {
+            nearestWindowWithDistance = WindowWithDistance{ currentDistance, window };
+        }
     }
 
-    return std::nullopt;
+    return nearestWindowWithDistance;
 }
+
 WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
     m_project(project),
     m_windowsBefore(WindowEnumerator::Enumerate(WindowFilter::Filter)),
     m_monitors(MonitorUtils::IdentifyMonitors()),
     m_installedApps(Utils::Apps::GetAppsList()),
+    m_windowAttributes(m_installedApps),
+    m_windowCreationHandler(std::bind(&WindowArranger::onWindowCreated, this, std::placeholders::_1)),
     m_ipcHelper(IPCHelperStrings::WindowArrangerPipeName, IPCHelperStrings::LauncherArrangerPipeName, std::bind(&WindowArranger::receiveIpcMessage, this, std::placeholders::_1)),
     m_launchingStatus(m_project)
 {
@@ -285,7 +310,8 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
         bool movedAny = false;
         std::vector<HWND> movedWindows;
         std::vector<WorkspacesData::WorkspacesProject::Application> movedApps;
-        Utils::PwaHelper pwaHelper{};
+
+        auto candidateWindows = GetCandidateWindows();
 
         while (isMovePhase)
         {
@@ -302,7 +328,7 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
                 }
 
                 std::optional<WindowWithDistance> nearestWindowWithDistance;
-                nearestWindowWithDistance = GetNearestWindow(app, movedWindows, pwaHelper);
+                nearestWindowWithDistance = GetNearestWindow(app, candidateWindows[app], movedWindows);
                 if (nearestWindowWithDistance.has_value())
                 {
                     if (nearestWindowWithDistance.value().distance < minDistance)
@@ -353,7 +379,7 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
             waitingTime = 0;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        waitForWindowEvents(std::chrono::milliseconds(ms));
         waitingTime += ms;
     }
 
@@ -369,7 +395,7 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
     while (!m_launchingStatus.AllLaunchedAndMoved() && waitingTime < maxRepositionWaitingTime)
     {
         processWindows(true);
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        waitForWindowEvents(std::chrono::milliseconds(ms));
         waitingTime += ms;
     }
 
@@ -379,6 +405,33 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
     }
 }
 
+void WindowArranger::onWindowCreated(HWND window)
+{
+    // the handle might be reused, the cached attributes belong to the destroyed window
+    m_windowAttributes.Invalidate(window);
+}
+
+void WindowArranger::waitForWindowEvents(std::chrono::milliseconds timeout)
+{
+    // win event hook callbacks are delivered through the message queue of this thread
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (auto now = std::chrono::steady_clock::now(); now < deadline; now = std::chrono::steady_clock::now())
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+        if (MsgWaitForMultipleObjects(0, nullptr, FALSE, static_cast<DWORD>(remaining.count()), QS_ALLINPUT) != WAIT_OBJECT_0)
+        {
+            break;
+        }
+
+        MSG msg;
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+}
+
 bool WindowArranger::processWindows(bool processAll)
 {
     bool processedAnyWindow = false;
@@ -412,17 +465,10 @@ bool WindowArranger::processWindow(HWND window)
         return false;
     }
 
-    std::wstring processPath = get_process_path(window);
-    if (processPath.empty())
-    {
-        return false;
-    }
-
-    DWORD pid{};
-    GetWindowThreadProcessId(window, &pid);
-
-    auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps);
-    if (!data.has_value())
+    const auto attributes = m_windowAttributes.Get(window);
+    const auto& processPath = attributes.processPath;
+    const auto& data = attributes.appData;
+    if (processPath.empty() || !data.has_value())
     {
         return false;
     }
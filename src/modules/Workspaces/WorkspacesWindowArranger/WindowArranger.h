@@ -1,5 +1,6 @@
 #pragma once
 
+#include <WindowAttributesCache.h>
 #include <WindowCreationHandler.h>
 
 #include <WorkspacesLib/AppUtils.h>
@@ -25,13 +26,17 @@ private:
     const std::vector<HWND> m_windowsBefore;
     const std::vector<WorkspacesData::WorkspacesProject::Monitor> m_monitors;
     const Utils::Apps::AppList m_installedApps;
-    //const WindowCreationHandler m_windowCreationHandler;
+    WindowAttributesCache m_windowAttributes;
+    const WindowCreationHandler m_windowCreationHandler;
     IPCHelper m_ipcHelper;
     LaunchingStatus m_launchingStatus;
-    std::optional<WindowWithDistance> GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& movedWindows, Utils::PwaHelper& pwaHelper);
+
+    std::map<WorkspacesData::WorkspacesProject::Application, std::vector<HWND>> GetCandidateWindows();
+    std::optional<WindowWithDistance> GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& candidateWindows, const std::vector<HWND>& movedWindows);
     bool TryMoveWindow(const WorkspacesData::WorkspacesProject::Application& app, HWND windowToMove);
 
-    //void onWindowCreated(HWND window);
+    void onWindowCreated(HWND window);
+    void waitForWindowEvents(std::chrono::milliseconds timeout);
     bool processWindows(bool processAll);
     bool processWindow(HWND window);
     bool moveWindow(HWND window, const WorkspacesData::WorkspacesProject::Application& app);
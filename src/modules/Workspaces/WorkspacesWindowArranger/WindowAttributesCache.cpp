@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "WindowAttributesCache.h"
+
+#include <common/utils/process_path.h>
+
+#include <workspaces-common/WindowUtils.h>
+
+namespace NonLocalizable
+{
+    const wchar_t ApplicationFrameHost[] = L"ApplicationFrameHost.exe";
+}
+
+WindowAttributesCache::WindowAttributesCache(const Utils::Apps::AppList& installedApps) :
+    m_collect([&installedApps](HWND window) { return Collect(window, installedApps); })
+{
+}
+
+WindowAttributesCache::WindowAttributesCache(Collector collector) :
+    m_collect(std::move(collector))
+{
+}
+
+void WindowAttributesCache::Invalidate(HWND window)
+{
+    m_attributes.erase(window);
+}
+
+WindowAttributes WindowAttributesCache::Get(HWND window)
+{
+    auto iter = m_attributes.find(window);
+    if (iter != m_attributes.end())
+    {
+        return iter->second;
+    }
+
+    auto attributes = m_collect(window);
+    if (IsResolved(attributes))
+    {
+        m_attributes.emplace(window, attributes);
+    }
+
+    return attributes;
+}
+
+bool WindowAttributesCache::IsResolved(const WindowAttributes& attributes)
+{
+    return !attributes.processPath.empty() &&
+           !attributes.processPath.ends_with(NonLocalizable::ApplicationFrameHost) &&
+           attributes.appData.has_value();
+}
+
+WindowAttributes WindowAttributesCache::Collect(HWND window, const Utils::Apps::AppList& installedApps)
+{
+    WindowAttributes attributes{};
+    GetWindowThreadProcessId(window, &attributes.pid);
+    attributes.processPath = get_process_path(window);
+    attributes.title = WindowUtils::GetWindowTitle(window);
+    if (!attributes.processPath.empty())
+    {
+        attributes.appData = Utils::Apps::GetApp(attributes.processPath, attributes.pid, installedApps);
+    }
+
+    return attributes;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+
+#include <WorkspacesLib/AppUtils.h>
+
+// Raw window attributes, the app is resolved from the window's own process path.
+// Moving existing windows resolves packaged and PWA apps on top of these, see WindowArranger::GetCandidateWindows.
+struct WindowAttributes
+{
+    DWORD pid{};
+    std::wstring processPath;
+    std::wstring title;
+    std::optional<Utils::Apps::AppData> appData;
+};
+
+// Collects the window attributes once per window.
+// Entries are dropped on window creation events, since the handle might be reused by another window.
+// Windows that aren't resolved yet are collected again on every lookup, e.g. a UWP window belongs to
+// ApplicationFrameHost until its CoreWindow is attached.
+class WindowAttributesCache
+{
+public:
+    using Collector = std::function<WindowAttributes(HWND)>;
+
+    WindowAttributesCache(const Utils::Apps::AppList& installedApps);
+    WindowAttributesCache(Collector collector);
+    ~WindowAttributesCache() = default;
+
+    void Invalidate(HWND window);
+
+    // returns a copy, Invalidate can drop the entry while the caller still uses it
+    WindowAttributes Get(HWND window);
+
+    static bool IsResolved(const WindowAttributes& attributes);
+
+private:
+    Collector m_collect;
+    std::unordered_map<HWND, WindowAttributes> m_attributes;
+
+    static WindowAttributes Collect(HWND window, const Utils::Apps::AppList& installedApps);
+};
@@ -0,0 +1,364 @@
+#include "pch.h"
+
+#include <DrawUndo.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ZoomItUnitTests
+{
+    // A screen capture, top-down 32bpp without row padding
+    struct TestScreen
+    {
+        std::vector<UINT32> pixels;
+        int width = 0;
+        int height = 0;
+
+        TestScreen(const int width, const int height, const UINT32 color = 0xFFF3F3F3) :
+            width(width), height(height)
+        {
+            pixels.assign(static_cast<size_t>(width) * height, color);
+        }
+
+        const BYTE* Bytes() const { return reinterpret_cast<const BYTE*>(pixels.data()); }
+        size_t Stride() const { return static_cast<size_t>(width) * 4; }
+
+        void Fill(const int left, const int top, const int right, const int bottom, const UINT32 color)
+        {
+            for (int y = (std::max)(top, 0); y < (std::min)(bottom, height); ++y)
+            {
+                for (int x = (std::max)(left, 0); x < (std::min)(right, width); ++x)
+                {
+                    pixels[static_cast<size_t>(y) * width + x] = color;
+                }
+            }
+        }
+
+        // A pen stroke: a band of noise, which does not compress
+        void Stroke(const int left, const int top, const int right, const int bottom, std::mt19937& random)
+        {
+            for (int y = (std::max)(top, 0); y < (std::min)(bottom, height); ++y)
+            {
+                for (int x = (std::max)(left, 0); x < (std::min)(right, width); ++x)
+                {
+                    pixels[static_cast<size_t>(y) * width + x] = static_cast<UINT32>(random());
+                }
+            }
+        }
+
+        bool Matches(const BYTE* bytes) const
+        {
+            return memcmp(bytes, pixels.data(), pixels.size() * 4) == 0;
+        }
+    };
+
+    // Desktop-like content followed by a few strokes, each a new undo state.
+    // The size is not a multiple of the tile size, so the last tiles are partial.
+    std::vector<TestScreen> MakeStates(const size_t count, const uint32_t seed)
+    {
+        std::mt19937 random{ seed };
+        std::vector<TestScreen> states;
+        TestScreen screen{ 150, 130 };
+        screen.Fill(0, 0, 150, 20, 0xFF202020);
+        screen.Fill(10, 30, 90, 100, 0xFF0078D4);
+        screen.Stroke(100, 40, 140, 60, random);
+        states.push_back(screen);
+        while (states.size() < count)
+        {
+            const int left = static_cast<int>(random() % 150);
+            const int top = static_cast<int>(random() % 130);
+            screen.Stroke(left, top, left + 4 + static_cast<int>(random() % 60), top + 4 + static_cast<int>(random() % 40), random);
+            states.push_back(screen);
+        }
+        return states;
+    }
+
+    std::vector<BYTE> EncodeRuns(const std::vector<UINT32>& pixels)
+    {
+        std::vector<BYTE> data;
+        EncodePixelRuns(pixels.data(), pixels.size(), data);
+        return data;
+    }
+
+    TEST_CLASS (DrawUndoTests)
+    {
+        static void AssertOldestRegions(const DrawUndoHistory& history, const TestScreen& oldest)
+        {
+            // Regions within one tile, across tiles, and partly off the screen
+            const RECT regions[] = {
+                { 0, 0, 150, 130 },
+                { 5, 7, 20, 19 },
+                { 50, 50, 140, 80 },
+                { 60, 60, 70, 70 },
+                { -10, -5, 30, 25 },
+                { 120, 110, 170, 150 },
+            };
+            for (const auto& region : regions)
+            {
+                const int width = region.right - region.left;
+                const int height = region.bottom - region.top;
+                TestScreen actual{ width, height, 0 };
+                history.CopyOldest(region, reinterpret_cast<BYTE*>(actual.pixels.data()), actual.Stride());
+
+                for (int y = 0; y < height; ++y)
+                {
+                    for (int x = 0; x < width; ++x)
+                    {
+                        const int screenX = region.left + x;
+                        const int screenY = region.top + y;
+                        const bool onScreen = screenX >= 0 && screenX < oldest.width && screenY >= 0 && screenY < oldest.height;
+                        const UINT32 expected = onScreen ? oldest.pixels[static_cast<size_t>(screenY) * oldest.width + screenX] : 0;
+                        if (actual.pixels[static_cast<size_t>(y) * width + x] != expected)
+                        {
+                            Assert::Fail(std::format(L"Region {{{}, {}, {}, {}}} differs at ({}, {})",
+                                                     region.left,
+                                                     region.top,
+                                                     region.right,
+                                                     region.bottom,
+                                                     screenX,
+                                                     screenY)
+                                             .c_str());
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+        TEST_METHOD (RunsRoundTrip)
+        {
+            std::mt19937 random{ 5 };
+            std::vector<std::vector<UINT32>> inputs = {
+                {},
+                { 1 },
+                { 1, 1 },
+                { 1, 1, 1 },
+                { 1, 2, 2, 3, 3, 3, 4, 4, 4, 4 },
+                std::vector<UINT32>(0x7FFF + 5, 0xFF00FF00),
+            };
+
+            // Literals longer than a run header can count
+            std::vector<UINT32> noise(0x7FFF * 2 + 3);
+            for (auto& pixel : noise)
+            {
+                pixel = static_cast<UINT32>(random());
+            }
+            inputs.push_back(noise);
+
+            for (const auto& input : inputs)
+            {
+                const auto data = EncodeRuns(input);
+                std::vector<UINT32> output(input.size());
+                Assert::IsTrue(DecodePixelRuns(data.data(), data.size(), output.data(), output.size()));
+                Assert::IsTrue(input == output);
+            }
+
+            // A flat tile takes a single run
+            Assert::AreEqual(size_t{ 6 }, EncodeRuns(std::vector<UINT32>(64 * 64, 0xFFFFFFFF)).size());
+        }
+
+        TEST_METHOD (DecodeRejectsMismatchedData)
+        {
+            const std::vector<UINT32> input = { 1, 2, 3, 3, 3, 3, 4 };
+            const auto data = EncodeRuns(input);
+            std::vector<UINT32> output(input.size() + 1);
+
+            Assert::IsFalse(DecodePixelRuns(data.data(), data.size(), output.data(), input.size() - 1));
+            Assert::IsFalse(DecodePixelRuns(data.data(), data.size(), output.data(), input.size() + 1));
+            Assert::IsFalse(DecodePixelRuns(data.data(), data.size() - 1, output.data(), input.size()));
+        }
+
+        TEST_METHOD (PopRestoresEveryState)
+        {
+            const auto states = MakeStates(12, 1);
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            for (const auto& state : states)
+            {
+                Assert::IsTrue(history.Push(state.Bytes(), state.width, state.height, state.Stride()));
+                Assert::IsTrue(state.Matches(history.Newest()));
+            }
+            Assert::AreEqual(states.size(), history.Count());
+
+            for (size_t i = states.size(); i-- > 0;)
+            {
+                Assert::IsTrue(states[i].Matches(history.Newest()), std::format(L"state {}", i).c_str());
+                Assert::IsTrue(history.Pop());
+            }
+            Assert::IsTrue(history.IsEmpty());
+            Assert::AreEqual(size_t{ 0 }, history.DeltaBytes());
+            Assert::IsFalse(history.Pop());
+        }
+
+        TEST_METHOD (PushSkipsRowPadding)
+        {
+            const auto states = MakeStates(3, 2);
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            for (const auto& state : states)
+            {
+                // Each row followed by 3 pixels of padding
+                std::vector<UINT32> padded;
+                for (int y = 0; y < state.height; ++y)
+                {
+                    padded.insert(padded.end(), state.pixels.begin() + static_cast<size_t>(y) * state.width, state.pixels.begin() + static_cast<size_t>(y + 1) * state.width);
+                    padded.insert(padded.end(), 3, 0xCDCDCDCD);
+                }
+                history.Push(reinterpret_cast<const BYTE*>(padded.data()), state.width, state.height, (static_cast<size_t>(state.width) + 3) * 4);
+                Assert::IsTrue(state.Matches(history.Newest()));
+            }
+
+            history.Pop();
+            Assert::IsTrue(states[1].Matches(history.Newest()));
+        }
+
+        TEST_METHOD (UnchangedPushStoresNothing)
+        {
+            const auto states = MakeStates(1, 3);
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            history.Push(states[0].Bytes(), states[0].width, states[0].height, states[0].Stride());
+            history.Push(states[0].Bytes(), states[0].width, states[0].height, states[0].Stride());
+            Assert::AreEqual(size_t{ 2 }, history.Count());
+            Assert::AreEqual(size_t{ 0 }, history.DeltaBytes());
+        }
+
+        TEST_METHOD (DirtyRectangleLimitsPush)
+        {
+            const auto states = MakeStates(1, 9);
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            history.Push(states[0].Bytes(), states[0].width, states[0].height, states[0].Stride());
+
+            const RECT dirty = { 70, 70, 90, 80 };
+            const RECT bounds = history.TileBounds(dirty);
+            const RECT dirtyTiles = { 64, 64, 128, 128 };
+            Assert::IsTrue(EqualRect(&dirtyTiles, &bounds));
+
+            // Only the tiles under the stroke are captured, the rest of the buffer is never read
+            std::mt19937 random{ 9 };
+            TestScreen stroked = states[0];
+            stroked.Stroke(dirty.left, dirty.top, dirty.right, dirty.bottom, random);
+            TestScreen captured{ stroked.width, stroked.height, 0xCDCDCDCD };
+            for (int y = bounds.top; y < bounds.bottom; ++y)
+            {
+                for (int x = bounds.left; x < bounds.right; ++x)
+                {
+                    captured.pixels[static_cast<size_t>(y) * captured.width + x] = stroked.pixels[static_cast<size_t>(y) * stroked.width + x];
+                }
+            }
+            Assert::IsTrue(history.Push(captured.Bytes(), captured.width, captured.height, captured.Stride(), &dirty));
+            Assert::IsTrue(stroked.Matches(history.Newest()));
+
+            // Nothing was drawn since the previous push
+            const size_t deltaBytes = history.DeltaBytes();
+            const RECT empty = {};
+            Assert::IsTrue(history.Push(captured.Bytes(), captured.width, captured.height, captured.Stride(), &empty));
+            Assert::AreEqual(deltaBytes, history.DeltaBytes());
+
+            history.Pop();
+            history.Pop();
+            Assert::IsTrue(states[0].Matches(history.Newest()));
+        }
+
+        TEST_METHOD (TileBoundsClipsToScreen)
+        {
+            const TestScreen screen{ 150, 130 };
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            history.Push(screen.Bytes(), screen.width, screen.height, screen.Stride());
+
+            const RECT partial = history.TileBounds({ 120, 110, 170, 150 });
+            const RECT partialTiles = { 64, 64, 150, 130 };
+            Assert::IsTrue(EqualRect(&partialTiles, &partial));
+
+            const RECT offScreen = history.TileBounds({ 200, 10, 220, 20 });
+            Assert::IsTrue(IsRectEmpty(&offScreen));
+        }
+
+        TEST_METHOD (FirstPushOutOfMemoryFails)
+        {
+            // The first state of a screen this large can't be allocated
+            const TestScreen screen{ 1, 1 };
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            Assert::IsFalse(history.Push(screen.Bytes(), 1 << 20, 1 << 20, screen.Stride()));
+            Assert::IsTrue(history.IsEmpty());
+            Assert::AreEqual(size_t{ 0 }, history.Count());
+
+            Assert::IsTrue(history.Push(screen.Bytes(), screen.width, screen.height, screen.Stride()));
+            Assert::IsTrue(screen.Matches(history.Newest()));
+        }
+
+        TEST_METHOD (ResizeStartsNewHistory)
+        {
+            const auto states = MakeStates(3, 4);
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            for (const auto& state : states)
+            {
+                history.Push(state.Bytes(), state.width, state.height, state.Stride());
+            }
+
+            const TestScreen smaller{ 40, 30, 0xFF112233 };
+            history.Push(smaller.Bytes(), smaller.width, smaller.height, smaller.Stride());
+            Assert::AreEqual(size_t{ 1 }, history.Count());
+            Assert::AreEqual(40, history.Width());
+            Assert::IsTrue(smaller.Matches(history.Newest()));
+        }
+
+        TEST_METHOD (BudgetDropsOldestStates)
+        {
+            const auto states = MakeStates(30, 6);
+            const size_t budget = 20000;
+            DrawUndoHistory history{ budget };
+            for (const auto& state : states)
+            {
+                history.Push(state.Bytes(), state.width, state.height, state.Stride());
+
+                // The newest delta is kept even when it alone exceeds the budget
+                Assert::IsTrue(history.DeltaBytes() <= budget || history.Count() == 2);
+            }
+            Assert::IsTrue(history.Count() < states.size());
+
+            // What is left still walks back through the newest states
+            const size_t count = history.Count();
+            for (size_t i = 0; i < count; ++i)
+            {
+                Assert::IsTrue(states[states.size() - 1 - i].Matches(history.Newest()));
+                history.Pop();
+            }
+            Assert::IsTrue(history.IsEmpty());
+        }
+
+        TEST_METHOD (CopyOldestMatchesFirstState)
+        {
+            const auto states = MakeStates(8, 7);
+            DrawUndoHistory history{ 256 * 1024 * 1024 };
+            for (const auto& state : states)
+            {
+                history.Push(state.Bytes(), state.width, state.height, state.Stride());
+                AssertOldestRegions(history, states[0]);
+            }
+
+            // Undoing the newest strokes does not change the oldest state
+            for (size_t i = states.size(); i > 1; --i)
+            {
+                history.Pop();
+                AssertOldestRegions(history, states[0]);
+            }
+        }
+
+        TEST_METHOD (CopyOldestFollowsTrimmedHistory)
+        {
+            const auto states = MakeStates(30, 8);
+            DrawUndoHistory history{ 20000 };
+            for (const auto& state : states)
+            {
+                history.Push(state.Bytes(), state.width, state.height, state.Stride());
+            }
+            Assert::IsTrue(history.Count() < states.size());
+            AssertOldestRegions(history, states[states.size() - history.Count()]);
+        }
+
+        TEST_METHOD (CopyOldestOfEmptyHistoryLeavesDestination)
+        {
+            const DrawUndoHistory history{ 256 * 1024 * 1024 };
+            TestScreen dest{ 10, 10, 0x12345678 };
+            history.CopyOldest({ 0, 0, 10, 10 }, reinterpret_cast<BYTE*>(dest.pixels.data()), dest.Stride());
+            Assert::IsTrue(std::all_of(dest.pixels.begin(), dest.pixels.end(), [](const UINT32 pixel) { return pixel == 0x12345678; }));
+        }
+    };
+}
@@ -0,0 +1,461 @@
+#include "pch.h"
+
+#include <DrawingEffects.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace ZoomItUnitTests
+{
+    // A 32bpp BGRA buffer. The padding at the end of each row is filled with a
+    // marker that the effects must not touch.
+    struct TestPixels
+    {
+        static constexpr BYTE PaddingMarker = 0xCD;
+
+        std::vector<BYTE> bytes;
+        int width = 0;
+        int height = 0;
+        size_t stride = 0;
+
+        TestPixels(const int width, const int height, const int paddingPixels = 0) :
+            width(width), height(height), stride(static_cast<size_t>(width + paddingPixels) * 4)
+        {
+            bytes.assign(stride * height, PaddingMarker);
+        }
+
+        UINT32& At(const int x, const int y)
+        {
+            return reinterpret_cast<UINT32*>(bytes.data() + y * stride)[x];
+        }
+
+        UINT32 At(const int x, const int y) const
+        {
+            return reinterpret_cast<const UINT32*>(bytes.data() + y * stride)[x];
+        }
+
+        void Fill(const UINT32 color)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                std::fill_n(&At(0, y), width, color);
+            }
+        }
+
+        void FillRandom(const uint32_t seed)
+        {
+            std::mt19937 random{ seed };
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    At(x, y) = static_cast<UINT32>(random());
+                }
+            }
+        }
+
+        bool PaddingIntact() const
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                for (size_t i = static_cast<size_t>(width) * 4; i < stride; ++i)
+                {
+                    if (bytes[y * stride + i] != PaddingMarker)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    };
+
+    // The box radius BlurPixels uses for a GDI+ blur radius
+    int BoxRadius(const int radius)
+    {
+        return (std::max)(1, (radius + 2) / 3);
+    }
+
+    // BlurPixels written per pixel and channel: three passes of a horizontal
+    // then a vertical box, repeating the edge pixels past the bounds
+    void ReferenceBlur(TestPixels& pixels, const int radius)
+    {
+        const int boxRadius = BoxRadius(radius);
+        const float scale = 1.0f / static_cast<float>(2 * boxRadius + 1);
+        const int width = pixels.width;
+        const int height = pixels.height;
+
+        auto channel = [](const UINT32 pixel, const int c) { return static_cast<int>((pixel >> (c * 8)) & 0xFF); };
+        std::vector<UINT32> temp(static_cast<size_t>(width) * height);
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    UINT32 result = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        int sum = 0;
+                        for (int k = -boxRadius; k <= boxRadius; ++k)
+                        {
+                            sum += channel(pixels.At(std::clamp(x + k, 0, width - 1), y), c);
+                        }
+                        result |= static_cast<UINT32>(lrintf(sum * scale)) << (c * 8);
+                    }
+                    temp[static_cast<size_t>(y) * width + x] = result;
+                }
+            }
+
+            for (int y = 0; y < height; ++y)
+            {
+                for (int x = 0; x < width; ++x)
+                {
+                    UINT32 result = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        int sum = 0;
+                        for (int k = -boxRadius; k <= boxRadius; ++k)
+                        {
+                            sum += channel(temp[static_cast<size_t>(std::clamp(y + k, 0, height - 1)) * width + x], c);
+                        }
+                        result |= static_cast<UINT32>(lrintf(sum * scale)) << (c * 8);
+                    }
+                    pixels.At(x, y) = result;
+                }
+            }
+        }
+    }
+
+    // The loop BlurScreen ran before the effects were added, on the ARGB
+    // values that Gdiplus::Bitmap::GetPixel returned for the blurred copy
+    void ReferenceComposite(TestPixels& dest, const TestPixels& source, const TestPixels& mask)
+    {
+        for (int y = 0; y < dest.height; ++y)
+        {
+            for (int x = 0; x < dest.width; ++x)
+            {
+                if (mask.At(x, y) >> 24)
+                {
+                    BYTE* destPixel = reinterpret_cast<BYTE*>(&dest.At(x, y));
+                    const COLORREF newPixel = source.At(x, y) & 0xFFFFFF;
+                    destPixel[0] = GetRValue(newPixel);
+                    destPixel[1] = GetGValue(newPixel);
+                    destPixel[2] = GetBValue(newPixel);
+                }
+            }
+        }
+    }
+
+    // BlendColors as it was before HighlightPixels, taking the pen color as a
+    // Gdiplus::Color, whose ARGB layout swaps the COLORREF red and blue
+    COLORREF ReferenceBlendColors(const COLORREF color1, const COLORREF penColor)
+    {
+        BYTE red1 = GetRValue(color1);
+        BYTE green1 = GetGValue(color1);
+        BYTE blue1 = GetBValue(color1);
+
+        BYTE blue2 = static_cast<BYTE>(penColor >> 16);
+        BYTE green2 = static_cast<BYTE>(penColor >> 8);
+        BYTE red2 = static_cast<BYTE>(penColor);
+
+        red2 = static_cast<BYTE>((std::min)(0xFF, red2 ? red2 + 0x40 : red2 + 0x80));
+        green2 = static_cast<BYTE>((std::min)(0xFF, green2 ? green2 + 0x40 : green2 + 0x80));
+        blue2 = static_cast<BYTE>((std::min)(0xFF, blue2 ? blue2 + 0x40 : blue2 + 0x80));
+        return RGB(red2 & red1, green2 & green1, blue2 & blue1);
+    }
+
+    // The per-pixel highlighter loop that called BlendColors
+    void ReferenceHighlight(TestPixels& dest, const TestPixels& source, const TestPixels& mask, const COLORREF penColor)
+    {
+        for (int y = 0; y < dest.height; ++y)
+        {
+            for (int x = 0; x < dest.width; ++x)
+            {
+                if (mask.At(x, y) >> 24)
+                {
+                    const UINT32 sourceValue = source.At(x, y);
+                    const BYTE* sourcePixel = reinterpret_cast<const BYTE*>(&sourceValue);
+                    BYTE* destPixel = reinterpret_cast<BYTE*>(&dest.At(x, y));
+                    const COLORREF newPixel = ReferenceBlendColors(RGB(sourcePixel[2], sourcePixel[1], sourcePixel[0]), penColor);
+                    destPixel[0] = GetBValue(newPixel);
+                    destPixel[1] = GetGValue(newPixel);
+                    destPixel[2] = GetRValue(newPixel);
+                }
+            }
+        }
+    }
+
+    // Something like a screen: a light background, dark text-like strokes,
+    // saturated panels and a gray gradient
+    TestPixels MakeScreenPixels(const int width, const int height, const int paddingPixels, const uint32_t seed)
+    {
+        TestPixels pixels{ width, height, paddingPixels };
+        pixels.Fill(0xFFF3F3F3);
+
+        std::mt19937 random{ seed };
+        const UINT32 panels[] = { 0xFF0078D4, 0xFFFFFFFF, 0xFF202020, 0xFFC42B1C, 0xFF107C10, 0xFFFFB900 };
+        for (int i = 0; i < 6; ++i)
+        {
+            const int left = static_cast<int>(random() % width);
+            const int top = static_cast<int>(random() % height);
+            for (int y = top; y < (std::min)(height, top + 1 + height / 3); ++y)
+            {
+                std::fill_n(&pixels.At(left, y), (std::min)(width - left, 1 + width / 3), panels[i]);
+            }
+        }
+        for (int i = 0; i < 40; ++i)
+        {
+            const int x = static_cast<int>(random() % width);
+            const int y = static_cast<int>(random() % height);
+            std::fill_n(&pixels.At(x, y), (std::min)(width - x, 1 + static_cast<int>(random() % 8)), 0xFF101010);
+        }
+        for (int y = height / 2; y < height; ++y)
+        {
+            for (int x = 0; x < width / 4; ++x)
+            {
+                const UINT32 level = static_cast<UINT32>(x * 255 / (std::max)(1, width / 4 - 1));
+                pixels.At(x, y) = 0xFF000000 | level << 16 | level << 8 | level;
+            }
+        }
+        return pixels;
+    }
+
+    // A thick antialiased diagonal stroke, as DrawBitmapLine renders it: zero
+    // alpha off the stroke, partial alpha along its edges
+    TestPixels MakeStrokeMask(const int width, const int height, const int paddingPixels)
+    {
+        TestPixels mask{ width, height, paddingPixels };
+        mask.Fill(0);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                const int distance = std::abs(x * height - y * width) / (std::max)(width, height);
+                if (distance < 6)
+                {
+                    const UINT32 alpha = distance < 4 ? 0xFF : static_cast<UINT32>(0x60 / distance);
+                    mask.At(x, y) = alpha << 24 | 0x00FFFF00;
+                }
+            }
+        }
+        return mask;
+    }
+
+    void AssertSamePixels(const TestPixels& expected, const TestPixels& actual, const wchar_t* what)
+    {
+        for (int y = 0; y < expected.height; ++y)
+        {
+            for (int x = 0; x < expected.width; ++x)
+            {
+                if (expected.At(x, y) != actual.At(x, y))
+                {
+                    Assert::Fail(std::format(L"{} {}x{} at ({}, {}): expected {:08X}, got {:08X}",
+                                             what,
+                                             expected.width,
+                                             expected.height,
+                                             x,
+                                             y,
+                                             expected.At(x, y),
+                                             actual.At(x, y))
+                                     .c_str());
+                }
+            }
+        }
+        Assert::IsTrue(actual.PaddingIntact(), what);
+    }
+
+    TEST_CLASS (DrawingEffectsTests)
+    {
+    public:
+        TEST_METHOD (BlurMatchesReferenceOnRandomPixels)
+        {
+            // Odd widths leave partial vector blocks, small sizes are narrower than the box
+            const std::pair<int, int> sizes[] = { { 1, 1 }, { 2, 3 }, { 5, 4 }, { 17, 9 }, { 33, 40 }, { 70, 21 } };
+            const int radii[] = { 1, 2, 5, 20 };
+            uint32_t seed = 1;
+            for (const auto& [width, height] : sizes)
+            {
+                for (const int radius : radii)
+                {
+                    TestPixels expected{ width, height, 3 };
+                    expected.FillRandom(seed++);
+                    TestPixels actual = expected;
+
+                    ReferenceBlur(expected, radius);
+                    BlurPixels(actual.bytes.data(), actual.width, actual.height, actual.stride, radius);
+                    AssertSamePixels(expected, actual, std::format(L"Blur radius {}", radius).c_str());
+                }
+            }
+        }
+
+        TEST_METHOD (BlurKeepsFlatColor)
+        {
+            TestPixels pixels{ 40, 30 };
+            pixels.Fill(0xFF204080);
+            const TestPixels expected = pixels;
+
+            BlurPixels(pixels.bytes.data(), pixels.width, pixels.height, pixels.stride, 20);
+            AssertSamePixels(expected, pixels, L"Flat blur");
+        }
+
+        TEST_METHOD (BlurSpreadsAsFarAsRadius)
+        {
+            // The GDI+ effect spread a pixel up to the radius away. The passes reach
+            // up to two pixels further, where the rounded weights are mostly zero.
+            for (const int radius : { 3, 10, 20 })
+            {
+                const int block = 8;
+                const int size = block + 2 * (radius + 6);
+                const int blockStart = radius + 6;
+                TestPixels pixels{ size, size };
+                pixels.Fill(0xFF000000);
+                for (int y = blockStart; y < blockStart + block; ++y)
+                {
+                    std::fill_n(&pixels.At(blockStart, y), block, 0xFFFFFFFF);
+                }
+
+                BlurPixels(pixels.bytes.data(), pixels.width, pixels.height, pixels.stride, radius);
+
+                const int middle = blockStart + block / 2;
+                Assert::AreNotEqual(0u, pixels.At(blockStart - 1, middle) & 0xFF);
+                Assert::AreNotEqual(0u, pixels.At(blockStart + block, middle) & 0xFF);
+                for (int y = 0; y < size; ++y)
+                {
+                    for (int x = 0; x < size; ++x)
+                    {
+                        const int distance = (std::max)({ blockStart - x, x - (blockStart + block - 1), blockStart - y, y - (blockStart + block - 1) });
+                        if (distance > radius + 2)
+                        {
+                            Assert::AreEqual(0xFF000000u, pixels.At(x, y), std::format(L"radius {} at ({}, {})", radius, x, y).c_str());
+                        }
+
+                        // Symmetric around the block
+                        Assert::AreEqual(pixels.At(x, y), pixels.At(size - 1 - x, y));
+                        Assert::AreEqual(pixels.At(x, y), pixels.At(x, size - 1 - y));
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (CompositeMatchesPerPixelCopy)
+        {
+            uint32_t seed = 100;
+            for (int width = 1; width <= 19; ++width)
+            {
+                TestPixels source{ width, 5, 1 };
+                source.FillRandom(seed++);
+
+                // Mostly undrawn pixels, with strokes of varied alpha
+                TestPixels mask{ width, 5, 2 };
+                mask.FillRandom(seed++);
+                for (int y = 0; y < mask.height; ++y)
+                {
+                    for (int x = 0; x < mask.width; ++x)
+                    {
+                        if ((x + y) % 3 != 0)
+                        {
+                            mask.At(x, y) &= 0x00FFFFFF;
+                        }
+                    }
+                }
+
+                TestPixels expected{ width, 5, 4 };
+                expected.FillRandom(seed++);
+                TestPixels actual = expected;
+
+                ReferenceComposite(expected, source, mask);
+                CompositeMaskedPixels(actual.bytes.data(), actual.stride, source.bytes.data(), source.stride,
+                                      mask.bytes.data(), mask.stride, actual.width, actual.height);
+                AssertSamePixels(expected, actual, L"Composite");
+            }
+        }
+
+        TEST_METHOD (HighlightMatchesBlendColorsOnScreenPixels)
+        {
+            // The pen colors, with the alpha the highlighter pen sets
+            const COLORREF penColors[] = { RGB(255, 0, 0), RGB(0, 255, 0), RGB(0, 0, 255), RGB(255, 128, 0), RGB(255, 255, 0), RGB(255, 128, 255), RGB(0, 0, 0), RGB(255, 255, 255) };
+            const std::pair<int, int> sizes[] = { { 1, 1 }, { 7, 5 }, { 61, 23 }, { 128, 64 } };
+            uint32_t seed = 11;
+            for (const auto& [width, height] : sizes)
+            {
+                const TestPixels source = MakeScreenPixels(width, height, 2, seed++);
+                const TestPixels mask = MakeStrokeMask(width, height, 1);
+                for (const COLORREF penColor : penColors)
+                {
+                    const COLORREF highlighter = (penColor & 0x00FFFFFF) | 0x7F000000;
+
+                    // The destination is the screen with the previous stroke segments on it
+                    TestPixels expected = MakeScreenPixels(width, height, 3, seed++);
+                    TestPixels actual = expected;
+
+                    ReferenceHighlight(expected, source, mask, highlighter);
+                    HighlightPixels(actual.bytes.data(), actual.stride, source.bytes.data(), source.stride,
+                                    mask.bytes.data(), mask.stride, actual.width, actual.height, GetHighlighterColor(highlighter));
+                    AssertSamePixels(expected, actual, std::format(L"Highlight {:06X}", penColor).c_str());
+                }
+            }
+        }
+
+        TEST_METHOD (HighlightMatchesBlendColorsOnRandomPixels)
+        {
+            std::mt19937 random{ 21 };
+            for (int width = 1; width <= 19; ++width)
+            {
+                TestPixels source{ width, 4, 1 };
+                source.FillRandom(static_cast<uint32_t>(random()));
+                TestPixels mask{ width, 4 };
+                mask.FillRandom(static_cast<uint32_t>(random()));
+                for (int y = 0; y < mask.height; ++y)
+                {
+                    for (int x = 0; x < mask.width; ++x)
+                    {
+                        if (random() % 2)
+                        {
+                            mask.At(x, y) &= 0x00FFFFFF;
+                        }
+                    }
+                }
+
+                const COLORREF penColor = static_cast<COLORREF>(random());
+                TestPixels expected{ width, 4, 2 };
+                expected.FillRandom(static_cast<uint32_t>(random()));
+                TestPixels actual = expected;
+
+                ReferenceHighlight(expected, source, mask, penColor);
+                HighlightPixels(actual.bytes.data(), actual.stride, source.bytes.data(), source.stride,
+                                mask.bytes.data(), mask.stride, actual.width, actual.height, GetHighlighterColor(penColor));
+                AssertSamePixels(expected, actual, std::format(L"Highlight {:08X}", penColor).c_str());
+            }
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(BlurCostNativeVsReference)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (BlurCostNativeVsReference)
+        {
+            TestPixels expected{ 400, 300 };
+            expected.FillRandom(7);
+            TestPixels actual = expected;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            ReferenceBlur(expected, 20);
+            const auto referenceCost = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            BlurPixels(actual.bytes.data(), actual.width, actual.height, actual.stride, 20);
+            const auto nativeCost = std::chrono::high_resolution_clock::now() - start;
+
+            using std::chrono::duration_cast;
+            using std::chrono::microseconds;
+            Logger::WriteMessage(std::format(L"Blur of {}x{} pixels, radius 20: {} us per pixel reference, {} us running sums\n",
+                                             expected.width,
+                                             expected.height,
+                                             duration_cast<microseconds>(referenceCost).count(),
+                                             duration_cast<microseconds>(nativeCost).count())
+                                     .c_str());
+
+            AssertSamePixels(expected, actual, L"Blur");
+        }
+    };
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "targetver.h"
+
+// Headers for CppUnitTest
+#pragma warning(disable : 26466)
+#include "CppUnitTest.h"
+
+// Windows headers
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <random>
+#include <vector>
@@ -0,0 +1,429 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Drawing undo history that stores only the screen tiles changed between
+// undo states
+//
+//==============================================================================
+#include "pch.h"
+#include "DrawUndo.h"
+
+namespace
+{
+    // Run headers: the high bit marks a repeated pixel, otherwise the header
+    // is followed by that many literal pixels.
+    const WORD RUN_REPEAT = 0x8000;
+    const size_t RUN_MAX = 0x7FFF;
+    const size_t RUN_MIN_REPEAT = 3;
+
+    size_t RepeatLength( const UINT32* pixels, size_t index, size_t count )
+    {
+        size_t length = 1;
+        while( index + length < count && length < RUN_MAX && pixels[index + length] == pixels[index] ) {
+            length++;
+        }
+        return length;
+    }
+
+    void AppendBytes( std::vector<BYTE>& output, const void* data, size_t size )
+    {
+        const BYTE* bytes = static_cast<const BYTE*>(data);
+        output.insert( output.end(), bytes, bytes + size );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// EncodePixelRuns
+//
+// Run-length encodes 32-bit pixels. Screen content is dominated by flat
+// areas, so runs of the same pixel compress well and everything else is
+// stored as literals with a small header.
+//
+//----------------------------------------------------------------------------
+void EncodePixelRuns( const UINT32* pixels, size_t count, std::vector<BYTE>& output )
+{
+    size_t index = 0;
+    while( index < count ) {
+
+        size_t repeat = RepeatLength( pixels, index, count );
+        if( repeat >= RUN_MIN_REPEAT ) {
+
+            WORD header = static_cast<WORD>(RUN_REPEAT | repeat);
+            AppendBytes( output, &header, sizeof( header ));
+            AppendBytes( output, &pixels[index], sizeof( UINT32 ));
+            index += repeat;
+            continue;
+        }
+
+        size_t start = index;
+        while( index < count && index - start < RUN_MAX &&
+               RepeatLength( pixels, index, count ) < RUN_MIN_REPEAT ) {
+            index++;
+        }
+
+        WORD header = static_cast<WORD>(index - start);
+        AppendBytes( output, &header, sizeof( header ));
+        AppendBytes( output, &pixels[start], ( index - start ) * sizeof( UINT32 ));
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DecodePixelRuns
+//
+//----------------------------------------------------------------------------
+bool DecodePixelRuns( const BYTE* data, size_t size, UINT32* pixels, size_t count )
+{
+    size_t offset = 0, index = 0;
+    while( offset + sizeof( WORD ) <= size ) {
+
+        WORD header;
+        memcpy( &header, data + offset, sizeof( header ));
+        offset += sizeof( header );
+
+        size_t length = header & RUN_MAX;
+        if( index + length > count ) {
+
+            return false;
+        }
+        if( header & RUN_REPEAT ) {
+
+            if( offset + sizeof( UINT32 ) > size ) {
+
+                return false;
+            }
+            UINT32 pixel;
+            memcpy( &pixel, data + offset, sizeof( pixel ));
+            offset += sizeof( pixel );
+            std::fill_n( pixels + index, length, pixel );
+
+        } else {
+
+            if( offset + length * sizeof( UINT32 ) > size ) {
+
+                return false;
+            }
+            memcpy( pixels + index, data + offset, length * sizeof( UINT32 ));
+            offset += length * sizeof( UINT32 );
+        }
+        index += length;
+    }
+    return index == count && offset == size;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::TileRect
+//
+//----------------------------------------------------------------------------
+RECT DrawUndoHistory::TileRect( int tile ) const
+{
+    const int tilesPerRow = ( m_width + TileSize - 1 ) / TileSize;
+    RECT rc;
+    rc.left = ( tile % tilesPerRow ) * TileSize;
+    rc.top = ( tile / tilesPerRow ) * TileSize;
+    rc.right = min( rc.left + TileSize, m_width );
+    rc.bottom = min( rc.top + TileSize, m_height );
+    return rc;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::TileBounds
+//
+//----------------------------------------------------------------------------
+RECT DrawUndoHistory::TileBounds( const RECT& region ) const
+{
+    const int left = max( static_cast<int>(region.left), 0 );
+    const int top = max( static_cast<int>(region.top), 0 );
+    const int right = min( static_cast<int>(region.right), m_width );
+    const int bottom = min( static_cast<int>(region.bottom), m_height );
+    if( left >= right || top >= bottom ) {
+
+        return RECT{ 0, 0, 0, 0 };
+    }
+
+    RECT rc;
+    rc.left = left / TileSize * TileSize;
+    rc.top = top / TileSize * TileSize;
+    rc.right = min( ( right + TileSize - 1 ) / TileSize * TileSize, m_width );
+    rc.bottom = min( ( bottom + TileSize - 1 ) / TileSize * TileSize, m_height );
+    return rc;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::TileChanged
+//
+//----------------------------------------------------------------------------
+bool DrawUndoHistory::TileChanged( int tile, const BYTE* pixels, size_t stride ) const
+{
+    const RECT rc = TileRect( tile );
+    const size_t rowBytes = static_cast<size_t>(rc.right - rc.left) * 4;
+    const size_t newestStride = static_cast<size_t>(m_width) * 4;
+    for( int y = rc.top; y < rc.bottom; y++ ) {
+
+        if( memcmp( m_newest.data() + y * newestStride + rc.left * 4,
+                    pixels + y * stride + rc.left * 4, rowBytes ) != 0 ) {
+
+            return true;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::Push
+//
+// The newest state is kept in full. Pushing a new state stores the previous
+// contents of the tiles that differ from it, compressed, and then updates
+// those tiles. The oldest deltas are dropped to stay within the budget.
+// Drawing only changes the tiles under the stroke, so with a dirty
+// rectangle the other tiles are not compared.
+//
+//----------------------------------------------------------------------------
+bool DrawUndoHistory::Push( const BYTE* pixels, int width, int height, size_t stride, const RECT* dirty )
+{
+    if( width <= 0 || height <= 0 ) {
+
+        return false;
+    }
+    if( width != m_width || height != m_height ) {
+
+        Clear();
+        m_width = width;
+        m_height = height;
+    }
+
+    const size_t newestStride = static_cast<size_t>(m_width) * 4;
+    bool pushed = true;
+    try {
+
+        if( m_newest.empty()) {
+
+            m_newest.resize( newestStride * m_height );
+            for( int y = 0; y < m_height; y++ ) {
+
+                memcpy( m_newest.data() + y * newestStride, pixels + y * stride, newestStride );
+            }
+            return true;
+        }
+
+        // Encode the changed tiles before touching the newest state, so that
+        // an allocation failure leaves the history intact
+        const int tilesPerRow = ( m_width + TileSize - 1 ) / TileSize;
+        const RECT bounds = dirty != NULL ? TileBounds( *dirty ) : RECT{ 0, 0, m_width, m_height };
+        std::vector<int> tiles;
+        for( int tileY = bounds.top / TileSize; tileY * TileSize < bounds.bottom; tileY++ ) {
+
+            for( int tileX = bounds.left / TileSize; tileX * TileSize < bounds.right; tileX++ ) {
+
+                tiles.push_back( tileY * tilesPerRow + tileX );
+            }
+        }
+
+        UndoDelta delta;
+        m_tilePixels.resize( TileSize * TileSize );
+        for( const int tile : tiles ) {
+
+            if( !TileChanged( tile, pixels, stride )) {
+
+                continue;
+            }
+
+            const RECT rc = TileRect( tile );
+            const int tileWidth = rc.right - rc.left;
+            for( int y = rc.top; y < rc.bottom; y++ ) {
+
+                memcpy( m_tilePixels.data() + ( y - rc.top ) * tileWidth,
+                        m_newest.data() + y * newestStride + rc.left * 4, tileWidth * 4 );
+            }
+
+            TileDelta tileDelta{ tile, delta.data.size(), 0 };
+            EncodePixelRuns( m_tilePixels.data(), static_cast<size_t>(tileWidth) * ( rc.bottom - rc.top ), delta.data );
+            tileDelta.size = delta.data.size() - tileDelta.offset;
+            delta.tiles.push_back( tileDelta );
+        }
+        delta.data.shrink_to_fit();
+
+        for( const auto& tileDelta : delta.tiles ) {
+
+            const RECT rc = TileRect( tileDelta.tile );
+            for( int y = rc.top; y < rc.bottom; y++ ) {
+
+                memcpy( m_newest.data() + y * newestStride + rc.left * 4,
+                        pixels + y * stride + rc.left * 4, static_cast<size_t>(rc.right - rc.left) * 4 );
+            }
+        }
+
+        m_deltaBytes += delta.data.size();
+        m_deltas.push_back( std::move( delta ));
+
+        // Memory is available again, stop trimming to the reduced budget
+        m_memoryBudget = m_configuredBudget;
+
+    } catch( const std::bad_alloc& ) {
+
+        OutputDebugStringW( L"DrawUndoHistory: out of memory\n" );
+        if( m_newest.empty()) {
+
+            // The first state could not be allocated, there is no history
+            Clear();
+            return false;
+        }
+        m_memoryBudget = m_deltaBytes / 2;
+        pushed = false;
+    }
+
+    // Always keep the newest delta, even if it alone exceeds the budget
+    while( m_deltaBytes > m_memoryBudget && m_deltas.size() > 1 ) {
+
+        m_deltaBytes -= m_deltas.front().data.size();
+        m_deltas.pop_front();
+    }
+    return pushed;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::Pop
+//
+//----------------------------------------------------------------------------
+bool DrawUndoHistory::Pop()
+{
+    if( m_newest.empty()) {
+
+        return false;
+    }
+    if( m_deltas.empty()) {
+
+        m_newest.clear();
+        m_newest.shrink_to_fit();
+        return true;
+    }
+
+    const size_t newestStride = static_cast<size_t>(m_width) * 4;
+    const UndoDelta& delta = m_deltas.back();
+    m_tilePixels.resize( TileSize * TileSize );
+    for( const auto& tileDelta : delta.tiles ) {
+
+        const RECT rc = TileRect( tileDelta.tile );
+        const int tileWidth = rc.right - rc.left;
+        if( !DecodePixelRuns( delta.data.data() + tileDelta.offset, tileDelta.size,
+                              m_tilePixels.data(), static_cast<size_t>(tileWidth) * ( rc.bottom - rc.top ))) {
+
+            OutputDebugStringW( L"DrawUndoHistory: corrupted tile\n" );
+            continue;
+        }
+        for( int y = rc.top; y < rc.bottom; y++ ) {
+
+            memcpy( m_newest.data() + y * newestStride + rc.left * 4,
+                    m_tilePixels.data() + ( y - rc.top ) * tileWidth, tileWidth * 4 );
+        }
+    }
+
+    m_deltaBytes -= delta.data.size();
+    m_deltas.pop_back();
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::FindTile
+//
+// The tiles of a delta are stored in increasing order.
+//
+//----------------------------------------------------------------------------
+const DrawUndoHistory::TileDelta* DrawUndoHistory::FindTile( const UndoDelta& delta, int tile )
+{
+    auto it = std::lower_bound( delta.tiles.begin(), delta.tiles.end(), tile,
+                                []( const TileDelta& tileDelta, int value ) { return tileDelta.tile < value; } );
+    return it != delta.tiles.end() && it->tile == tile ? &*it : NULL;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::CopyOldest
+//
+// A tile of the oldest state is stored in the oldest delta that recorded a
+// change to it. Tiles that never changed are the same as in the newest
+// state.
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::CopyOldest( const RECT& region, BYTE* dest, size_t destStride ) const
+{
+    const int left = max( static_cast<int>(region.left), 0 );
+    const int top = max( static_cast<int>(region.top), 0 );
+    const int right = min( static_cast<int>(region.right), m_width );
+    const int bottom = min( static_cast<int>(region.bottom), m_height );
+    if( m_newest.empty() || left >= right || top >= bottom ) {
+
+        return;
+    }
+
+    const size_t newestStride = static_cast<size_t>(m_width) * 4;
+    const int tilesPerRow = ( m_width + TileSize - 1 ) / TileSize;
+    std::vector<UINT32> tilePixels;
+    for( int tileY = top / TileSize; tileY <= ( bottom - 1 ) / TileSize; tileY++ ) {
+
+        for( int tileX = left / TileSize; tileX <= ( right - 1 ) / TileSize; tileX++ ) {
+
+            const int tile = tileY * tilesPerRow + tileX;
+            const RECT rc = TileRect( tile );
+            const int copyLeft = max( static_cast<int>(rc.left), left );
+            const int copyRight = min( static_cast<int>(rc.right), right );
+            const size_t copyBytes = static_cast<size_t>(copyRight - copyLeft) * 4;
+
+            const BYTE* source = m_newest.data() + copyLeft * 4;
+            size_t sourceStride = newestStride;
+            int sourceTop = 0;
+            for( const auto& delta : m_deltas ) {
+
+                const TileDelta* tileDelta = FindTile( delta, tile );
+                if( tileDelta == NULL ) {
+
+                    continue;
+                }
+
+                const int tileWidth = rc.right - rc.left;
+                tilePixels.resize( static_cast<size_t>(tileWidth) * ( rc.bottom - rc.top ));
+                if( DecodePixelRuns( delta.data.data() + tileDelta->offset, tileDelta->size,
+                                     tilePixels.data(), tilePixels.size() )) {
+
+                    source = reinterpret_cast<const BYTE*>(tilePixels.data()) + ( copyLeft - rc.left ) * 4;
+                    sourceStride = static_cast<size_t>(tileWidth) * 4;
+                    sourceTop = rc.top;
+                } else {
+
+                    OutputDebugStringW( L"DrawUndoHistory: corrupted tile\n" );
+                }
+                break;
+            }
+
+            for( int y = max( static_cast<int>(rc.top), top ); y < min( static_cast<int>(rc.bottom), bottom ); y++ ) {
+
+                memcpy( dest + ( y - region.top ) * destStride + ( copyLeft - region.left ) * 4,
+                        source + ( y - sourceTop ) * sourceStride, copyBytes );
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::Clear
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::Clear()
+{
+    m_deltas.clear();
+    m_deltaBytes = 0;
+    m_newest.clear();
+    m_newest.shrink_to_fit();
+    m_tilePixels.clear();
+    m_tilePixels.shrink_to_fit();
+}
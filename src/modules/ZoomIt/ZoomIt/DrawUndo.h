@@ -0,0 +1,80 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Drawing undo history that stores only the screen tiles changed between
+// undo states
+//
+//==============================================================================
+#pragma once
+
+#include <windows.h>
+
+#include <deque>
+#include <vector>
+
+class DrawUndoHistory
+{
+public:
+    static const int TileSize = 64;
+
+    DrawUndoHistory( size_t memoryBudget ) : m_configuredBudget( memoryBudget ), m_memoryBudget( memoryBudget ) {}
+
+    // Records a copy of the 32bpp top-down pixels as the newest undo state.
+    // With a dirty rectangle only the tiles it touches are compared to the
+    // newest state, the pixels outside of TileBounds( *dirty ) are not read.
+    // The first push after Clear or a size change reads all of the pixels.
+    bool Push( const BYTE* pixels, int width, int height, size_t stride, const RECT* dirty = NULL );
+
+    // Discards the newest undo state, the previous one becomes the newest.
+    bool Pop();
+    void Clear();
+
+    bool IsEmpty() const { return m_newest.empty(); }
+    size_t Count() const { return m_newest.empty() ? 0 : m_deltas.size() + 1; }
+    size_t DeltaBytes() const { return m_deltaBytes; }
+
+    // The newest undo state, Width() * 4 bytes per row.
+    const BYTE* Newest() const { return m_newest.data(); }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    // The region grown to the tiles it touches, clipped to the undo states.
+    RECT TileBounds( const RECT& region ) const;
+
+    // Copies a region of the oldest undo state to a 32bpp top-down buffer.
+    // The parts of the region outside of the undo states are left untouched.
+    void CopyOldest( const RECT& region, BYTE* dest, size_t destStride ) const;
+
+private:
+    struct TileDelta
+    {
+        int tile;
+        size_t offset;
+        size_t size;
+    };
+
+    // Previous contents of the tiles that changed between two undo states
+    struct UndoDelta
+    {
+        std::vector<TileDelta> tiles;
+        std::vector<BYTE> data;
+    };
+
+    size_t m_configuredBudget;
+    size_t m_memoryBudget;
+    size_t m_deltaBytes = 0;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<BYTE> m_newest;
+    std::deque<UndoDelta> m_deltas;
+    std::vector<UINT32> m_tilePixels;
+
+    RECT TileRect( int tile ) const;
+    bool TileChanged( int tile, const BYTE* pixels, size_t stride ) const;
+    static const TileDelta* FindTile( const UndoDelta& delta, int tile );
+};
+
+void EncodePixelRuns( const UINT32* pixels, size_t count, std::vector<BYTE>& output );
+bool DecodePixelRuns( const BYTE* data, size_t size, UINT32* pixels, size_t count );
@@ -0,0 +1,380 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Pixel effects for the blur and highlighter pens
+//
+//==============================================================================
+#include "pch.h"
+#include "DrawingEffects.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define ZOOMIT_X86_SIMD
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Three box blur passes approximate a gaussian blur
+    const int BLUR_PASSES = 3;
+
+#ifdef ZOOMIT_X86_SIMD
+    //----------------------------------------------------------------------------
+    //
+    // HasAvx2
+    //
+    // SSE2 is always available on x86/x64, AVX2 has to be checked at runtime.
+    //
+    //----------------------------------------------------------------------------
+    bool HasAvx2()
+    {
+        static const bool hasAvx2 = [] {
+            int info[4];
+            __cpuid( info, 0 );
+            if( info[0] < 7 ) {
+                return false;
+            }
+
+            __cpuid( info, 1 );
+            const bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+            const bool avx = ( info[2] & ( 1 << 28 ) ) != 0;
+            if( !osxsave || !avx || ( _xgetbv( 0 ) & 0x6 ) != 0x6 ) {
+                return false;
+            }
+
+            __cpuidex( info, 7, 0 );
+            return ( info[1] & ( 1 << 5 ) ) != 0;
+        }();
+        return hasAvx2;
+    }
+#endif
+
+    //----------------------------------------------------------------------------
+    //
+    // BoxBlurRow
+    //
+    // Horizontal box blur of a single row using a running sum. Edge pixels
+    // are repeated past the row bounds.
+    //
+    //----------------------------------------------------------------------------
+    void BoxBlurRow( const BYTE* src, BYTE* dst, int width, int radius, float scale )
+    {
+        const UINT32* srcPixels = reinterpret_cast<const UINT32*>(src);
+        UINT32* dstPixels = reinterpret_cast<UINT32*>(dst);
+
+#ifdef ZOOMIT_X86_SIMD
+        // One pixel per register, a 32-bit lane per channel
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 factor = _mm_set1_ps( scale );
+        auto load = [&]( int x ) {
+            __m128i pixel = _mm_cvtsi32_si128( static_cast<int>(srcPixels[std::clamp( x, 0, width - 1 )]) );
+            return _mm_unpacklo_epi16( _mm_unpacklo_epi8( pixel, zero ), zero );
+        };
+
+        __m128i sum = zero;
+        for( int x = -radius; x <= radius; x++ ) {
+            sum = _mm_add_epi32( sum, load( x ) );
+        }
+
+        for( int x = 0; x < width; x++ ) {
+            __m128i value = _mm_cvtps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( sum ), factor ) );
+            value = _mm_packs_epi32( value, value );
+            dstPixels[x] = static_cast<UINT32>(_mm_cvtsi128_si32( _mm_packus_epi16( value, value ) ));
+            sum = _mm_add_epi32( sum, _mm_sub_epi32( load( x + radius + 1 ), load( x - radius ) ) );
+        }
+#else
+        auto load = [&]( int x, int channel ) {
+            return static_cast<int>(( srcPixels[std::clamp( x, 0, width - 1 )] >> ( channel * 8 ) ) & 0xFF);
+        };
+
+        int sum[4] = {};
+        for( int x = -radius; x <= radius; x++ ) {
+            for( int channel = 0; channel < 4; channel++ ) {
+                sum[channel] += load( x, channel );
+            }
+        }
+
+        for( int x = 0; x < width; x++ ) {
+            UINT32 pixel = 0;
+            for( int channel = 0; channel < 4; channel++ ) {
+                pixel |= static_cast<UINT32>(lrintf( sum[channel] * scale )) << ( channel * 8 );
+                sum[channel] += load( x + radius + 1, channel ) - load( x - radius, channel );
+            }
+            dstPixels[x] = pixel;
+        }
+#endif
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // StoreColumnSums
+    //
+    // Scales the per-channel column sums back to bytes.
+    //
+    //----------------------------------------------------------------------------
+    void StoreColumnSums( const int* sums, BYTE* dst, int count, float scale )
+    {
+        int i = 0;
+#ifdef ZOOMIT_X86_SIMD
+        if( HasAvx2() ) {
+            const __m256 factor = _mm256_set1_ps( scale );
+            for( ; i + 16 <= count; i += 16 ) {
+                __m256i low = _mm256_cvtps_epi32( _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i*>(sums + i) ) ), factor ) );
+                __m256i high = _mm256_cvtps_epi32( _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i*>(sums + i + 8) ) ), factor ) );
+
+                // packs works per 128-bit lane, restore the order before narrowing to bytes
+                __m256i words = _mm256_permute4x64_epi64( _mm256_packs_epi32( low, high ), 0xD8 );
+                __m128i bytes = _mm_packus_epi16( _mm256_castsi256_si128( words ), _mm256_extracti128_si256( words, 1 ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i), bytes );
+            }
+        }
+        else {
+            const __m128 factor = _mm_set1_ps( scale );
+            for( ; i + 16 <= count; i += 16 ) {
+                __m128i value[4];
+                for( int k = 0; k < 4; k++ ) {
+                    value[k] = _mm_cvtps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>(sums + i + k * 4) ) ), factor ) );
+                }
+
+                __m128i bytes = _mm_packus_epi16( _mm_packs_epi32( value[0], value[1] ), _mm_packs_epi32( value[2], value[3] ) );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i), bytes );
+            }
+        }
+#endif
+        for( ; i < count; i++ ) {
+            dst[i] = static_cast<BYTE>(lrintf( sums[i] * scale ));
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // UpdateColumnSums
+    //
+    // Slides the vertical window by a row: adds the entering row and
+    // subtracts the leaving one.
+    //
+    //----------------------------------------------------------------------------
+    void UpdateColumnSums( int* sums, const BYTE* addRow, const BYTE* subRow, int count )
+    {
+        int i = 0;
+#ifdef ZOOMIT_X86_SIMD
+        if( HasAvx2() ) {
+            for( ; i + 16 <= count; i += 16 ) {
+                __m256i add = _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>(addRow + i) ) );
+                __m256i sub = _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>(subRow + i) ) );
+                __m256i diff = _mm256_sub_epi16( add, sub );
+
+                __m256i* low = reinterpret_cast<__m256i*>(sums + i);
+                __m256i* high = reinterpret_cast<__m256i*>(sums + i + 8);
+                _mm256_storeu_si256( low, _mm256_add_epi32( _mm256_loadu_si256( low ), _mm256_cvtepi16_epi32( _mm256_castsi256_si128( diff ) ) ) );
+                _mm256_storeu_si256( high, _mm256_add_epi32( _mm256_loadu_si256( high ), _mm256_cvtepi16_epi32( _mm256_extracti128_si256( diff, 1 ) ) ) );
+            }
+        }
+        else {
+            const __m128i zero = _mm_setzero_si128();
+            for( ; i + 16 <= count; i += 16 ) {
+                __m128i add = _mm_loadu_si128( reinterpret_cast<const __m128i*>(addRow + i) );
+                __m128i sub = _mm_loadu_si128( reinterpret_cast<const __m128i*>(subRow + i) );
+                __m128i diff[2] = {
+                    _mm_sub_epi16( _mm_unpacklo_epi8( add, zero ), _mm_unpacklo_epi8( sub, zero ) ),
+                    _mm_sub_epi16( _mm_unpackhi_epi8( add, zero ), _mm_unpackhi_epi8( sub, zero ) )
+                };
+
+                for( int k = 0; k < 2; k++ ) {
+                    // sign extend the 16-bit differences
+                    __m128i* low = reinterpret_cast<__m128i*>(sums + i + k * 8);
+                    __m128i* high = reinterpret_cast<__m128i*>(sums + i + k * 8 + 4);
+                    _mm_storeu_si128( low, _mm_add_epi32( _mm_loadu_si128( low ), _mm_srai_epi32( _mm_unpacklo_epi16( diff[k], diff[k] ), 16 ) ) );
+                    _mm_storeu_si128( high, _mm_add_epi32( _mm_loadu_si128( high ), _mm_srai_epi32( _mm_unpackhi_epi16( diff[k], diff[k] ), 16 ) ) );
+                }
+            }
+        }
+#endif
+        for( ; i < count; i++ ) {
+            sums[i] += addRow[i] - subRow[i];
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // BoxBlurColumns
+    //
+    // Vertical box blur. Works on whole rows at a time so that the memory is
+    // walked sequentially instead of striding down each column.
+    //
+    //----------------------------------------------------------------------------
+    void BoxBlurColumns( const BYTE* src, size_t srcStride, BYTE* dst, size_t dstStride,
+                         int width, int height, int radius, float scale, std::vector<int>& sums )
+    {
+        const int count = width * 4;
+        sums.assign( count, 0 );
+        for( int k = -radius; k <= radius; k++ ) {
+            const BYTE* row = src + std::clamp( k, 0, height - 1 ) * srcStride;
+            for( int i = 0; i < count; i++ ) {
+                sums[i] += row[i];
+            }
+        }
+
+        for( int y = 0; y < height; y++ ) {
+            StoreColumnSums( sums.data(), dst + y * dstStride, count, scale );
+            UpdateColumnSums( sums.data(),
+                              src + (std::min)( y + radius + 1, height - 1 ) * srcStride,
+                              src + (std::max)( y - radius, 0 ) * srcStride,
+                              count );
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // CompositeMaskedRow
+    //
+    // Where the mask alpha is non-zero, replaces the destination color with
+    // the source color ANDed with colorMask, keeping the destination alpha.
+    // The pen color is splatted once per row so every pixel is a single
+    // select in the vector loops.
+    //
+    //----------------------------------------------------------------------------
+    void CompositeMaskedRow( UINT32* dest, const UINT32* source, const UINT32* mask, int width, UINT32 colorMask )
+    {
+        int x = 0;
+#ifdef ZOOMIT_X86_SIMD
+        if( HasAvx2() ) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i colorBits = _mm256_set1_epi32( 0x00FFFFFF );
+            const __m256i color = _mm256_set1_epi32( static_cast<int>(colorMask) );
+            for( ; x + 8 <= width; x += 8 ) {
+                __m256i alpha = _mm256_srli_epi32( _mm256_loadu_si256( reinterpret_cast<const __m256i*>(mask + x) ), 24 );
+                __m256i select = _mm256_andnot_si256( _mm256_cmpeq_epi32( alpha, zero ), colorBits );
+                __m256i sourcePixels = _mm256_and_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>(source + x) ), color );
+                __m256i destPixels = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(dest + x) );
+                _mm256_storeu_si256( reinterpret_cast<__m256i*>(dest + x),
+                                     _mm256_or_si256( _mm256_and_si256( select, sourcePixels ), _mm256_andnot_si256( select, destPixels ) ) );
+            }
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i colorBits = _mm_set1_epi32( 0x00FFFFFF );
+        const __m128i color = _mm_set1_epi32( static_cast<int>(colorMask) );
+        for( ; x + 4 <= width; x += 4 ) {
+            __m128i alpha = _mm_srli_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>(mask + x) ), 24 );
+            __m128i select = _mm_andnot_si128( _mm_cmpeq_epi32( alpha, zero ), colorBits );
+            __m128i sourcePixels = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>(source + x) ), color );
+            __m128i destPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>(dest + x) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>(dest + x),
+                              _mm_or_si128( _mm_and_si128( select, sourcePixels ), _mm_andnot_si128( select, destPixels ) ) );
+        }
+#endif
+        for( ; x < width; x++ ) {
+            if( mask[x] >> 24 ) {
+                dest[x] = ( dest[x] & 0xFF000000 ) | ( source[x] & colorMask );
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // AdjustHighlighterColor
+    //
+    // Lighten the color.
+    //
+    //----------------------------------------------------------------------------
+    void AdjustHighlighterColor( BYTE* red, BYTE* green, BYTE* blue )
+    {
+        // Adjust the color to be more visible
+        *red = min( 0xFF, *red ? *red + 0x40 : *red + 0x80 );
+        *green = min( 0xFF, *green ? *green + 0x40 : *green + 0x80 );
+        *blue = min( 0xFF, *blue ? *blue + 0x40 : *blue + 0x80 );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// BlurPixels
+//
+// Blurs the buffer in place with a separable box filter applied
+// BLUR_PASSES times. The radius is the GDI+ blur effect radius, the
+// distance past which a pixel no longer spreads. The result is close to
+// the GDI+ effect but not identical: the box passes weigh the neighbours a
+// little differently from the GDI+ kernel, and pixels past the edges of
+// the buffer repeat the edge pixels.
+//
+//----------------------------------------------------------------------------
+void BlurPixels( BYTE* pixels, int width, int height, size_t stride, int radius )
+{
+    if( pixels == NULL || width <= 0 || height <= 0 || radius <= 0 ) {
+        return;
+    }
+
+    // Three passes of a box with a third of the radius reach as far
+    const int boxRadius = (std::max)( 1, ( radius + BLUR_PASSES - 1 ) / BLUR_PASSES );
+    const float scale = 1.0f / static_cast<float>(2 * boxRadius + 1);
+
+    const size_t tempStride = static_cast<size_t>(width) * 4;
+    std::vector<BYTE> temp( tempStride * height );
+    std::vector<int> sums;
+
+    for( int pass = 0; pass < BLUR_PASSES; pass++ ) {
+        for( int y = 0; y < height; y++ ) {
+            BoxBlurRow( pixels + y * stride, temp.data() + y * tempStride, width, boxRadius, scale );
+        }
+        BoxBlurColumns( temp.data(), tempStride, pixels, stride, width, height, boxRadius, scale, sums );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// CompositeMaskedPixels
+//
+// Copies the color of the source pixels to the destination wherever the
+// mask pixel has a non-zero alpha. The destination alpha is preserved.
+//
+//----------------------------------------------------------------------------
+void CompositeMaskedPixels( BYTE* dest, size_t destStride, const BYTE* source, size_t sourceStride,
+                            const BYTE* mask, size_t maskStride, int width, int height )
+{
+    for( int y = 0; y < height; y++ ) {
+        CompositeMaskedRow( reinterpret_cast<UINT32*>(dest + y * destStride),
+                            reinterpret_cast<const UINT32*>(source + y * sourceStride),
+                            reinterpret_cast<const UINT32*>(mask + y * maskStride),
+                            width, 0x00FFFFFF );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// HighlightPixels
+//
+// Applies the highlighter wherever the mask pixel has a non-zero alpha:
+// the destination color becomes the source color ANDed with the
+// highlighter color, a BGR pixel value. The destination alpha is preserved.
+//
+//----------------------------------------------------------------------------
+void HighlightPixels( BYTE* dest, size_t destStride, const BYTE* source, size_t sourceStride,
+                      const BYTE* mask, size_t maskStride, int width, int height, UINT32 highlightColor )
+{
+    for( int y = 0; y < height; y++ ) {
+        CompositeMaskedRow( reinterpret_cast<UINT32*>(dest + y * destStride),
+                            reinterpret_cast<const UINT32*>(source + y * sourceStride),
+                            reinterpret_cast<const UINT32*>(mask + y * maskStride),
+                            width, highlightColor & 0x00FFFFFF );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// GetHighlighterColor
+//
+// Returns the lightened pen color as a BGR pixel value. The highlighter
+// ANDs it with the screen pixels under the stroke.
+//
+//----------------------------------------------------------------------------
+UINT32 GetHighlighterColor( COLORREF penColor )
+{
+    BYTE red = GetRValue( penColor );
+    BYTE green = GetGValue( penColor );
+    BYTE blue = GetBValue( penColor );
+    AdjustHighlighterColor( &red, &green, &blue );
+    return ( static_cast<UINT32>(red) << 16 ) | ( static_cast<UINT32>(green) << 8 ) | blue;
+}
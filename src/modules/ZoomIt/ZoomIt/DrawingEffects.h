@@ -0,0 +1,19 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Pixel effects for the blur and highlighter pens. All the functions work
+// on top-down 32bpp BGRA buffers.
+//
+//==============================================================================
+#pragma once
+
+#include <windows.h>
+
+void BlurPixels( BYTE* pixels, int width, int height, size_t stride, int radius );
+void CompositeMaskedPixels( BYTE* dest, size_t destStride, const BYTE* source, size_t sourceStride,
+                            const BYTE* mask, size_t maskStride, int width, int height );
+void HighlightPixels( BYTE* dest, size_t destStride, const BYTE* source, size_t sourceStride,
+                      const BYTE* mask, size_t maskStride, int width, int height, UINT32 highlightColor );
+UINT32 GetHighlighterColor( COLORREF penColor );
@@ -43,7 +43,8 @@ type_pEnableThemeDialogTexture    pEnableThemeDialogTexture;
 // of live zooming on Vista/ws2k8
 #define LIVEZOOM_WINDOW_TIMEOUT	2*3600*1000
 
-#define MAX_UNDO_HISTORY	32
+// Memory for the drawing undo history besides the newest full screen copy
+#define MAX_UNDO_MEMORY		(256 * 1024 * 1024)
 
 #define PEN_WIDTH			5
 #define MIN_PEN_WIDTH        2
@@ -68,12 +69,6 @@ typedef struct _TYPED_KEY {
     struct _TYPED_KEY *Next;	
 } TYPED_KEY, *P_TYPED_KEY;
 
-typedef struct _DRAW_UNDO {
-    HDC			hDc;
-    HBITMAP		hBitmap;
-    struct _DRAW_UNDO *Next;
-} DRAW_UNDO, *P_DRAW_UNDO;
-
 typedef struct {
     TCHAR		TabTitle[64];
     HWND		hPage;
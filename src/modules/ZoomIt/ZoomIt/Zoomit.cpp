@@ -13,6 +13,8 @@
 
 #include "zoomit.h"
 #include "Utility.h"
+#include "DrawingEffects.h"
+#include "DrawUndo.h"
 #include "WindowsVersions.h"
 #include "ZoomItSettings.h"
 
@@ -750,30 +752,6 @@ void InvalidateGdiplusRect(HWND hWnd, Gdiplus::Rect BoundsRect)
 
 
 
-//----------------------------------------------------------------------------
-//
-// CreateGdiplusBitmap
-//
-// Creates a gdiplus bitmap of the specified region of the HDC.  
-// 
-//----------------------------------------------------------------------------
-Gdiplus::Bitmap *CreateGdiplusBitmap( HDC hDc, int x, int y, int Width, int Height )
-{
-    HBITMAP hBitmap = CreateCompatibleBitmap(hDc, Width, Height);
-
-    // Create a device context for the new bitmap
-    HDC hdcNewBitmap = CreateCompatibleDC(hDc);
-    SelectObject(hdcNewBitmap, hBitmap);
-
-    // Copy from the oldest undo bitmap to the new bitmap using the lineBounds as the source rectangle
-    BitBlt(hdcNewBitmap, 0, 0, Width, Height, hDc, x, y, SRCCOPY);
-    Gdiplus::Bitmap *blurBitmap = new Gdiplus::Bitmap(hBitmap, NULL);
-    DeleteDC(hdcNewBitmap);
-    DeleteObject(hBitmap);
-    return blurBitmap; 
-}
-
-
 //----------------------------------------------------------------------------
 //
 // CreateBitmapMemoryDIB
@@ -844,41 +822,29 @@ Gdiplus::BitmapData* LockGdiPlusBitmap(Gdiplus::Bitmap* Bitmap)
 //
 // BlurScreen
 //
-// Blur the portion of the screen by copying a blurred bitmap with the 
-// specified shape. 
+// Blur the portion of the screen covered by the drawn pixels of the shape
+// bitmap. Only the shape bounds are copied and blurred.
 // 
 //----------------------------------------------------------------------------
 void BlurScreen(HDC hdcScreenCompat, Gdiplus::Rect* lineBounds, 
-                    Gdiplus::Bitmap *BlurBitmap, BYTE* pPixels)
+                    const BYTE* pPixels, size_t pixelsStride)
 {
     HDC hdcDIB;
     HBITMAP hDibOrigBitmap, hDibBitmap;
     BYTE* pDestPixels = CreateBitmapMemoryDIB(hdcScreenCompat, hdcScreenCompat, lineBounds,
                                 &hdcDIB, &hDibBitmap, &hDibOrigBitmap);
+    if( pDestPixels == NULL ) {
 
-    // Iterate through the pixels
-    for (int y = 0; y < lineBounds->Height; ++y) {
-        for (int x = 0; x < lineBounds->Width; ++x) {
-            int index = (y * lineBounds->Width * 4) + (x * 4);  // Assuming 4 bytes per pixel
-            // BYTE b = pPixels[index + 0];  // Blue channel
-            // BYTE g = pPixels[index + 1];  // Green channel
-            // BYTE r = pPixels[index + 2];  // Red channel
-            BYTE a = pPixels[index + 3];  // Alpha channel
-
-            // Check if this is a drawn pixel
-            if (a != 0) {
-                // get the blur pixel
-                Gdiplus::Color pixel;
-                BlurBitmap->GetPixel(x, y, &pixel);
-
-                COLORREF newPixel = pixel.GetValue() & 0xFFFFFF;
-                pDestPixels[index + 0] = GetRValue(newPixel);
-                pDestPixels[index + 1] = GetGValue(newPixel);
-                pDestPixels[index + 2] = GetBValue(newPixel);
-            }
-        }
+        return;
     }
 
+    // Blur a copy of the screen pixels and take the drawn pixels from it
+    const size_t stride = static_cast<size_t>(lineBounds->Width) * 4;
+    std::vector<BYTE> blurPixels(pDestPixels, pDestPixels + stride * lineBounds->Height);
+    BlurPixels(blurPixels.data(), lineBounds->Width, lineBounds->Height, stride, static_cast<int>(g_BlurRadius));
+    CompositeMaskedPixels(pDestPixels, stride, blurPixels.data(), stride, pPixels, pixelsStride,
+                          lineBounds->Width, lineBounds->Height);
+
     // Copy the updated DIB back to hdcScreenCompat
     BitBlt(hdcScreenCompat, lineBounds->X, lineBounds->Y, lineBounds->Width, lineBounds->Height, hdcDIB, 0, 0, SRCCOPY);
 
@@ -889,38 +855,6 @@ void BlurScreen(HDC hdcScreenCompat, Gdiplus::Rect* lineBounds,
 }
 
 
-
-//----------------------------------------------------------------------------
-//
-// BitmapBlur
-//
-// Blurs the bitmap. 
-// 
-//----------------------------------------------------------------------------
-void BitmapBlur(Gdiplus::Bitmap* hBitmap)
-{
-    // Git bitmap size
-    Gdiplus::Size bitmapSize;
-    bitmapSize.Width = hBitmap->GetWidth();
-    bitmapSize.Height = hBitmap->GetHeight();
-
-    // Blur the new bitmap
-    Gdiplus::Blur blurObject;
-    Gdiplus::BlurParams blurParams;
-    blurParams.radius = g_BlurRadius;
-    blurParams.expandEdge = FALSE;
-    blurObject.SetParameters(&blurParams);
-
-    // Apply blur to image
-    RECT linesRect;
-    linesRect.left = 0;
-    linesRect.top = 0;
-    linesRect.right = bitmapSize.Width;
-    linesRect.bottom = bitmapSize.Height;
-    hBitmap->ApplyEffect(&blurObject, &linesRect);
-}
-
-
 //----------------------------------------------------------------------------
 //
 // DrawBlurredShape
@@ -957,18 +891,12 @@ void DrawBlurredShape( DWORD Shape, Gdiplus::Pen *pen, HDC hdcScreenCompat, Gdip
     Gdiplus::BitmapData* lineData = LockGdiPlusBitmap(lineBitmap);
     BYTE* pPixels = static_cast<BYTE*>(lineData->Scan0);
 
-    // Create a GDI bitmap that's the size of the lineBounds rectangle
-    Gdiplus::Bitmap* blurBitmap = CreateGdiplusBitmap(hdcScreenCompat,
-        lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height);
-
     // Blur it
-    BitmapBlur(blurBitmap);
-    BlurScreen(hdcScreenCompat, &lineBounds, blurBitmap, pPixels);
+    BlurScreen(hdcScreenCompat, &lineBounds, pPixels, lineData->Stride);
 
     // Unlock the bits
     lineBitmap->UnlockBits(lineData);
     delete lineBitmap;
-    delete blurBitmap;
 }
 
 //----------------------------------------------------------------------------
@@ -1022,70 +950,6 @@ Gdiplus::Color ColorFromColorRef(DWORD colorRef) {
     return Gdiplus::Color(a, r, g, b);
 }
 
-//----------------------------------------------------------------------------
-//
-// AdjustHighlighterColor
-//
-// Lighten the color. 
-// 
-//----------------------------------------------------------------------------
-void AdjustHighlighterColor(BYTE* red, BYTE* green, BYTE* blue) {
-
-    // Adjust the color to be more visible
-    *red = min( 0xFF, *red ? *red + 0x40 : *red + 0x80 );
-    *green = min( 0xFF, *green ? *green + 0x40 : *green + 0x80);
-    *blue = min( 0xFF, *blue ? *blue + 0x40 : *blue + 0x80);
-}
-
-//----------------------------------------------------------------------------
-//
-// BlendColors
-//
-// Blends two colors together using the alpha channel of the second color.
-// The highlighter is the second color. 
-// 
-//----------------------------------------------------------------------------
-COLORREF BlendColors(COLORREF color1, const Gdiplus::Color& color2) {
-
-    BYTE redResult, greenResult, blueResult;
-
-    // Extract the channels from the COLORREF
-    BYTE red1 = GetRValue(color1);
-    BYTE green1 = GetGValue(color1);
-    BYTE blue1 = GetBValue(color1);
-
-    // Get the channels and alpha from the Gdiplus::Color
-    BYTE blue2 = color2.GetRed();
-    BYTE green2 = color2.GetGreen();
-    BYTE red2 = color2.GetBlue();
-    float alpha2 = color2.GetAlpha() / 255.0f;  // Normalize to [0, 1]
-    //alpha2 /= 2; // Use half the alpha for higher contrast
-
-    // Don't blend grey's as much
-    // int minValue = min(red1, min(green1, blue1));
-    // int maxValue = max(red1, max(green1, blue1));
-    if(TRUE) { // red1 > 0x10 && red1 < 0xC0 && (maxValue - minValue < 0x40)) {
-
-        // This does a standard bright highlight	
-        alpha2 = 0;
-        AdjustHighlighterColor( &red2, &green2, &blue2 );
-        redResult	= red2 & red1;
-        greenResult = green2 & green1;
-        blueResult	= blue2 & blue1;
-    }
-    else {
-
-        // Blend each channel
-        redResult = static_cast<BYTE>(red2 * alpha2 + red1 * (1 - alpha2));
-        greenResult = static_cast<BYTE>(green2 * alpha2 + green1 * (1 - alpha2));
-        blueResult = static_cast<BYTE>(blue2 * alpha2 + blue1 * (1 - alpha2));
-    }
-    // Combine the result channels back into a COLORREF
-    return RGB(redResult, greenResult, blueResult);
-}
-
-
-
 //----------------------------------------------------------------------------
 //
 // DrawHighlightedShape
@@ -1147,32 +1011,9 @@ void DrawHighlightedShape( DWORD Shape, HDC hdcScreenCompat, Gdiplus::Brush *pBr
     BYTE* pDestPixels2 = CreateBitmapMemoryDIB(hdcScreenCompat, hdcScreenCompat, &lineBounds,
         &hdcDIBOrig, &hDibBitmap, &hDibOrigBitmap);
 
-    for (int y = 0; y < lineBounds.Height; ++y) {
-        for (int x = 0; x < lineBounds.Width; ++x) {
-            int index = (y * lineBounds.Width * 4) + (x * 4);  // Assuming 4 bytes per pixel
-            // BYTE b = pPixels[index + 0];  // Blue channel
-            // BYTE g = pPixels[index + 1];  // Green channel
-            // BYTE r = pPixels[index + 2];  // Red channel
-            BYTE a = pPixels[index + 3];  // Alpha channel
-
-            // Check if this is a drawn pixel
-            if (a != 0) {
-                // Assuming pDestPixels is a valid pointer to the destination bitmap's pixel data
-                BYTE destB = pDestPixels2[index + 0];  // Blue channel
-                BYTE destG = pDestPixels2[index + 1];  // Green channel
-                BYTE destR = pDestPixels2[index + 2];  // Red channel
-
-                // Create a COLORREF value from the destination pixel data
-                COLORREF currentPixel = RGB(destR, destG, destB);
-                // Blend the colors
-                COLORREF newPixel = BlendColors(currentPixel, g_PenColor);
-                // Update the destination pixel data with the new color
-                pDestPixels[index + 0] = GetBValue(newPixel);
-                pDestPixels[index + 1] = GetGValue(newPixel);
-                pDestPixels[index + 2] = GetRValue(newPixel);
-            }
-        }
-    }
+    // Highlight the drawn pixels
+    HighlightPixels(pDestPixels, static_cast<size_t>(lineBounds.Width) * 4, pDestPixels2, static_cast<size_t>(lineBounds.Width) * 4,
+                    pPixels, lineData->Stride, lineBounds.Width, lineBounds.Height, GetHighlighterColor(g_PenColor));
 
     // Copy the updated DIB back to hdcScreenCompat
     BitBlt(hdcScreenCompat, lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height, hdcDIB, 0, 0, SRCCOPY);
@@ -2352,152 +2193,146 @@ INT_PTR CALLBACK OptionsProc( HWND hDlg, UINT message,
 
 //----------------------------------------------------------------------------
 //
-// DeleteDrawUndoList
+// UndoScreenBitmap
+//
+// DIB section the screen is copied into before its pixels are recorded in
+// the undo history. Kept across pushes to avoid allocating on every stroke.
 //
 //----------------------------------------------------------------------------
-void DeleteDrawUndoList( P_DRAW_UNDO *DrawUndoList )
-{
-    P_DRAW_UNDO	nextUndo;
+struct UndoScreenBitmap {
+    HDC			hDc = NULL;
+    HBITMAP		hBitmap = NULL;
+    HBITMAP		hPrevBitmap = NULL;
+    BYTE*		pPixels = NULL;
+    int			width = 0;
+    int			height = 0;
+};
+
+static UndoScreenBitmap g_UndoScreenBitmap;
 
-    nextUndo = *DrawUndoList;
-    while( nextUndo ) {
+void DeleteUndoScreenBitmap()
+{
+    if( g_UndoScreenBitmap.hDc ) {
 
-        *DrawUndoList = nextUndo->Next;
-        DeleteObject( nextUndo->hBitmap );
-        DeleteDC( nextUndo->hDc );
-        free( nextUndo );
-        nextUndo = *DrawUndoList;
+        SelectObject( g_UndoScreenBitmap.hDc, g_UndoScreenBitmap.hPrevBitmap );
+        DeleteObject( g_UndoScreenBitmap.hBitmap );
+        DeleteDC( g_UndoScreenBitmap.hDc );
     }
-    *DrawUndoList = NULL;
+    g_UndoScreenBitmap = {};
 }
 
-//----------------------------------------------------------------------------
-//
-// PopDrawUndo
-//
-//----------------------------------------------------------------------------
-BOOLEAN PopDrawUndo( HDC hDc, P_DRAW_UNDO *DrawUndoList, 
-                  int width, int height )
+BYTE* CaptureUndoScreenBitmap( HDC hDc, int width, int height, const RECT& region )
 {
-    P_DRAW_UNDO	nextUndo;
+    if( g_UndoScreenBitmap.width != width || g_UndoScreenBitmap.height != height ) {
 
-    nextUndo = *DrawUndoList;
-    if( nextUndo ) {
+        DeleteUndoScreenBitmap();
+        Gdiplus::Rect bounds( 0, 0, width, height );
+        g_UndoScreenBitmap.pPixels = CreateBitmapMemoryDIB( hDc, hDc, &bounds, &g_UndoScreenBitmap.hDc,
+                                        &g_UndoScreenBitmap.hBitmap, &g_UndoScreenBitmap.hPrevBitmap );
+        if( g_UndoScreenBitmap.pPixels == NULL ) {
 
-        BitBlt( hDc, 0, 0, width, height, 
-            nextUndo->hDc, 0, 0, SRCCOPY|CAPTUREBLT );
-        *DrawUndoList = nextUndo->Next;
-        DeleteObject( nextUndo->hBitmap );
-        DeleteDC( nextUndo->hDc );
-        free( nextUndo );
-        return TRUE;
+            g_UndoScreenBitmap = {};
+            return NULL;
+        }
+        g_UndoScreenBitmap.width = width;
+        g_UndoScreenBitmap.height = height;
 
-    } else {
+    } else if( region.right > region.left && region.bottom > region.top ) {
 
-        Beep( 700, 200 );
-        return FALSE;
+        BitBlt( g_UndoScreenBitmap.hDc, region.left, region.top, region.right - region.left,
+                region.bottom - region.top, hDc, region.left, region.top, SRCCOPY );
     }
+    GdiFlush();
+    return g_UndoScreenBitmap.pPixels;
 }
 
-
 //----------------------------------------------------------------------------
 //
-// DeleteOldestUndo
+// DeleteDrawUndoList
 //
 //----------------------------------------------------------------------------
-void DeleteOldestUndo( P_DRAW_UNDO *DrawUndoList )
+void DeleteDrawUndoList( DrawUndoHistory *DrawUndoList )
 {
-    P_DRAW_UNDO	nextUndo, freeUndo = NULL, prevUndo = NULL;
-
-    nextUndo = *DrawUndoList;
-    freeUndo = nextUndo;
-    do {
-
-        prevUndo = freeUndo;
-        freeUndo = nextUndo;
-        nextUndo = nextUndo->Next;
+    DrawUndoList->Clear();
+    DeleteUndoScreenBitmap();
+}
 
-    } while( nextUndo );
+//----------------------------------------------------------------------------
+//
+// PopDrawUndo
+//
+//----------------------------------------------------------------------------
+BOOLEAN PopDrawUndo( HDC hDc, DrawUndoHistory *DrawUndoList, 
+                  int width, int height )
+{
+    if( !DrawUndoList->IsEmpty() ) {
+
+        BITMAPINFO bmi = { 0 };
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = DrawUndoList->Width();
+        bmi.bmiHeader.biHeight = -DrawUndoList->Height();  // Top-down DIB
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        SetDIBitsToDevice( hDc, 0, 0, min( width, DrawUndoList->Width() ), min( height, DrawUndoList->Height() ),
+            0, 0, 0, DrawUndoList->Height(), DrawUndoList->Newest(), &bmi, DIB_RGB_COLORS );
+        DrawUndoList->Pop();
+        return TRUE;
 
-    if( freeUndo ) {
+    } else {
 
-        DeleteObject( freeUndo->hBitmap );
-        DeleteDC( freeUndo->hDc );
-        free( freeUndo );
-        if( prevUndo != *DrawUndoList ) prevUndo->Next = NULL;
-        else *DrawUndoList = NULL;
+        Beep( 700, 200 );
+        return FALSE;
     }
 }
 
 //----------------------------------------------------------------------------
 //
-// GetOldestUndo
+// CopyOldestUndoPixels
+//
+// Copies the region of the oldest undo state, the screen before the
+// earliest stroke still in the history. Pixels outside of the screen are
+// left black.
 // 
 //----------------------------------------------------------------------------
-P_DRAW_UNDO GetOldestUndo(P_DRAW_UNDO DrawUndoList)
+std::vector<BYTE> CopyOldestUndoPixels( const DrawUndoHistory& DrawUndoList, Gdiplus::Rect* lineBounds )
 {
-    P_DRAW_UNDO	nextUndo, oldestUndo = NULL;
-
-    nextUndo = DrawUndoList;
-    oldestUndo = nextUndo;
-    do {
-
-        oldestUndo = nextUndo;
-        nextUndo = nextUndo->Next;
-
-    } while( nextUndo );
-    return oldestUndo;
+    std::vector<BYTE> pixels( static_cast<size_t>(lineBounds->Width) * lineBounds->Height * 4 );
+    const RECT region = { lineBounds->X, lineBounds->Y,
+                          lineBounds->X + lineBounds->Width, lineBounds->Y + lineBounds->Height };
+    DrawUndoList.CopyOldest( region, pixels.data(), static_cast<size_t>(lineBounds->Width) * 4 );
+    return pixels;
 }
 
-
 //----------------------------------------------------------------------------
 //
 // PushDrawUndo
 //
 //----------------------------------------------------------------------------
-void PushDrawUndo( HDC hDc, P_DRAW_UNDO *DrawUndoList, int width, int height )
+void PushDrawUndo( HDC hDc, DrawUndoHistory *DrawUndoList, int width, int height )
 {
-    P_DRAW_UNDO	nextUndo, newUndo;
-    int			i = 0;
-    HBITMAP		hUndoBitmap;
-
     OutputDebug(L"PushDrawUndo\n");
 
-    // Don't store more than 8 undo's (XP gets really upset when we
-    // exhaust heap with them)
-    nextUndo = *DrawUndoList;
-    do {
-
-        i++;
-        if( i == MAX_UNDO_HISTORY ) {
-
-            DeleteOldestUndo( DrawUndoList );
-            break;
-        }
-        if( nextUndo ) nextUndo = nextUndo->Next;
-
-    } while( nextUndo );
+    // Only the tiles that changed since the previous push are stored, and
+    // the oldest ones are dropped once the history exceeds MAX_UNDO_MEMORY.
+    // GDI accumulates the bounds of the drawing since the previous push, the
+    // tiles outside of them are neither captured nor compared.
+    RECT dirty;
+    const UINT bounds = GetBoundsRect( hDc, &dirty, DCB_RESET );
+    const bool wholeScreen = DrawUndoList->IsEmpty() || DrawUndoList->Width() != width ||
+                             DrawUndoList->Height() != height || ( bounds & DCB_ENABLE ) == 0;
+    if( ( bounds & DCB_SET ) != DCB_SET ) {
+
+        SetRectEmpty( &dirty );
+    }
+    const RECT region = wholeScreen ? RECT{ 0, 0, width, height } : DrawUndoList->TileBounds( dirty );
 
-    hUndoBitmap = CreateCompatibleBitmap( hDc, width, height );
-    if( !hUndoBitmap && *DrawUndoList ) {
+    BYTE* pPixels = CaptureUndoScreenBitmap( hDc, width, height, region );
+    if( pPixels ) {
 
-        // delete the oldest and try again
-        DeleteOldestUndo( DrawUndoList );
-        hUndoBitmap = CreateCompatibleBitmap( hDc, width, height );
+        DrawUndoList->Push( pPixels, width, height, static_cast<size_t>(width) * 4, wholeScreen ? NULL : &region );
     }
-    if( hUndoBitmap ) {
-
-        newUndo = static_cast<P_DRAW_UNDO>(malloc( sizeof( DRAW_UNDO )));
-        if (newUndo != NULL)
-        {
-            newUndo->hDc = CreateCompatibleDC(hDc);
-            newUndo->hBitmap = hUndoBitmap;
-            SelectObject(newUndo->hDc, newUndo->hBitmap);
-            BitBlt(newUndo->hDc, 0, 0, width, height, hDc, 0, 0, SRCCOPY | CAPTUREBLT);
-            newUndo->Next = *DrawUndoList;
-            *DrawUndoList = newUndo;
-        }
-    } 
 }
 
 //----------------------------------------------------------------------------
@@ -3688,7 +3523,7 @@ LRESULT APIENTRY MainWndProc(
     static POINT	prevPt;
     static POINT	textStartPt;
     static POINT	textPt;
-    static P_DRAW_UNDO drawUndoList = NULL;
+    static DrawUndoHistory drawUndoList( MAX_UNDO_MEMORY );
     static P_TYPED_KEY	typedKeyList = NULL;
     static BOOLEAN	g_HaveDrawn = FALSE;
     static DWORD	g_DrawingShape = 0;
@@ -4424,6 +4259,9 @@ LRESULT APIENTRY MainWndProc(
                             static_cast<PTCHAR>(NULL), static_cast<CONST DEVMODE *>(NULL));
                     hdcScreenCompat = CreateCompatibleDC(hdcScreen); 
                     hdcScreenSaveCompat = CreateCompatibleDC(hdcScreen); 
+
+                    // Lets PushDrawUndo capture only what was drawn since the previous push
+                    SetBoundsRect( hdcScreenCompat, NULL, DCB_ENABLE | DCB_RESET );
                     hdcScreenCursorCompat = CreateCompatibleDC(hdcScreen); 
 
                     // Determine what monitor we're on
@@ -5413,21 +5251,12 @@ LRESULT APIENTRY MainWndProc(
                         Gdiplus::BitmapData* lineData = LockGdiPlusBitmap(lineBitmap);
                         BYTE* pPixels = static_cast<BYTE*>(lineData->Scan0);
 
-                        // Copy the contents of the screen bitmap to the temporary bitmap
-                        GetOldestUndo(drawUndoList);
-
-                        // Create a GDI bitmap that's the size of the lineBounds rectangle
-                        Gdiplus::Bitmap *blurBitmap = CreateGdiplusBitmap( hdcScreenCompat, // oldestUndo->hDc, 
-                                            lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height);
-
                         // Blur it
-                        BitmapBlur(blurBitmap);
-                        BlurScreen(hdcScreenCompat, &lineBounds, blurBitmap, pPixels);
+                        BlurScreen(hdcScreenCompat, &lineBounds, pPixels, lineData->Stride);
 
                         // Unlock the bits
                         lineBitmap->UnlockBits(lineData);
                         delete lineBitmap;
-                        delete blurBitmap;
 
                         // Invalidate the updated rectangle
                         InvalidateGdiplusRect( hWnd, lineBounds );
@@ -5467,39 +5296,13 @@ LRESULT APIENTRY MainWndProc(
                         // Pointer to the DIB bits
                         BYTE* pDestPixels = static_cast<BYTE*>(pDIBBits);
 
-                        // Pointer to screen bits
-                        HDC hdcDIBOrig;
-                        HBITMAP hDibOrigBitmap, hDibBitmap;
-                        P_DRAW_UNDO oldestUndo = GetOldestUndo(drawUndoList);
-                        BYTE* pDestPixels2 = CreateBitmapMemoryDIB(hdcScreenCompat, oldestUndo->hDc, &lineBounds, 
-                                                &hdcDIBOrig, &hDibBitmap, &hDibOrigBitmap);
-
-                        for (int local_y = 0; local_y < lineBounds.Height; ++local_y) {
-                            for (int local_x = 0; local_x < lineBounds.Width; ++local_x) {
-                                int index = (local_y * lineBounds.Width * 4) + (local_x * 4); // Assuming 4 bytes per pixel
-                                // BYTE b = pPixels[index + 0];  // Blue channel
-                                // BYTE g = pPixels[index + 1];  // Green channel
-                                // BYTE r = pPixels[index + 2];  // Red channel
-                                BYTE a = pPixels[index + 3];  // Alpha channel
-
-                                // Check if this is a drawn pixel
-                                if (a != 0) {
-                                    // Assuming pDestPixels is a valid pointer to the destination bitmap's pixel data
-                                    BYTE destB = pDestPixels2[index + 0];  // Blue channel
-                                    BYTE destG = pDestPixels2[index + 1];  // Green channel
-                                    BYTE destR = pDestPixels2[index + 2];  // Red channel
-
-                                    // Create a COLORREF value from the destination pixel data
-                                    COLORREF currentPixel = RGB(destR, destG, destB);
-                                    // Blend the colors
-                                    COLORREF newPixel = BlendColors(currentPixel, g_PenColor);
-                                    // Update the destination pixel data with the new color
-                                    pDestPixels[index + 0] = GetBValue(newPixel);
-                                    pDestPixels[index + 1] = GetGValue(newPixel);
-                                    pDestPixels[index + 2] = GetRValue(newPixel);
-                                }
-                            }
-                        }
+                        // Pointer to the oldest undo screen bits
+                        std::vector<BYTE> undoPixels = CopyOldestUndoPixels(drawUndoList, &lineBounds);
+                        BYTE* pDestPixels2 = undoPixels.data();
+
+                        // Highlight the drawn pixels
+                        HighlightPixels(pDestPixels, static_cast<size_t>(lineBounds.Width) * 4, pDestPixels2, static_cast<size_t>(lineBounds.Width) * 4,
+                                        pPixels, lineData->Stride, lineBounds.Width, lineBounds.Height, GetHighlighterColor(g_PenColor));
 
                         // Copy the updated DIB back to hdcScreenCompat
                         BitBlt(hdcScreenCompat, lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height, hdcDIB, 0, 0, SRCCOPY);
@@ -5508,10 +5311,6 @@ LRESULT APIENTRY MainWndProc(
                         DeleteObject(hDIB);
                         DeleteDC(hdcDIB);
 
-                        SelectObject(hdcDIBOrig, hDibOrigBitmap);
-                        DeleteObject(hDibBitmap);
-                        DeleteDC(hdcDIBOrig);
-
                         // Invalidate the updated rectangle
                         InvalidateGdiplusRect(hWnd, lineBounds);
                     }
@@ -6004,6 +5803,9 @@ LRESULT APIENTRY MainWndProc(
                 EnableDisableStickyKeys( TRUE );
                 SendMessage( hWnd, WM_USER_TYPING_OFF, 0, 0 );
 
+                // The screen copy is only needed to push undo states while drawing
+                DeleteUndoScreenBitmap();
+
                 // Unclip cursor
                 ClipCursor( NULL );
             }
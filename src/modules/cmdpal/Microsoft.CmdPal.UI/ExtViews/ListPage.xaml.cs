@@ -5,6 +5,7 @@
 using System.Diagnostics;
 using CommunityToolkit.Mvvm.Messaging;
 using ManagedCommon;
+using Microsoft.CmdPal.UI.Helpers;
 using Microsoft.CmdPal.UI.ViewModels;
 using Microsoft.CmdPal.UI.ViewModels.Messages;
 using Microsoft.Extensions.DependencyInjection;
@@ -22,6 +23,9 @@ public sealed partial class ListPage : Page,
     IRecipient<ActivateSelectedListItemMessage>,
     IRecipient<ActivateSecondaryCommandMessage>
 {
+    // The list view model initializes this many items as soon as the results arrive
+    private const int WarmedIconCount = 20;
+
     private ListViewModel? ViewModel
     {
         get => (ListViewModel?)GetValue(ViewModelProperty);
@@ -78,6 +82,8 @@ public sealed partial class ListPage : Page,
             ViewModel.ItemsUpdated -= Page_ItemsUpdated;
         }
 
+        IconCacheProvider.LogStatistics();
+
         if (e.NavigationMode != NavigationMode.New)
         {
             ViewModel?.SafeCleanup();
@@ -253,6 +259,9 @@ public sealed partial class ListPage : Page,
     // GetItems or a change in the filter.
     private void Page_ItemsUpdated(ListViewModel sender, object args)
     {
+        // The first items are the visible ones, get their icons extracted before the list binds them
+        IconCacheProvider.WarmIcons(sender.FilteredItems.Take(WarmedIconCount).Select(item => item.Icon), ActualTheme);
+
         // If for some reason, we don't have a selected item, fix that.
         //
         // It's important to do this here, because once there's no selection
@@ -4,6 +4,7 @@
 
 using Microsoft.CmdPal.UI.Controls;
 using Microsoft.CmdPal.UI.ViewModels;
+using Microsoft.UI.Xaml;
 
 namespace Microsoft.CmdPal.UI.Helpers;
 
@@ -41,4 +42,17 @@ public static partial class IconCacheProvider
             deferral.Complete();
         }
     }
+
+    /// <summary>
+    /// Starts loading the icons in the background, before a list binds them.
+    /// </summary>
+    public static void WarmIcons(IEnumerable<IconInfoViewModel> icons, ElementTheme theme)
+    {
+        foreach (var icon in icons)
+        {
+            IconService.WarmIcon(theme == ElementTheme.Dark ? icon.Dark : icon.Light);
+        }
+    }
+
+    public static void LogStatistics() => IconService.LogStatistics();
 }
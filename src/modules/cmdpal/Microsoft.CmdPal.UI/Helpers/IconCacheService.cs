@@ -3,6 +3,7 @@
 // See the LICENSE file in the project root for more information.
 
 using System.Diagnostics;
+using ManagedCommon;
 using Microsoft.CmdPal.UI.ViewModels;
 using Microsoft.Terminal.UI;
 using Microsoft.UI.Dispatching;
@@ -14,11 +15,30 @@ namespace Microsoft.CmdPal.UI.Helpers;
 
 public sealed class IconCacheService(DispatcherQueue dispatcherQueue)
 {
+    // IconSourceMUX extracts the icons of binaries at this size
+    private const int BinaryIconSize = 24;
+
     public Task<IconSource?> GetIconSource(IconDataViewModel icon) =>
 
         // todo: actually implement a cache of some sort
         IconToSource(icon);
 
+    // Icons of binaries are extracted in the background and cached, so binding them later is
+    // a cache hit. Other icons are left to XAML.
+    public void WarmIcon(IconDataViewModel icon)
+    {
+        if (!string.IsNullOrEmpty(icon.Icon))
+        {
+            IconPathConverter.WarmIcon(icon.Icon, BinaryIconSize);
+        }
+    }
+
+    public void LogStatistics()
+    {
+        var statistics = IconPathConverter.GetIconCacheStatistics();
+        Logger.LogDebug($"Icon cache: {statistics.Hits} hits, {statistics.Misses} misses, {statistics.Evictions} evictions, {statistics.Count} icons");
+    }
+
     private async Task<IconSource?> IconToSource(IconDataViewModel icon)
     {
         try
@@ -8,6 +8,8 @@
 #include <Shlobj_core.h>
 #include <wincodec.h>
 
+#include <future>
+
 namespace winrt
 {
     namespace MUX = Microsoft::UI::Xaml;
@@ -256,9 +258,9 @@ namespace winrt::Microsoft::Terminal::UI::implementation
         return softwareBitmap;
     }
 
-    static SoftwareBitmap _getBitmapFromIconFileAsync(const winrt::hstring& iconPath,
-                                                      int32_t iconIndex,
-                                                      uint32_t iconSize)
+    static SoftwareBitmap _extractBitmapFromIconFile(const winrt::hstring& iconPath,
+                                                     int32_t iconIndex,
+                                                     uint32_t iconSize)
     {
         wil::unique_hicon hicon;
         LOG_IF_FAILED(SHDefExtractIcon(iconPath.c_str(), iconIndex, 0, &hicon, nullptr, iconSize));
@@ -277,6 +279,130 @@ namespace winrt::Microsoft::Terminal::UI::implementation
                                         wicImagingFactory.get());
     }
 
+    namespace
+    {
+        // Enough for the icons of a few pages of results
+        constexpr size_t iconCacheCapacity = 512;
+
+        // There's no monochrome flag: icons of binaries are always shown in color, as ImageIcons,
+        // and the flag only applies to BitmapIconSource.
+        struct IconCacheKey
+        {
+            std::wstring path;
+            int32_t index;
+            uint32_t size;
+
+            bool operator==(const IconCacheKey&) const = default;
+        };
+
+        struct IconCacheKeyHash
+        {
+            size_t operator()(const IconCacheKey& key) const noexcept
+            {
+                const auto hash = std::hash<std::wstring>{}(key.path);
+                const auto indexAndSize = (static_cast<uint64_t>(static_cast<uint32_t>(key.index)) << 32) | key.size;
+                return hash ^ (std::hash<uint64_t>{}(indexAndSize) + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+            }
+        };
+
+        // Bitmaps of the icons extracted from binaries, least recently used ones are evicted first.
+        // Only the first request of an icon extracts it, concurrent requests for the same icon wait
+        // for that extraction. An icon that couldn't be extracted is cached as a null bitmap.
+        class DecodedIconCache
+        {
+            struct Entry
+            {
+                IconCacheKey key;
+                std::shared_future<SoftwareBitmap> bitmap;
+                uint64_t id;
+            };
+
+            std::mutex mutex;
+
+            // Most recently used first
+            std::list<Entry> entries;
+            std::unordered_map<IconCacheKey, std::list<Entry>::iterator, IconCacheKeyHash> entriesByKey;
+            uint64_t nextId = 0;
+
+            std::atomic<uint64_t> hits = 0;
+            std::atomic<uint64_t> misses = 0;
+            std::atomic<uint64_t> evictions = 0;
+
+        public:
+            template<typename TExtract>
+            SoftwareBitmap Get(const IconCacheKey& key, TExtract&& extract)
+            {
+                std::promise<SoftwareBitmap> extraction;
+                uint64_t id;
+                {
+                    std::unique_lock lock(mutex);
+                    if (const auto found = entriesByKey.find(key); found != entriesByKey.end())
+                    {
+                        entries.splice(entries.begin(), entries, found->second);
+                        const auto bitmap = found->second->bitmap;
+                        lock.unlock();
+
+                        hits.fetch_add(1, std::memory_order_relaxed);
+                        return bitmap.get();
+                    }
+
+                    id = nextId++;
+                    entries.push_front(Entry{ .key = key, .bitmap = extraction.get_future().share(), .id = id });
+                    entriesByKey.emplace(key, entries.begin());
+
+                    // Requests waiting on an evicted extraction still get its result
+                    while (entries.size() > iconCacheCapacity)
+                    {
+                        entriesByKey.erase(entries.back().key);
+                        entries.pop_back();
+                        evictions.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                misses.fetch_add(1, std::memory_order_relaxed);
+
+                try
+                {
+                    auto bitmap = extract();
+                    extraction.set_value(bitmap);
+                    return bitmap;
+                }
+                catch (...)
+                {
+                    // Failures like COM not being initialized on this thread aren't about the icon,
+                    // so let the next request try again
+                    extraction.set_exception(std::current_exception());
+
+                    std::unique_lock lock(mutex);
+                    if (const auto found = entriesByKey.find(key); found != entriesByKey.end() && found->second->id == id)
+                    {
+                        entries.erase(found->second);
+                        entriesByKey.erase(found);
+                    }
+                    throw;
+                }
+            }
+
+            winrt::Microsoft::Terminal::UI::IconCacheStatistics Statistics()
+            {
+                std::unique_lock lock(mutex);
+                return { .Hits = hits.load(std::memory_order_relaxed),
+                         .Misses = misses.load(std::memory_order_relaxed),
+                         .Evictions = evictions.load(std::memory_order_relaxed),
+                         .Count = static_cast<uint32_t>(entries.size()) };
+            }
+        };
+
+        DecodedIconCache decodedIconCache;
+    }
+
+    static SoftwareBitmap _getBitmapFromIconFileAsync(const winrt::hstring& iconPath,
+                                                      int32_t iconIndex,
+                                                      uint32_t iconSize)
+    {
+        return decodedIconCache.Get(IconCacheKey{ .path = std::wstring{ iconPath }, .index = iconIndex, .size = iconSize },
+                                    [&] { return _extractBitmapFromIconFile(iconPath, iconIndex, iconSize); });
+    }
+
     // Method Description:
     // - Attempt to get the icon index from the icon path provided
     // Arguments:
@@ -383,4 +509,34 @@ namespace winrt::Microsoft::Terminal::UI::implementation
         icon.Height(targetSize);
         return icon;
     }
+
+    static winrt::fire_and_forget _warmIconAsync(const winrt::hstring iconPath, const int targetSize)
+    {
+        co_await winrt::resume_background();
+
+        try
+        {
+            std::wstring_view iconPathWithoutIndex;
+            const auto indexOpt = _getIconIndex(iconPath, iconPathWithoutIndex);
+            if (!indexOpt.has_value())
+            {
+                // Images and glyphs are loaded by XAML itself, which caches decoded images by URI
+                co_return;
+            }
+
+            const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+            _getBitmapFromIconFileAsync(winrt::hstring{ iconPathWithoutIndex }, indexOpt.value(), targetSize);
+        }
+        CATCH_LOG();
+    }
+
+    void IconPathConverter::WarmIcon(const winrt::hstring& iconPath, const int targetSize)
+    {
+        _warmIconAsync(iconPath, targetSize);
+    }
+
+    winrt::Microsoft::Terminal::UI::IconCacheStatistics IconPathConverter::GetIconCacheStatistics()
+    {
+        return decodedIconCache.Statistics();
+    }
 }
@@ -13,6 +13,9 @@ namespace winrt::Microsoft::Terminal::UI::implementation
         static Microsoft::UI::Xaml::Controls::IconSource IconSourceMUX(const winrt::hstring& iconPath, bool convertToGrayscale, const int targetSize=24);
         static Microsoft::UI::Xaml::Controls::IconElement IconMUX(const winrt::hstring& iconPath);
         static Microsoft::UI::Xaml::Controls::IconElement IconMUX(const winrt::hstring& iconPath, const int targetSize);
+
+        static void WarmIcon(const winrt::hstring& iconPath, const int targetSize);
+        static winrt::Microsoft::Terminal::UI::IconCacheStatistics GetIconCacheStatistics();
     };
 }
 
@@ -41,12 +41,10 @@ FancyZonesApp::~FancyZonesApp()
         m_app->Destroy();
         m_app = nullptr;
 
-        if (s_llKeyboardHook)
+        if (s_keyboardSubscription)
         {
-            if (UnhookWindowsHookEx(s_llKeyboardHook))
-            {
-                s_llKeyboardHook = nullptr;
-            }
+            LowlevelHookBroker::Unsubscribe(*s_keyboardSubscription);
+            s_keyboardSubscription.reset();
         }
 
         m_staticWinEventHooks.erase(std::remove_if(begin(m_staticWinEventHooks),
@@ -83,8 +81,8 @@ void FancyZonesApp::InitHooks()
 
     if (!hook_disabled)
     {
-        s_llKeyboardHook = SetWindowsHookEx(WH_KEYBOARD_LL, LowLevelKeyboardProc, GetModuleHandle(NULL), NULL);
-        if (!s_llKeyboardHook)
+        s_keyboardSubscription = LowlevelHookBroker::SubscribeKeyboard(L"FancyZones", LowlevelHookBroker::Priority::Normal, LowLevelKeyboardProc);
+        if (!s_keyboardSubscription)
         {
             DWORD errorCode = GetLastError();
             show_last_error_message(L"SetWindowsHookEx", errorCode, GET_RESOURCE_STRING(IDS_POWERTOYS_FANCYZONES).c_str());
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <common/hooks/LowlevelKeyboardEvent.h>
+#include <common/hooks/LowlevelHookBroker.h>
 #include <common/utils/EventWaiter.h>
 
 #include <FancyZonesLib/FancyZones.h>
@@ -15,7 +15,7 @@ public:
 
 private:
     static inline FancyZonesApp* s_instance = nullptr;
-    static inline HHOOK s_llKeyboardHook = nullptr;
+    static inline std::optional<LowlevelHookBroker::SubscriptionId> s_keyboardSubscription;
 
     winrt::com_ptr<IFancyZones> m_app;
     HWINEVENTHOOK m_objectLocationWinEventHook = nullptr;
@@ -31,22 +31,13 @@ private:
     void HandleWinHookEvent(WinHookEvent* data) noexcept;
     intptr_t HandleKeyboardHookEvent(LowlevelKeyboardEvent* data) noexcept;
 
-    static LRESULT CALLBACK LowLevelKeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
+    static bool LowLevelKeyboardProc(LowlevelKeyboardEvent& event)
     {
-        LowlevelKeyboardEvent event;
-        if (nCode == HC_ACTION && wParam == WM_KEYDOWN)
+        if (event.wParam == WM_KEYDOWN && s_instance)
         {
-            event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-            event.wParam = wParam;
-            if (s_instance)
-            {
-                if (s_instance->HandleKeyboardHookEvent(&event) == 1)
-                {
-                    return 1;
-                }
-            }
+            return s_instance->HandleKeyboardHookEvent(&event) == 1;
         }
-        return CallNextHookEx(NULL, nCode, wParam, lParam);
+        return false;
     }
 
     static void CALLBACK WinHookProc(HWINEVENTHOOK winEventHook,
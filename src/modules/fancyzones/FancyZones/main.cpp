@@ -31,11 +31,12 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     trace.UpdateState(true);
 
     winrt::init_apartment();
-    LoggerHelpers::init_logger(moduleName, internalPath, LogSettings::fancyZonesLoggerName);
+    LoggerHelpers::init_logger(moduleName, internalPath, LogSettings::fancyZonesLoggerName, Logger::AsyncOptions{});
 
     if (powertoys_gpo::getConfiguredFancyZonesEnabledValue() == powertoys_gpo::gpo_rule_configured_disabled)
     {
         Logger::warn(L"Tried to start with a GPO policy setting the utility to always be disabled. Please contact your systems administrator.");
+        Logger::shutdown();
         return 0;
     }
 
@@ -50,6 +51,7 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     if (GetLastError() == ERROR_ALREADY_EXISTS)
     {
         Logger::warn(L"FancyZones instance is already running");
+        Logger::shutdown();
         return 0;
     }
 
@@ -89,6 +91,7 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     Trace::UnregisterProvider();
 
     trace.Flush();
+    Logger::shutdown();
 
     return 0;
 }
@@ -2,7 +2,7 @@
 
 #include "pch.h"
 #include <functional>
-#include <common/debug_control.h>
+#include <common/hooks/LowlevelHookBroker.h>
 
 template<int... keys>
 class GenericKeyHook
@@ -16,45 +16,35 @@ public:
 
     void enable()
     {
-#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
-        if (IsDebuggerPresent())
+        if (!subscription)
         {
-            return;
-        }
-#endif
-        if (!hHook)
-        {
-            hHook = SetWindowsHookEx(WH_KEYBOARD_LL, GenericKeyHookProc, GetModuleHandle(NULL), 0);
+            subscription = LowlevelHookBroker::SubscribeKeyboard(L"FancyZones key state", LowlevelHookBroker::Priority::Observer, GenericKeyHookProc);
         }
     }
 
     void disable()
     {
-        if (hHook)
+        if (subscription)
         {
-            UnhookWindowsHookEx(hHook);
-            hHook = NULL;
+            LowlevelHookBroker::Unsubscribe(*subscription);
+            subscription.reset();
             callback(false);
         }
     }
 
 private:
-    inline static HHOOK hHook = nullptr;
+    inline static std::optional<LowlevelHookBroker::SubscriptionId> subscription;
     inline static std::function<void(bool)> callback;
 
-    static LRESULT CALLBACK GenericKeyHookProc(int nCode, WPARAM wParam, LPARAM lParam)
+    static bool GenericKeyHookProc(LowlevelKeyboardEvent& event)
     {
-        if (nCode == HC_ACTION)
+        if (event.wParam == WM_KEYDOWN || event.wParam == WM_KEYUP)
         {
-            if (wParam == WM_KEYDOWN || wParam == WM_KEYUP)
+            if (((event.lParam->vkCode == keys) || ...))
             {
-                PKBDLLHOOKSTRUCT kbdHookStruct = reinterpret_cast<PKBDLLHOOKSTRUCT>(lParam);
-                if (((kbdHookStruct->vkCode == keys) || ...))
-                {
-                    callback(wParam == WM_KEYDOWN);
-                }
+                callback(event.wParam == WM_KEYDOWN);
             }
         }
-        return CallNextHookEx(hHook, nCode, wParam, lParam);
+        return false;
     }
 };
@@ -1,10 +1,9 @@
 #include "pch.h"
 #include "MouseButtonsHook.h"
-#include <common/debug_control.h>
 
 #pragma region public
 
-HHOOK MouseButtonsHook::hHook = {};
+std::optional<LowlevelHookBroker::SubscriptionId> MouseButtonsHook::subscription = {};
 std::function<void()> MouseButtonsHook::secondaryClickCallback = {};
 std::function<void()> MouseButtonsHook::middleClickCallback = {};
 
@@ -16,24 +15,18 @@ MouseButtonsHook::MouseButtonsHook(std::function<void()> extRightClickCallback,
 
 void MouseButtonsHook::enable()
 {
-#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
-    if (IsDebuggerPresent())
+    if (!subscription)
     {
-        return;
-    }
-#endif
-    if (!hHook)
-    {
-        hHook = SetWindowsHookEx(WH_MOUSE_LL, MouseButtonsProc, GetModuleHandle(NULL), 0);
+        subscription = LowlevelHookBroker::SubscribeMouse(L"FancyZones mouse buttons", LowlevelHookBroker::Priority::Observer, MouseButtonsProc);
     }
 }
 
 void MouseButtonsHook::disable()
 {
-    if (hHook)
+    if (subscription)
     {
-        UnhookWindowsHookEx(hHook);
-        hHook = NULL;
+        LowlevelHookBroker::Unsubscribe(*subscription);
+        subscription.reset();
     }
 }
 
@@ -41,20 +34,17 @@ void MouseButtonsHook::disable()
 
 #pragma region private
 
-LRESULT CALLBACK MouseButtonsHook::MouseButtonsProc(int nCode, WPARAM wParam, LPARAM lParam)
+bool MouseButtonsHook::MouseButtonsProc(WPARAM wParam, const MSLLHOOKSTRUCT& /*info*/)
 {
-    if (nCode == HC_ACTION)
+    if (wParam == WM_RBUTTONDOWN || wParam == WM_XBUTTONDOWN)
+    {
+        secondaryClickCallback();
+    }
+    else if (wParam == WM_MBUTTONDOWN)
     {
-        if (wParam == WM_RBUTTONDOWN || wParam == WM_XBUTTONDOWN)
-        {
-            secondaryClickCallback();
-        }
-        else if (wParam == WM_MBUTTONDOWN)
-        {
-            middleClickCallback();
-        }
+        middleClickCallback();
     }
-    return CallNextHookEx(hHook, nCode, wParam, lParam);
+    return false;
 }
 
 #pragma endregion
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <common/hooks/LowlevelHookBroker.h>
 
 class MouseButtonsHook
 {
@@ -10,8 +11,8 @@ public:
     void disable();
 
 private:
-    static HHOOK hHook;
+    static std::optional<LowlevelHookBroker::SubscriptionId> subscription;
     static std::function<void()> middleClickCallback;
     static std::function<void()> secondaryClickCallback;
-    static LRESULT CALLBACK MouseButtonsProc(int, WPARAM, LPARAM);
+    static bool MouseButtonsProc(WPARAM, const MSLLHOOKSTRUCT&);
 };
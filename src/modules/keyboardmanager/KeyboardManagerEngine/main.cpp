@@ -20,7 +20,7 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
                     _In_ int /*nCmdShow*/)
 {
     winrt::init_apartment();
-    LoggerHelpers::init_logger(KeyboardManagerConstants::ModuleName, L"Engine", LogSettings::keyboardManagerLoggerName);
+    LoggerHelpers::init_logger(KeyboardManagerConstants::ModuleName, L"Engine", LogSettings::keyboardManagerLoggerName, Logger::AsyncOptions{});
 
     Shared::Trace::ETWTrace trace;
     trace.UpdateState(true);
@@ -28,6 +28,7 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
     if (powertoys_gpo::getConfiguredKeyboardManagerEnabledValue() == powertoys_gpo::gpo_rule_configured_disabled)
     {
         Logger::warn(L"Tried to start with a GPO policy setting the utility to always be disabled. Please contact your systems administrator.");
+        Logger::shutdown();
         return 0;
     }
 
@@ -42,6 +43,7 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
     if (GetLastError() == ERROR_ALREADY_EXISTS)
     {
         Logger::warn(L"KBM engine instance is already running");
+        Logger::shutdown();
         return 0;
     }
 
@@ -86,6 +88,7 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
     Trace::UnregisterProvider();
 
     trace.Flush();
+    Logger::shutdown();
 
     return 0;
 }
@@ -15,8 +15,7 @@
 #include "KeyboardEventHandlers.h"
 #include "trace.h"
 
-HHOOK KeyboardManager::hookHandleCopy;
-HHOOK KeyboardManager::hookHandle;
+std::optional<LowlevelHookBroker::SubscriptionId> KeyboardManager::hookSubscription;
 KeyboardManager* KeyboardManager::keyboardManagerObjectPtr;
 
 namespace
@@ -61,11 +60,11 @@ KeyboardManager::KeyboardManager()
 
         const bool newHasRemappings = HasRegisteredRemappingsUnchecked();
         // We didn't have any bindings before and we have now
-        if (newHasRemappings && !hookHandle)
+        if (newHasRemappings && !hookSubscription)
             PostThreadMessageW(mainThreadId, StartHookMessageID, 0, 0);
 
         // All bindings were removed
-        if (!newHasRemappings && hookHandle)
+        if (!newHasRemappings && hookSubscription)
             StopLowlevelKeyboardHook();
     };
 
@@ -103,27 +102,21 @@ void KeyboardManager::LoadSettings()
     }
 }
 
-LRESULT CALLBACK KeyboardManager::HookProc(int nCode, const WPARAM wParam, const LPARAM lParam)
+bool KeyboardManager::HookProc(LowlevelKeyboardEvent& event)
 {
-    LowlevelKeyboardEvent event{};
-    if (nCode == HC_ACTION)
-    {
-        event.lParam = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
-        event.wParam = wParam;
-        event.lParam->vkCode = Helpers::EncodeKeyNumpadOrigin(event.lParam->vkCode, event.lParam->flags & LLKHF_EXTENDED);
+    event.lParam->vkCode = Helpers::EncodeKeyNumpadOrigin(event.lParam->vkCode, event.lParam->flags & LLKHF_EXTENDED);
 
-        if (keyboardManagerObjectPtr->HandleKeyboardHookEvent(&event) == 1)
+    if (keyboardManagerObjectPtr->HandleKeyboardHookEvent(&event) == 1)
+    {
+        // Reset Num Lock whenever a NumLock key down event is suppressed since Num Lock key state change occurs before it is intercepted by low level hooks
+        if (event.lParam->vkCode == VK_NUMLOCK && (event.wParam == WM_KEYDOWN || event.wParam == WM_SYSKEYDOWN) && event.lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
         {
-            // Reset Num Lock whenever a NumLock key down event is suppressed since Num Lock key state change occurs before it is intercepted by low level hooks
-            if (event.lParam->vkCode == VK_NUMLOCK && (event.wParam == WM_KEYDOWN || event.wParam == WM_SYSKEYDOWN) && event.lParam->dwExtraInfo != KeyboardManagerConstants::KEYBOARDMANAGER_SUPPRESS_FLAG)
-            {
-                KeyboardEventHandlers::SetNumLockToPreviousState(keyboardManagerObjectPtr->inputHandler);
-            }
-            return 1;
+            KeyboardEventHandlers::SetNumLockToPreviousState(keyboardManagerObjectPtr->inputHandler);
         }
+        return true;
     }
 
-    return CallNextHookEx(hookHandleCopy, nCode, wParam, lParam);
+    return false;
 }
 
 void KeyboardManager::StartLowlevelKeyboardHook()
@@ -135,11 +128,10 @@ void KeyboardManager::StartLowlevelKeyboardHook()
     }
 #endif
 
-    if (!hookHandle)
+    if (!hookSubscription)
     {
-        hookHandle = SetWindowsHookEx(WH_KEYBOARD_LL, HookProc, GetModuleHandle(NULL), NULL);
-        hookHandleCopy = hookHandle;
-        if (!hookHandle)
+        hookSubscription = LowlevelHookBroker::SubscribeKeyboard(L"Keyboard Manager", LowlevelHookBroker::Priority::Normal, HookProc);
+        if (!hookSubscription)
         {
             DWORD errorCode = GetLastError();
             show_last_error_message(L"SetWindowsHookEx", errorCode, L"PowerToys - Keyboard Manager");
@@ -151,10 +143,10 @@ void KeyboardManager::StartLowlevelKeyboardHook()
 
 void KeyboardManager::StopLowlevelKeyboardHook()
 {
-    if (hookHandle)
+    if (hookSubscription)
     {
-        UnhookWindowsHookEx(hookHandle);
-        hookHandle = nullptr;
+        LowlevelHookBroker::Unsubscribe(*hookSubscription);
+        hookSubscription.reset();
     }
 }
 
@@ -1,5 +1,5 @@
 #pragma once
-#include <common/hooks/LowlevelKeyboardEvent.h>
+#include <common/hooks/LowlevelHookBroker.h>
 #include <common/utils/EventWaiter.h>
 #include <keyboardmanager/common/Input.h>
 #include "State.h"
@@ -32,11 +32,8 @@ private:
     // Contains the non localized module name
     std::wstring moduleName = KeyboardManagerConstants::ModuleName;
 
-    // Low level hook handles
-    static HHOOK hookHandle;
-
-    // Required for Unhook in old versions of Windows
-    static HHOOK hookHandleCopy;
+    // Subscription to the low level keyboard hook
+    static std::optional<LowlevelHookBroker::SubscriptionId> hookSubscription;
 
     // Static pointer to the current KeyboardManager object required for accessing the HandleKeyboardHookEvent function in the hook procedure
     // Only global or static variables can be accessed in a hook procedure CALLBACK
@@ -55,8 +52,8 @@ private:
 
     HANDLE editorIsRunningEvent = nullptr;
 
-    // Hook procedure definition
-    static LRESULT CALLBACK HookProc(int nCode, WPARAM wParam, LPARAM lParam);
+    // Hook procedure definition, returns true to suppress the event
+    static bool HookProc(LowlevelKeyboardEvent& event);
 
     // Load settings from the file.
     void LoadSettings();
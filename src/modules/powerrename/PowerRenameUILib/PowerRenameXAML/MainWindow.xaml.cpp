@@ -1081,9 +1081,13 @@ namespace winrt::PowerRenameUI::implementation
         RenamedCount(hstring{ std::to_wstring(m_renamingCount) });
     }
 
-    HRESULT MainWindow::OnRename(_In_ IPowerRenameItem* /*renameItem*/)
+    HRESULT MainWindow::OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** /*renameItems*/)
     {
-        UpdateCounts();
+        // The counts walk all the items, so they're updated once per batch of renamed items
+        if (itemCount > 0)
+        {
+            UpdateCounts();
+        }
         return S_OK;
     }
 
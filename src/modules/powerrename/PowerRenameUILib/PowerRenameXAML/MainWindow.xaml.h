@@ -61,7 +61,7 @@ namespace winrt::PowerRenameUI::implementation
                 return QISearch(this, qit, riid, ppv);
             }
 
-            HRESULT OnRename(_In_ IPowerRenameItem* renameItem) override { return m_app->OnRename(renameItem); }
+            HRESULT OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems) override { return m_app->OnRename(itemCount, renameItems); }
             HRESULT OnError(_In_ IPowerRenameItem* renameItem) override { return m_app->OnError(renameItem); }
             HRESULT OnRegExStarted(_In_ DWORD threadId) override { return m_app->OnRegExStarted(threadId); }
             HRESULT OnRegExCanceled(_In_ DWORD threadId) override { return m_app->OnRegExCanceled(threadId); }
@@ -113,7 +113,7 @@ namespace winrt::PowerRenameUI::implementation
         winrt::Windows::Foundation::Collections::IObservableVector<PowerRenameUI::PatternSnippet> m_RandomizerShortcuts;
 
         // Used by PowerRenameManagerEvents
-        HRESULT OnRename(_In_ IPowerRenameItem* renameItem);
+        HRESULT OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems);
         HRESULT OnError(_In_ IPowerRenameItem*) { return S_OK; }
         HRESULT OnRegExStarted(_In_ DWORD) { return S_OK; }
         HRESULT OnRegExCanceled(_In_ DWORD) { return S_OK; }
@@ -0,0 +1,177 @@
+#include "pch.h"
+
+#include "LiteralSearch.h"
+
+#if !defined(_M_ARM64)
+#include <intrin.h>
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // towlower of every UTF-16 code unit, the folding the search always used
+    const std::array<wchar_t, 0x10000>& foldTable()
+    {
+        static const auto table = [] {
+            std::array<wchar_t, 0x10000> folded{};
+            for (size_t c = 0; c < folded.size(); ++c)
+            {
+                folded[c] = static_cast<wchar_t>(::towlower(static_cast<wint_t>(c)));
+            }
+            return folded;
+        }();
+        return table;
+    }
+}
+
+LiteralSearcher::LiteralSearcher(std::wstring_view searchTerm, bool ignoreCase) :
+    term{ searchTerm }, caseInsensitive{ ignoreCase }
+{
+    if (term.empty())
+    {
+        return;
+    }
+
+    if (!caseInsensitive)
+    {
+        firstChars[0] = term[0];
+        firstCharCount = 1;
+        return;
+    }
+
+    const auto& fold = foldTable();
+    for (auto& c : term)
+    {
+        c = fold[c];
+    }
+
+    for (size_t c = 0; c < fold.size(); ++c)
+    {
+        if (fold[c] != term[0])
+        {
+            continue;
+        }
+        if (firstCharCount == maxFirstChars)
+        {
+            firstCharCount = 0;
+            break;
+        }
+        firstChars[firstCharCount++] = static_cast<wchar_t>(c);
+    }
+}
+
+size_t LiteralSearcher::find(std::wstring_view text, size_t pos) const
+{
+    if (term.empty() || pos > text.size() || text.size() - pos < term.size())
+    {
+        return std::wstring_view::npos;
+    }
+
+    // Last position a match can start at
+    const size_t last = text.size() - term.size();
+    for (size_t candidate = findFirstChar(text, pos, last); candidate != std::wstring_view::npos; candidate = findFirstChar(text, candidate + 1, last))
+    {
+        if (matchesAt(text, candidate))
+        {
+            return candidate;
+        }
+    }
+    return std::wstring_view::npos;
+}
+
+bool LiteralSearcher::replace(std::wstring_view text, std::wstring_view replacement, bool replaceAll, std::wstring& result) const
+{
+    bool replaced = false;
+    size_t copied = 0;
+    for (size_t match = find(text); match != std::wstring_view::npos; match = find(text, copied))
+    {
+        result.append(text.substr(copied, match - copied));
+        result.append(replacement);
+        copied = match + term.size();
+        replaced = true;
+        if (!replaceAll)
+        {
+            break;
+        }
+    }
+    result.append(text.substr(copied));
+    return replaced;
+}
+
+size_t LiteralSearcher::findFirstChar(std::wstring_view text, size_t from, size_t last) const
+{
+    if (from > last)
+    {
+        return std::wstring_view::npos;
+    }
+
+    size_t i = from;
+    if (firstCharCount == 0)
+    {
+        const auto& fold = foldTable();
+        for (; i <= last; ++i)
+        {
+            if (fold[text[i]] == term[0])
+            {
+                return i;
+            }
+        }
+        return std::wstring_view::npos;
+    }
+
+#if !defined(_M_ARM64)
+    std::array<__m128i, maxFirstChars> needles;
+    for (size_t k = 0; k < firstCharCount; ++k)
+    {
+        needles[k] = _mm_set1_epi16(static_cast<short>(firstChars[k]));
+    }
+
+    // Blocks of 8 characters that all could start a match
+    for (; i + 7 <= last; i += 8)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        __m128i equal = _mm_cmpeq_epi16(block, needles[0]);
+        for (size_t k = 1; k < firstCharCount; ++k)
+        {
+            equal = _mm_or_si128(equal, _mm_cmpeq_epi16(block, needles[k]));
+        }
+
+        if (const int mask = _mm_movemask_epi8(equal); mask != 0)
+        {
+            unsigned long bit;
+            _BitScanForward(&bit, static_cast<unsigned long>(mask));
+            return i + bit / 2;
+        }
+    }
+#endif
+
+    for (; i <= last; ++i)
+    {
+        for (size_t k = 0; k < firstCharCount; ++k)
+        {
+            if (text[i] == firstChars[k])
+            {
+                return i;
+            }
+        }
+    }
+    return std::wstring_view::npos;
+}
+
+bool LiteralSearcher::matchesAt(std::wstring_view text, size_t pos) const
+{
+    if (!caseInsensitive)
+    {
+        return text.compare(pos, term.size(), term) == 0;
+    }
+
+    const auto& fold = foldTable();
+    for (size_t j = 0; j < term.size(); ++j)
+    {
+        if (fold[text[pos + j]] != term[j])
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "pch.h"
+
+#include <array>
+#include <string_view>
+
+// Finds a search term as plain text, used when regular expressions are off. The term is case
+// folded once when the searcher is created. Candidates are found by comparing the characters
+// that can start a match against 8 characters at a time, then checked in full.
+struct LiteralSearcher
+{
+    LiteralSearcher() = default;
+    LiteralSearcher(std::wstring_view searchTerm, bool ignoreCase);
+
+    // Position of the first match starting at or after pos, npos if there's none
+    size_t find(std::wstring_view text, size_t pos = 0) const;
+
+    // Appends text to result with the first or every match replaced, returns whether a match was replaced
+    bool replace(std::wstring_view text, std::wstring_view replacement, bool replaceAll, std::wstring& result) const;
+
+    bool empty() const { return term.empty(); }
+
+private:
+    // A term starting with a character more forms fold to is filtered one character at a time
+    static constexpr size_t maxFirstChars = 4;
+
+    size_t findFirstChar(std::wstring_view text, size_t from, size_t last) const;
+    bool matchesAt(std::wstring_view text, size_t pos) const;
+
+    // Folded when the search is case insensitive
+    std::wstring term;
+    bool caseInsensitive = false;
+
+    // Every character that folds to the first character of the term
+    std::array<wchar_t, maxFirstChars> firstChars{};
+    size_t firstCharCount = 0;
+};
@@ -99,7 +99,8 @@ public:
 interface __declspec(uuid("87FC43F9-7634-43D9-99A5-20876AFCE4AD")) IPowerRenameManagerEvents : public IUnknown
 {
 public:
-    IFACEMETHOD(OnRename)(_In_ IPowerRenameItem * renameItem) = 0;
+    // Called with every item renamed since the previous call
+    IFACEMETHOD(OnRename)(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems) = 0;
     IFACEMETHOD(OnError)(_In_ IPowerRenameItem * renameItem) = 0;
     IFACEMETHOD(OnRegExStarted)(_In_ DWORD threadId) = 0;
     IFACEMETHOD(OnRegExCanceled)(_In_ DWORD threadId) = 0;
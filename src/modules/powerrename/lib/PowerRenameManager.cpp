@@ -506,7 +506,7 @@ HRESULT CPowerRenameManager::_Init()
 enum
 {
     SRM_REGEX_ITEM_UPDATED = (WM_APP + 1), // Single rename item processed by regex worker thread
-    SRM_REGEX_ITEM_RENAMED_KEEP_UI, // Single rename item processed by rename worker thread in case UI remains opened
+    SRM_REGEX_ITEM_RENAMED_KEEP_UI, // Rename items processed by rename worker thread in case UI remains opened, see _QueueRenamedItem
     SRM_REGEX_STARTED, // RegEx operation was started
     SRM_REGEX_CANCELED, // Regex operation was canceled
     SRM_REGEX_COMPLETE, // Regex worker thread completed
@@ -520,6 +520,8 @@ struct WorkerThreadData
     HANDLE cancelEvent = nullptr;
     HWND hwndParent = nullptr;
     CComPtr<IPowerRenameManager> spsrm;
+    // Same object as spsrm, used by the file operation worker thread to queue the renamed items
+    CPowerRenameManager* manager = nullptr;
 };
 
 // Msg-only worker window proc for communication from our worker threads
@@ -559,15 +561,9 @@ LRESULT CPowerRenameManager::_WndProc(_In_ HWND hwnd, _In_ UINT msg, _In_ WPARAM
         break;
     }
     case SRM_REGEX_ITEM_RENAMED_KEEP_UI:
-    {
-        int id = static_cast<int>(lParam);
-        CComPtr<IPowerRenameItem> spItem;
-        if (SUCCEEDED(GetItemById(id, &spItem)))
-        {
-            _OnRename(spItem);
-        }
+        _FlushRenamedItems();
         break;
-    }
+
     case SRM_REGEX_STARTED:
         _OnRegExStarted(static_cast<DWORD>(wParam));
         break;
@@ -688,6 +684,8 @@ HRESULT CPowerRenameManager::_PerformFileOperation()
             }
         }
 
+        // The worker thread may have exited before its last batch was handled
+        _FlushRenamedItems();
         _OnRenameCompleted();
     }
 
@@ -704,6 +702,7 @@ HRESULT CPowerRenameManager::_CreateFileOpWorkerThread()
         pwtd->startEvent = m_startRegExWorkerEvent;
         pwtd->cancelEvent = nullptr;
         pwtd->spsrm = this;
+        pwtd->manager = this;
         m_fileOpWorkerThreadHandle = CreateThread(nullptr, 0, s_fileOpWorkerThread, pwtd, 0, nullptr);
         hr = E_FAIL;
         if (m_fileOpWorkerThreadHandle)
@@ -719,6 +718,56 @@ HRESULT CPowerRenameManager::_CreateFileOpWorkerThread()
     return hr;
 }
 
+void CPowerRenameManager::_QueueRenamedItem(_In_ HWND hwndManager, _In_ int id)
+{
+    bool firstOfBatch = false;
+    {
+        CSRWExclusiveAutoLock lock(&m_lockRenamedItems);
+        firstOfBatch = m_renamedItemIds.empty();
+        m_renamedItemIds.push_back(id);
+    }
+
+    // Only one message is pending at a time. The items renamed while the UI thread is busy
+    // join the batch instead of being reported one by one.
+    if (firstOfBatch)
+    {
+        PostMessage(hwndManager, SRM_REGEX_ITEM_RENAMED_KEEP_UI, GetCurrentThreadId(), 0);
+    }
+}
+
+void CPowerRenameManager::_FlushRenamedItems()
+{
+    std::vector<int> renamedItemIds;
+    {
+        CSRWExclusiveAutoLock lock(&m_lockRenamedItems);
+        renamedItemIds.swap(m_renamedItemIds);
+    }
+
+    if (renamedItemIds.empty())
+    {
+        return;
+    }
+
+    std::vector<CComPtr<IPowerRenameItem>> items;
+    std::vector<IPowerRenameItem*> itemPointers;
+    items.reserve(renamedItemIds.size());
+    itemPointers.reserve(renamedItemIds.size());
+    for (const int id : renamedItemIds)
+    {
+        CComPtr<IPowerRenameItem> spItem;
+        if (SUCCEEDED(GetItemById(id, &spItem)))
+        {
+            itemPointers.push_back(spItem);
+            items.push_back(std::move(spItem));
+        }
+    }
+
+    if (!itemPointers.empty())
+    {
+        _OnRename(static_cast<UINT>(itemPointers.size()), itemPointers.data());
+    }
+}
+
 DWORD WINAPI CPowerRenameManager::s_fileOpWorkerThread(_In_ void* pv)
 {
     if (SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED | COINIT_DISABLE_OLE1DDE)))
@@ -810,7 +859,7 @@ DWORD WINAPI CPowerRenameManager::s_fileOpWorkerThread(_In_ void* pv)
 
                                                     int id = -1;
                                                     winrt::check_hresult(spItem->GetId(&id));
-                                                    PostMessage(pwtd->hwndManager, SRM_REGEX_ITEM_RENAMED_KEEP_UI, GetCurrentThreadId(), id);
+                                                    pwtd->manager->_QueueRenamedItem(pwtd->hwndManager, id);
                                                 }
                                             }
                                             CoTaskMemFree(newName);
@@ -1032,7 +1081,7 @@ void CPowerRenameManager::_ClearRegEx()
     }
 }
 
-void CPowerRenameManager::_OnRename(_In_ IPowerRenameItem* renameItem)
+void CPowerRenameManager::_OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems)
 {
     CSRWSharedAutoLock lock(&m_lockEvents);
 
@@ -1040,7 +1089,7 @@ void CPowerRenameManager::_OnRename(_In_ IPowerRenameItem* renameItem)
     {
         if (it.pEvents)
         {
-            it.pEvents->OnRename(renameItem);
+            it.pEvents->OnRename(itemCount, renameItems);
         }
     }
 }
@@ -62,7 +62,7 @@ protected:
 
     void _Cancel();
 
-    void _OnRename(_In_ IPowerRenameItem* renameItem);
+    void _OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems);
     void _OnError(_In_ IPowerRenameItem* renameItem);
     void _OnRegExStarted(_In_ DWORD threadId);
     void _OnRegExCanceled(_In_ DWORD threadId);
@@ -81,6 +81,10 @@ protected:
     void _WaitForRegExWorkerThread();
     HRESULT _CreateFileOpWorkerThread();
 
+    // Called by the file operation worker thread, the ids are reported in batches
+    void _QueueRenamedItem(_In_ HWND hwndManager, _In_ int id);
+    void _FlushRenamedItems();
+
     HRESULT _EnsureRegEx();
     HRESULT _InitRegEx();
     void _ClearRegEx();
@@ -104,6 +108,7 @@ protected:
 
     CSRWLock m_lockEvents;
     CSRWLock m_lockItems;
+    CSRWLock m_lockRenamedItems;
 
     DWORD m_flags = 0;
 
@@ -124,6 +129,8 @@ protected:
     _Guarded_by_(m_lockEvents) std::vector<RENAME_MGR_EVENT> m_powerRenameManagerEvents;
     _Guarded_by_(m_lockItems) std::map<int, IPowerRenameItem*> m_renameItems;
     _Guarded_by_(m_lockItems) std::vector<bool> m_isVisible;
+    // Renamed by the file operation worker thread and not reported yet
+    _Guarded_by_(m_lockRenamedItems) std::vector<int> m_renamedItemIds;
 
     // Parent HWND used by IFileOperation
     HWND m_hwndParent = nullptr;
@@ -107,6 +107,7 @@ IFACEMETHODIMP CPowerRenameRegEx::PutSearchTerm(_In_ PCWSTR searchTerm, bool for
             {
                 hr = SHStrDup(searchTerm, &m_searchTerm);
             }
+            _UpdateLiteralSearcher();
         }
     }
 
@@ -277,8 +278,16 @@ IFACEMETHODIMP CPowerRenameRegEx::PutFlags(_In_ DWORD flags)
             (!!(m_flags & EnumerateItems) != newEnumerate) ||
             (!!(m_flags & RandomizeItems) != newRandomizer);
 
+        const bool refreshLiteralSearcher = (m_flags & CaseSensitive) != (flags & CaseSensitive);
+
         m_flags = flags;
 
+        if (refreshLiteralSearcher)
+        {
+            CSRWExclusiveAutoLock lock(&m_lock);
+            _UpdateLiteralSearcher();
+        }
+
         if (refreshReplaceTerm)
         {
             CSRWExclusiveAutoLock lock(&m_lock);
@@ -394,14 +403,6 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, u
                 fileTimeErrorOccurred = true;
         }
 
-        std::wstring sourceToUse;
-        std::wstring originalSource;
-        sourceToUse.reserve(MAX_PATH);
-        originalSource.reserve(MAX_PATH);
-        sourceToUse = source;
-        originalSource = sourceToUse;
-
-        std::wstring searchTerm(m_searchTerm);
         std::wstring replaceTerm;
         if (m_useFileTime && !fileTimeErrorOccurred)
         {
@@ -494,26 +495,13 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, u
             replaceTerm = regex_replace(replaceTerm, otherGroupsRegex, L"$1$0$4");
 
             res = RegexReplaceDispatch[_useBoostLib](source, m_searchTerm, replaceTerm, m_flags & MatchAllOccurrences, !(m_flags & CaseSensitive));
-            replacedSomething = originalSource != res;
+            replacedSomething = source != res;
         }
         else
         {
-            // Simple search and replace
-            size_t pos = 0;
-            do
-            {
-                pos = _Find(sourceToUse, searchTerm, (!(m_flags & CaseSensitive)), pos);
-                if (pos != std::string::npos)
-                {
-                    res = sourceToUse.replace(pos, searchTerm.length(), replaceTerm);
-                    pos += replaceTerm.length();
-                    replacedSomething = true;
-                }
-                if (!(m_flags & MatchAllOccurrences))
-                {
-                    break;
-                }
-            } while (pos != std::string::npos);
+            // Simple search and replace, written into the buffer res already holds
+            res.clear();
+            replacedSomething = m_literalSearcher.replace(source, replaceTerm, m_flags & MatchAllOccurrences, res);
         }
         hr = SHStrDup(res.c_str(), result);
         if (replacedSomething)
@@ -526,17 +514,9 @@ HRESULT CPowerRenameRegEx::Replace(_In_ PCWSTR source, _Outptr_ PWSTR* result, u
     return hr;
 }
 
-size_t CPowerRenameRegEx::_Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos)
+void CPowerRenameRegEx::_UpdateLiteralSearcher()
 {
-    if (caseInsensitive)
-    {
-        // Convert to lower
-        std::transform(data.begin(), data.end(), data.begin(), ::towlower);
-        std::transform(toSearch.begin(), toSearch.end(), toSearch.begin(), ::towlower);
-    }
-
-    // Find sub string position in given string starting at position pos
-    return data.find(toSearch, pos);
+    m_literalSearcher = LiteralSearcher(m_searchTerm ? m_searchTerm : L"", !(m_flags & CaseSensitive));
 }
 
 void CPowerRenameRegEx::_OnSearchTermChanged()
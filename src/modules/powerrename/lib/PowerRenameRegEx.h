@@ -4,6 +4,8 @@
 
 #include "Enumerating.h"
 
+#include "LiteralSearch.h"
+
 #include "Randomizer.h"
 
 #include "PowerRenameInterfaces.h"
@@ -43,7 +45,8 @@ protected:
     void _OnFileTimeChanged();
     HRESULT _OnEnumerateOrRandomizeItemsChanged();
 
-    size_t _Find(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos);
+    // Call with m_lock held exclusively
+    void _UpdateLiteralSearcher();
 
     bool _useBoostLib = false;
     DWORD m_flags = DEFAULT_FLAGS;
@@ -51,6 +54,9 @@ protected:
     PWSTR m_replaceTerm = nullptr;
     std::wstring m_RawReplaceTerm; 
 
+    // The search term prepared for the search without regular expressions
+    LiteralSearcher m_literalSearcher;
+
     SYSTEMTIME m_fileTime = { 0 };
     bool m_useFileTime = false;
 
@@ -0,0 +1,154 @@
+#include "pch.h"
+#include <LiteralSearch.h>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace LiteralSearchTests
+{
+    // The search PowerRename did before, on lowercased copies
+    size_t LowercasedFind(std::wstring data, std::wstring toSearch, bool caseInsensitive, size_t pos)
+    {
+        if (caseInsensitive)
+        {
+            std::transform(data.begin(), data.end(), data.begin(), ::towlower);
+            std::transform(toSearch.begin(), toSearch.end(), toSearch.begin(), ::towlower);
+        }
+        return data.find(toSearch, pos);
+    }
+
+    std::wstring LowercasedReplace(std::wstring source, const std::wstring& searchTerm, const std::wstring& replaceTerm, bool caseInsensitive, bool replaceAll)
+    {
+        size_t pos = 0;
+        do
+        {
+            pos = LowercasedFind(source, searchTerm, caseInsensitive, pos);
+            if (pos != std::wstring::npos)
+            {
+                source.replace(pos, searchTerm.length(), replaceTerm);
+                pos += replaceTerm.length();
+            }
+            if (!replaceAll)
+            {
+                break;
+            }
+        } while (pos != std::wstring::npos);
+        return source;
+    }
+
+    TEST_CLASS (LiteralSearchTests)
+    {
+    public:
+        TEST_METHOD (FindMatchesLowercasedFind)
+        {
+            const std::wstring texts[] = {
+                L"",
+                L"a",
+                L"foo.txt",
+                L"FooBarFOOBARfoobar.txt",
+                L"a long file name with the term at the very end foo",
+                L"xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxFoO",
+                L"\u00c9t\u00e9 \u00e9T\u00c9 \u03a3\u03c3\u03c2 \u6587\u4ef6.txt",
+            };
+            const std::wstring terms[] = { L"f", L"foo", L"FOO", L"oob", L"txt", L"foo.txt", L"\u00e9t\u00e9", L"\u03c3", L"\u6587\u4ef6", L"not there" };
+
+            for (const auto& text : texts)
+            {
+                for (const auto& term : terms)
+                {
+                    for (const bool caseInsensitive : { false, true })
+                    {
+                        const LiteralSearcher searcher{ term, caseInsensitive };
+                        for (size_t pos = 0; pos <= text.size() + 1; pos++)
+                        {
+                            Assert::AreEqual(LowercasedFind(text, term, caseInsensitive, pos), searcher.find(text, pos), (text + L" / " + term).c_str());
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (ReplaceMatchesLowercasedReplace)
+        {
+            const std::wstring texts[] = { L"foo.txt", L"FooBarFOOBARfoobar.txt", L"bar.txt", L"foofoofoofoofoofoofoofoo", L"" };
+            for (const auto& text : texts)
+            {
+                for (const bool caseInsensitive : { false, true })
+                {
+                    for (const bool replaceAll : { false, true })
+                    {
+                        const LiteralSearcher searcher{ L"foo", caseInsensitive };
+                        std::wstring result;
+                        const bool replaced = searcher.replace(text, L"fo", replaceAll, result);
+
+                        const auto expected = LowercasedReplace(text, L"foo", L"fo", caseInsensitive, replaceAll);
+                        Assert::AreEqual(expected, result);
+                        Assert::AreEqual(LowercasedFind(text, L"foo", caseInsensitive, 0) != std::wstring::npos, replaced);
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD (EmptyTermNeverMatches)
+        {
+            const LiteralSearcher searcher;
+            Assert::IsTrue(searcher.empty());
+            Assert::AreEqual(std::wstring::npos, searcher.find(L"foo"));
+
+            std::wstring result;
+            Assert::IsFalse(searcher.replace(L"foo", L"bar", true, result));
+            Assert::AreEqual(std::wstring{ L"foo" }, result);
+        }
+
+        // Not part of the regular runs, use /TestCaseFilter:TestCategory=Benchmark
+        BEGIN_TEST_METHOD_ATTRIBUTE(ReplaceCostLiteralVsLowercasedCopies)
+            TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Benchmark")
+        END_TEST_METHOD_ATTRIBUTE()
+        TEST_METHOD (ReplaceCostLiteralVsLowercasedCopies)
+        {
+            constexpr int fileCount = 1000000;
+            std::vector<std::wstring> fileNames;
+            fileNames.reserve(fileCount);
+            for (int i = 0; i < fileCount; i++)
+            {
+                fileNames.push_back(std::format(L"Holiday pictures {:07} - IMG_{:07}.JPG", i / 100, i));
+            }
+
+            const std::wstring searchTerm = L"img_";
+            const std::wstring replaceTerm = L"Photo ";
+
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t lowercasedLength = 0;
+            for (const auto& fileName : fileNames)
+            {
+                lowercasedLength += LowercasedReplace(fileName, searchTerm, replaceTerm, true, true).size();
+            }
+            const auto lowercasedCost = std::chrono::high_resolution_clock::now() - start;
+
+            start = std::chrono::high_resolution_clock::now();
+            const LiteralSearcher searcher{ searchTerm, true };
+            std::wstring result;
+            size_t literalLength = 0;
+            for (const auto& fileName : fileNames)
+            {
+                result.clear();
+                searcher.replace(fileName, replaceTerm, true, result);
+                literalLength += result.size();
+            }
+            const auto literalCost = std::chrono::high_resolution_clock::now() - start;
+
+            using std::chrono::duration_cast;
+            using std::chrono::milliseconds;
+            Logger::WriteMessage(std::format(L"Case insensitive replace in {} file names: {} ms with lowercased copies, {} ms literal search\n",
+                                             fileCount,
+                                             duration_cast<milliseconds>(lowercasedCost).count(),
+                                             duration_cast<milliseconds>(literalCost).count())
+                                     .c_str());
+
+            Assert::AreEqual(lowercasedLength, literalLength);
+        }
+    };
+}
@@ -29,9 +29,13 @@ CMockPowerRenameManagerEvents::Release()
 }
 
 // IPowerRenameManagerEvents
-IFACEMETHODIMP CMockPowerRenameManagerEvents::OnRename(_In_ IPowerRenameItem* pItem)
+IFACEMETHODIMP CMockPowerRenameManagerEvents::OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems)
 {
-    m_itemRenamed = pItem;
+    m_renamedCount += itemCount;
+    if (itemCount > 0)
+    {
+        m_itemRenamed = renameItems[itemCount - 1];
+    }
     return S_OK;
 }
 
@@ -20,7 +20,7 @@ public:
     // IPowerRenameManagerEvents
     IFACEMETHODIMP OnItemAdded(_In_ IPowerRenameItem* renameItem);
     IFACEMETHODIMP OnUpdate(_In_ IPowerRenameItem* renameItem);
-    IFACEMETHODIMP OnRename(_In_ IPowerRenameItem* renameItem);
+    IFACEMETHODIMP OnRename(_In_ UINT itemCount, _In_reads_(itemCount) IPowerRenameItem** renameItems);
     IFACEMETHODIMP OnError(_In_ IPowerRenameItem* renameItem);
     IFACEMETHODIMP OnRegExStarted(_In_ DWORD threadId);
     IFACEMETHODIMP OnRegExCanceled(_In_ DWORD threadId);
@@ -33,6 +33,7 @@ public:
     }
 
     CComPtr<IPowerRenameItem> m_itemRenamed;
+    UINT m_renamedCount = 0;
     CComPtr<IPowerRenameItem> m_itemError;
     bool m_regExStarted = false;
     bool m_regExCanceled = false;
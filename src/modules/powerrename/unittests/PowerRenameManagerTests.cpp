@@ -31,7 +31,7 @@ namespace PowerRenameManagerTests
             int depth;
         };
 
-        void RenameHelper(_In_ rename_pairs * renamePairs, _In_ int numPairs, _In_ std::wstring searchTerm, _In_ std::wstring replaceTerm, SYSTEMTIME fileTime, _In_ DWORD flags)
+        void RenameHelper(_In_ rename_pairs * renamePairs, _In_ int numPairs, _In_ std::wstring searchTerm, _In_ std::wstring replaceTerm, SYSTEMTIME fileTime, _In_ DWORD flags, _In_ bool closeWindow = true)
         {
             // Create a single item (in a temp directory) and verify rename works as expected
             CTestFileHelper testFileHelper;
@@ -81,7 +81,7 @@ namespace PowerRenameManagerTests
             bool replaceSuccess = false;
             for (int step = 0; step < 20; step++)
             {
-                replaceSuccess = mgr->Rename(0, true) == S_OK;
+                replaceSuccess = mgr->Rename(0, closeWindow) == S_OK;
                 if (replaceSuccess)
                 {
                     break;
@@ -102,6 +102,17 @@ namespace PowerRenameManagerTests
                                (std::wstring(L"The path: [" + renamePairs[i].newName + L"] should ") + shouldRename[renamePairs[i].shouldRename] + L"exist.").c_str());
             }
 
+            if (!closeWindow)
+            {
+                // Every renamed item is reported, however the reports were batched
+                UINT renamedCount = 0;
+                for (int i = 0; i < numPairs; i++)
+                {
+                    renamedCount += renamePairs[i].shouldRename ? 1 : 0;
+                }
+                Assert::AreEqual(renamedCount, mockMgrEvents->m_renamedCount);
+            }
+
             Assert::IsTrue(mgr->Shutdown() == S_OK);
 
             mockMgrEvents->Release();
@@ -174,6 +185,21 @@ namespace PowerRenameManagerTests
             RenameHelper(renamePairs, ARRAYSIZE(renamePairs), L"foo", L"bar", SYSTEMTIME{ 2020, 7, 3, 22, 15, 6, 42, 453 }, DEFAULT_FLAGS);
         }
 
+        TEST_METHOD (VerifyMultiRenameKeepingUI)
+        {
+            // Keep the UI opened so the renamed items are reported to the events
+            rename_pairs renamePairs[] = {
+                { L"foo1.txt", L"bar1.txt", true, true, 0 },
+                { L"foo2.txt", L"bar2.txt", true, true, 0 },
+                { L"foo3.txt", L"bar3.txt", true, true, 0 },
+                { L"foo4.txt", L"bar4.txt", true, true, 0 },
+                { L"foo5.txt", L"bar5.txt", true, true, 0 },
+                { L"baa.txt", L"baa_norename.txt", true, false, 0 }
+            };
+
+            RenameHelper(renamePairs, ARRAYSIZE(renamePairs), L"foo", L"bar", SYSTEMTIME{ 2020, 7, 3, 22, 15, 6, 42, 453 }, DEFAULT_FLAGS, false);
+        }
+
         TEST_METHOD (VerifyFilesOnlyRename)
         {
             // Verify only files are renamed when folders match too
@@ -1,10 +1,15 @@
 #include "pch.h"
 #include "centralized_kb_hook.h"
 #include <common/debug_control.h>
+#include <common/hooks/HotkeyDispatch.h>
+#include <common/hooks/LowlevelHookBroker.h>
 #include <common/utils/winapi_error.h>
 #include <common/logger/logger.h>
 #include <common/interop/shared_constants.h>
 
+#include <atomic>
+#include <memory>
+
 namespace CentralizedKeyboardHook
 {
     struct HotkeyDescriptor
@@ -12,17 +17,8 @@ namespace CentralizedKeyboardHook
         Hotkey hotkey;
         std::wstring moduleName;
         std::function<bool()> action;
-
-        bool operator<(const HotkeyDescriptor& other) const
-        {
-            return hotkey < other.hotkey;
-        };
     };
 
-    std::multiset<HotkeyDescriptor> hotkeyDescriptors;
-    std::mutex mutex;
-    HHOOK hHook{};
-
     // To store information about handling pressed keys.
     struct PressedKeyDescriptor
     {
@@ -37,13 +33,31 @@ namespace CentralizedKeyboardHook
             return virtualKey < other.virtualKey;
         };
     };
-    std::multiset<PressedKeyDescriptor> pressedKeyDescriptors;
-    std::mutex pressedKeyMutex;
+
+    // Immutable snapshot of the registered actions, read by the hook and the timers. Every change
+    // publishes a new snapshot, so the hook never waits for a registration or allocates.
+    struct DispatchTable
+    {
+        HotkeyDispatch::Table<HotkeyDescriptor> hotkeys;
+        std::vector<PressedKeyDescriptor> pressedKeys; // sorted by virtual key
+    };
+
+    std::atomic<std::shared_ptr<const DispatchTable>> dispatchTable{ std::make_shared<const DispatchTable>() };
+
+    // The registered actions the dispatch table is built from, in registration order.
+    std::vector<HotkeyDescriptor> hotkeyDescriptors;
+    std::vector<PressedKeyDescriptor> pressedKeyDescriptors;
+    std::mutex mutex;
+    std::optional<LowlevelHookBroker::SubscriptionId> subscription;
 
     // keep track of last pressed key, to detect repeated keys and if there are more keys pressed.
     const DWORD VK_DISABLED = CommonSharedConstants::VK_DISABLED;
     DWORD vkCodePressed = VK_DISABLED;
 
+    // Modifier keys state, tracked from the events the hook receives instead of querying it on
+    // every key press. Only accessed from the hook thread.
+    HotkeyDispatch::ModifierState modifiers;
+
     // Save the runner window handle for registering timers.
     HWND runnerWindow;
 
@@ -55,6 +69,17 @@ namespace CentralizedKeyboardHook
         }
     } destroyOnExitObj;
 
+    // Must be called with the mutex held.
+    void PublishDispatchTable()
+    {
+        auto table = std::make_shared<DispatchTable>();
+        table->hotkeys = HotkeyDispatch::Table<HotkeyDescriptor>{ hotkeyDescriptors };
+        table->pressedKeys = pressedKeyDescriptors;
+        std::stable_sort(table->pressedKeys.begin(), table->pressedKeys.end());
+
+        dispatchTable.store(std::move(table));
+    }
+
     // Handle the pressed key proc
     void PressedKeyTimerProc(
         HWND hwnd,
@@ -62,13 +87,9 @@ namespace CentralizedKeyboardHook
         UINT_PTR idTimer,
         DWORD /*dwTime*/)
     {
-        std::multiset<PressedKeyDescriptor> copy;
-        {
-            // Make a copy, to look for the action to call.
-            std::unique_lock lock{ pressedKeyMutex };
-            copy = pressedKeyDescriptors;
-        }
-        for (const auto& it : copy)
+        // The snapshot stays valid even if an action changes the registrations.
+        const auto table = dispatchTable.load();
+        for (const auto& it : table->pressedKeys)
         {
             if (it.idTimer == idTimer)
             {
@@ -79,34 +100,33 @@ namespace CentralizedKeyboardHook
         KillTimer(hwnd, idTimer);
     }
 
-    LRESULT CALLBACK KeyboardHookProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
+    bool KeyboardHookProc(LowlevelKeyboardEvent& event)
     {
-        if (nCode < 0)
-        {
-            return CallNextHookEx(hHook, nCode, wParam, lParam);
-        }
+        const auto& keyPressInfo = *event.lParam;
+        const WPARAM wParam = event.wParam;
 
-        const auto& keyPressInfo = *reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
+        // Our own keystrokes change the keyboard state too.
+        modifiers.Update(keyPressInfo.vkCode, wParam);
 
         if (keyPressInfo.dwExtraInfo == PowertoyModuleIface::CENTRALIZED_KEYBOARD_HOOK_DONT_TRIGGER_FLAG)
         {
             // The new keystroke was generated from one of our actions. We should pass it along.
-            return CallNextHookEx(hHook, nCode, wParam, lParam);
+            return false;
         }
 
+        const auto table = dispatchTable.load();
+
         // Check if the keys are pressed.
-        if (!pressedKeyDescriptors.empty())
+        if (!table->pressedKeys.empty())
         {
             bool wasKeyPressed = vkCodePressed != VK_DISABLED;
-            // Hold the lock for the shortest possible duration
             if ((wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN))
             {
                 if (!wasKeyPressed)
                 {
                     // If no key was pressed before, let's start a timer to take into account this new key.
-                    std::unique_lock lock{ pressedKeyMutex };
                     PressedKeyDescriptor dummy{ .virtualKey = keyPressInfo.vkCode };
-                    auto [it, last] = pressedKeyDescriptors.equal_range(dummy);
+                    auto [it, last] = std::equal_range(table->pressedKeys.begin(), table->pressedKeys.end(), dummy);
                     for (; it != last; ++it)
                     {
                         SetTimer(runnerWindow, it->idTimer, it->millisecondsToPress, PressedKeyTimerProc);
@@ -115,9 +135,8 @@ namespace CentralizedKeyboardHook
                 else if (vkCodePressed != keyPressInfo.vkCode)
                 {
                     // If a different key was pressed, let's clear the timers we have started for the previous key.
-                    std::unique_lock lock{ pressedKeyMutex };
                     PressedKeyDescriptor dummy{ .virtualKey = vkCodePressed };
-                    auto [it, last] = pressedKeyDescriptors.equal_range(dummy);
+                    auto [it, last] = std::equal_range(table->pressedKeys.begin(), table->pressedKeys.end(), dummy);
                     for (; it != last; ++it)
                     {
                         KillTimer(runnerWindow, it->idTimer);
@@ -127,9 +146,8 @@ namespace CentralizedKeyboardHook
             }
             if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP)
             {
-                std::unique_lock lock{ pressedKeyMutex };
                 PressedKeyDescriptor dummy{ .virtualKey = keyPressInfo.vkCode };
-                auto [it, last] = pressedKeyDescriptors.equal_range(dummy);
+                auto [it, last] = std::equal_range(table->pressedKeys.begin(), table->pressedKeys.end(), dummy);
                 for (; it != last; ++it)
                 {
                     KillTimer(runnerWindow, it->idTimer);
@@ -140,37 +158,13 @@ namespace CentralizedKeyboardHook
 
         if ((wParam != WM_KEYDOWN) && (wParam != WM_SYSKEYDOWN))
         {
-            return CallNextHookEx(hHook, nCode, wParam, lParam);
-        }
-
-        Hotkey hotkey{
-            .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
-            .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
-            .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
-            .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
-            .key = static_cast<unsigned char>(keyPressInfo.vkCode)
-        };
-
-        if (hotkey == Hotkey{})
-        {
-            return CallNextHookEx(hHook, nCode, wParam, lParam);
-        }
-
-        std::function<bool()> action;
-        {
-            // Hold the lock for the shortest possible duration
-            std::unique_lock lock{ mutex };
-            HotkeyDescriptor dummy{ .hotkey = hotkey };
-            auto it = hotkeyDescriptors.find(dummy);
-            if (it != hotkeyDescriptors.end())
-            {
-                action = it->action;
-            }
+            return false;
         }
 
-        if (action)
+        const HotkeyDescriptor* descriptor = table->hotkeys.Match(modifiers, keyPressInfo.vkCode);
+        if (descriptor)
         {
-            if (action())
+            if (descriptor->action())
             {
                 // After invoking the hotkey send a dummy key to prevent Start Menu from activating
                 INPUT dummyEvent[1] = {};
@@ -180,18 +174,19 @@ namespace CentralizedKeyboardHook
                 SendInput(1, dummyEvent, sizeof(INPUT));
 
                 // Swallow the key press
-                return 1;
+                return true;
             }
         }
 
-        return CallNextHookEx(hHook, nCode, wParam, lParam);
+        return false;
     }
 
     void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& action) noexcept
     {
         Logger::trace(L"Register hotkey action for {}", moduleName);
         std::unique_lock lock{ mutex };
-        hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        hotkeyDescriptors.push_back({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        PublishDispatchTable();
     }
 
     void AddPressedKeyAction(const std::wstring& moduleName, const DWORD vk, const UINT milliseconds, std::function<bool()>&& action) noexcept
@@ -201,43 +196,18 @@ namespace CentralizedKeyboardHook
         const UINT upperId = hash & 0xFFFF;
         const UINT lowerId = vk & 0xFFFF; // The key to press can be the lower ID.
         const UINT timerId = upperId << 16 | lowerId;
-        std::unique_lock lock{ pressedKeyMutex };
-        pressedKeyDescriptors.insert({ .virtualKey = vk, .moduleName = moduleName, .action = std::move(action), .idTimer = timerId, .millisecondsToPress = milliseconds });
+        std::unique_lock lock{ mutex };
+        pressedKeyDescriptors.push_back({ .virtualKey = vk, .moduleName = moduleName, .action = std::move(action), .idTimer = timerId, .millisecondsToPress = milliseconds });
+        PublishDispatchTable();
     }
 
     void ClearModuleHotkeys(const std::wstring& moduleName) noexcept
     {
         Logger::trace(L"UnRegister hotkey action for {}", moduleName);
-        {
-            std::unique_lock lock{ mutex };
-            auto it = hotkeyDescriptors.begin();
-            while (it != hotkeyDescriptors.end())
-            {
-                if (it->moduleName == moduleName)
-                {
-                    it = hotkeyDescriptors.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-        }
-        {
-            std::unique_lock lock{ pressedKeyMutex };
-            auto it = pressedKeyDescriptors.begin();
-            while (it != pressedKeyDescriptors.end())
-            {
-                if (it->moduleName == moduleName)
-                {
-                    it = pressedKeyDescriptors.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-        }
+        std::unique_lock lock{ mutex };
+        std::erase_if(hotkeyDescriptors, [&](const HotkeyDescriptor& descriptor) { return descriptor.moduleName == moduleName; });
+        std::erase_if(pressedKeyDescriptors, [&](const PressedKeyDescriptor& descriptor) { return descriptor.moduleName == moduleName; });
+        PublishDispatchTable();
     }
 
     void Start() noexcept
@@ -249,10 +219,13 @@ namespace CentralizedKeyboardHook
 #endif
         if (!hook_disabled)
         {
-            if (!hHook)
+            if (!subscription)
             {
-                hHook = SetWindowsHookExW(WH_KEYBOARD_LL, KeyboardHookProc, NULL, NULL);
-                if (!hHook)
+                modifiers.Sync(HotkeyDispatch::IsKeyDown);
+
+                // Hotkey actions start modules, they may take longer than the default budget
+                subscription = LowlevelHookBroker::SubscribeKeyboard(L"Runner hotkeys", LowlevelHookBroker::Priority::Normal, KeyboardHookProc, std::chrono::milliseconds(50));
+                if (!subscription)
                 {
                     DWORD errorCode = GetLastError();
                     show_last_error_message(L"SetWindowsHookEx", errorCode, L"centralized_kb_hook");
@@ -263,9 +236,10 @@ namespace CentralizedKeyboardHook
 
     void Stop() noexcept
     {
-        if (hHook && UnhookWindowsHookEx(hHook))
+        if (subscription)
         {
-            hHook = NULL;
+            LowlevelHookBroker::Unsubscribe(*subscription);
+            subscription.reset();
         }
     }
 
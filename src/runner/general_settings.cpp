@@ -99,6 +99,10 @@ GeneralSettings get_general_settings()
     {
         settings.isModulesEnabledMap[name] = powertoy->is_enabled();
     }
+    for (const auto& name : deferred_powertoys())
+    {
+        settings.isModulesEnabledMap[name] = false;
+    }
 
     return settings;
 }
@@ -179,14 +183,20 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
                 continue;
             }
             const std::wstring name{ enabled_element.Key().c_str() };
-            const bool found = modules().find(name) != modules().end();
+            bool target_enabled = value.GetBoolean();
+
+            // Deferred modules are disabled, they're only loaded to be enabled
+            if (!target_enabled && is_powertoy_deferred(name))
+            {
+                continue;
+            }
+            PowertoyModule* found = find_powertoy(name);
             if (!found)
             {
                 continue;
             }
-            PowertoyModule& powertoy = modules().at(name);
+            PowertoyModule& powertoy = *found;
             const bool module_inst_enabled = powertoy->is_enabled();
-            bool target_enabled = value.GetBoolean();
 
             auto gpo_rule = powertoy->gpo_policy_enabled_configuration();
             if (gpo_rule == powertoys_gpo::gpo_rule_configured_enabled || gpo_rule == powertoys_gpo::gpo_rule_configured_disabled)
@@ -313,8 +323,10 @@ void start_enabled_powertoys()
         if (should_powertoy_be_enabled)
         {
             Logger::info(L"start_enabled_powertoys: Enabling powertoy {}", name);
+            const auto enableStart = std::chrono::steady_clock::now();
             powertoy->enable();
             powertoy.UpdateHotkeyEx();
+            Logger::info(L"Startup: enabled {} in {} ms", name, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - enableStart).count());
         }
     }
 }
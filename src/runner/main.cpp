@@ -179,22 +179,14 @@ int runner(bool isProcessElevated, bool openSettings, std::string settingsWindow
             L"PowerToys.ZoomItModuleInterface.dll",
         };
 
-        for (auto moduleSubdir : knownModules)
+        for (auto moduleSubdir : load_powertoys(knownModules))
         {
-            try
-            {
-                auto pt_module = load_powertoy(moduleSubdir);
-                modules().emplace(pt_module->get_key(), std::move(pt_module));
-            }
-            catch (...)
-            {
-                std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
-                errorMessage += moduleSubdir;
-                MessageBoxW(NULL,
-                            errorMessage.c_str(),
-                            L"PowerToys",
-                            MB_OK | MB_ICONERROR);
-            }
+            std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
+            errorMessage += moduleSubdir;
+            MessageBoxW(NULL,
+                        errorMessage.c_str(),
+                        L"PowerToys",
+                        MB_OK | MB_ICONERROR);
         }
         // Start initial powertoys
         start_enabled_powertoys();
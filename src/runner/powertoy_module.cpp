@@ -3,8 +3,130 @@
 #include "centralized_kb_hook.h"
 #include "centralized_hotkeys.h"
 #include <common/logger/logger.h>
+#include <common/SettingsAPI/settings_helpers.h>
+#include <common/utils/gpo.h>
 #include <common/utils/winapi_error.h>
 
+#include <atomic>
+#include <filesystem>
+
+namespace
+{
+    // Loading a module DLL is mostly reading it and its dependencies from disk
+    constexpr unsigned int MAX_PARALLEL_MODULE_LOADS = 4;
+
+    // The key and the default enabled state of each module DLL, as seen on the last run.
+    // A module's key is only known once it's loaded, so this is what allows deferring it.
+    constexpr inline const wchar_t* MODULE_CATALOG_FILENAME = L"module_catalog.json";
+    constexpr inline const wchar_t* MODULE_CATALOG_KEY = L"key";
+    constexpr inline const wchar_t* MODULE_CATALOG_ENABLED_BY_DEFAULT = L"enabled_by_default";
+
+    // Modules that are disabled and weren't loaded at startup, by key, with their filename
+    std::map<std::wstring, std::wstring>& deferred_modules()
+    {
+        static std::map<std::wstring, std::wstring> deferred;
+        return deferred;
+    }
+
+    std::wstring get_module_catalog_path()
+    {
+        std::filesystem::path catalogPath(PTSettingsHelper::get_root_save_folder_location());
+        catalogPath.append(MODULE_CATALOG_FILENAME);
+        return catalogPath.wstring();
+    }
+
+    json::JsonObject& module_catalog()
+    {
+        static json::JsonObject catalog = json::from_file(get_module_catalog_path()).value_or(json::JsonObject{});
+        return catalog;
+    }
+
+    // Returns true if the catalog entry of the module changed
+    bool update_module_catalog(const std::wstring_view filename, PowertoyModule& powertoy)
+    {
+        const std::wstring key{ powertoy->get_key() };
+        const bool enabledByDefault = powertoy->is_enabled_by_default();
+        const auto entry = module_catalog().GetNamedObject(filename, json::JsonObject{});
+        if (entry.GetNamedString(MODULE_CATALOG_KEY, L"") == key && json::has(entry, MODULE_CATALOG_ENABLED_BY_DEFAULT, json::JsonValueType::Boolean) && entry.GetNamedBoolean(MODULE_CATALOG_ENABLED_BY_DEFAULT) == enabledByDefault)
+        {
+            return false;
+        }
+
+        json::JsonObject updated;
+        updated.SetNamedValue(MODULE_CATALOG_KEY, json::value(key));
+        updated.SetNamedValue(MODULE_CATALOG_ENABLED_BY_DEFAULT, json::value(enabledByDefault));
+        module_catalog().SetNamedValue(filename, updated);
+        return true;
+    }
+
+    void save_module_catalog()
+    {
+        try
+        {
+            json::to_file(get_module_catalog_path(), module_catalog());
+        }
+        catch (...)
+        {
+            Logger::error(L"Failed to save the module catalog");
+        }
+    }
+
+    // Only the module knows which policy is its own, so deferring is off while a policy enables utilities
+    bool policy_enables_utilities()
+    {
+        constexpr std::wstring_view utilityPolicyPrefix = L"ConfigureEnabledUtility";
+        const auto snapshot = powertoys_gpo::getPolicySnapshot();
+        for (const auto* policies : { &snapshot->machine_policies, &snapshot->user_policies })
+        {
+            for (const auto& value : policies->values)
+            {
+                const bool enabledPolicy = _wcsnicmp(value.name.c_str(), utilityPolicyPrefix.data(), utilityPolicyPrefix.size()) == 0 ||
+                                           _wcsicmp(value.name.c_str(), powertoys_gpo::POLICY_CONFIGURE_ENABLED_GLOBAL_ALL_UTILITIES.c_str()) == 0;
+                if (enabledPolicy && policies->dword_value(value.name) == 1)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Returns the key of the module if the catalog knows it and the general settings disable it
+    std::optional<std::wstring> get_disabled_module_key(const std::wstring_view filename, const json::JsonObject& enabledModules)
+    {
+        const auto entry = module_catalog().GetNamedObject(filename, json::JsonObject{});
+        const std::wstring key{ entry.GetNamedString(MODULE_CATALOG_KEY, L"") };
+        if (key.empty())
+        {
+            return std::nullopt;
+        }
+
+        const bool enabled = json::has(enabledModules, key, json::JsonValueType::Boolean) ? enabledModules.GetNamedBoolean(key) : entry.GetNamedBoolean(MODULE_CATALOG_ENABLED_BY_DEFAULT, true);
+        if (enabled)
+        {
+            return std::nullopt;
+        }
+        return key;
+    }
+
+    PowertoyModule create_powertoy(HMODULE handle)
+    {
+        auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
+        if (!create)
+        {
+            FreeLibrary(handle);
+            winrt::throw_last_error();
+        }
+        auto pt_module = create();
+        if (!pt_module)
+        {
+            FreeLibrary(handle);
+            winrt::throw_hresult(winrt::hresult(E_POINTER));
+        }
+        return PowertoyModule(pt_module, handle);
+    }
+}
+
 std::map<std::wstring, PowertoyModule>& modules()
 {
     static std::map<std::wstring, PowertoyModule> modules;
@@ -14,19 +136,189 @@ std::map<std::wstring, PowertoyModule>& modules()
 PowertoyModule load_powertoy(const std::wstring_view filename)
 {
     auto handle = winrt::check_pointer(LoadLibraryW(filename.data()));
-    auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
-    if (!create)
+    return create_powertoy(handle);
+}
+
+std::vector<std::wstring_view> load_powertoys(const std::vector<std::wstring_view>& allFilenames)
+{
+    using namespace std::chrono;
+
+    struct LoadedLibrary
+    {
+        HMODULE handle = nullptr;
+        DWORD error = ERROR_SUCCESS;
+        milliseconds loadTime{};
+    };
+
+    const auto start = steady_clock::now();
+
+    json::JsonObject enabledModules;
+    try
     {
-        FreeLibrary(handle);
-        winrt::throw_last_error();
+        enabledModules = PTSettingsHelper::load_general_settings().GetNamedObject(L"enabled", json::JsonObject{});
     }
-    auto pt_module = create();
-    if (!pt_module)
+    catch (...)
+    {
+    }
+
+    // Disabled modules are loaded when they get enabled or when their settings are needed
+    std::vector<std::wstring_view> filenames;
+    const bool canDefer = !policy_enables_utilities();
+    for (const auto filename : allFilenames)
+    {
+        if (auto key = canDefer ? get_disabled_module_key(filename, enabledModules) : std::nullopt)
+        {
+            Logger::info(L"Startup: deferred loading {}, {} is disabled", filename, *key);
+            deferred_modules().emplace(std::move(*key), filename);
+        }
+        else
+        {
+            filenames.push_back(filename);
+        }
+    }
+
+    // Only the DLLs are loaded in parallel. The modules are created on this thread in the
+    // given order, since their constructors register hotkeys and may rely on its COM apartment.
+    std::vector<LoadedLibrary> libraries(filenames.size());
+    std::atomic_size_t nextLibrary = 0;
+    auto loadLibraries = [&] {
+        for (size_t i = nextLibrary++; i < filenames.size(); i = nextLibrary++)
+        {
+            const auto loadStart = steady_clock::now();
+            libraries[i].handle = LoadLibraryW(filenames[i].data());
+            if (!libraries[i].handle)
+            {
+                libraries[i].error = GetLastError();
+            }
+            libraries[i].loadTime = duration_cast<milliseconds>(steady_clock::now() - loadStart);
+        }
+    };
+
+    const size_t workerCount = (std::min)({ static_cast<size_t>((std::max)(std::thread::hardware_concurrency(), 1u)),
+                                            static_cast<size_t>(MAX_PARALLEL_MODULE_LOADS),
+                                            filenames.size() });
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; ++i)
+    {
+        workers.emplace_back(loadLibraries);
+    }
+    loadLibraries();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    const auto librariesLoaded = steady_clock::now();
+
+    // Roughly what reading the DLLs one after another costs, to compare with the parallel time
+    milliseconds sequentialLoadTime{};
+    for (const auto& library : libraries)
+    {
+        sequentialLoadTime += library.loadTime;
+    }
+
+    std::vector<std::wstring_view> failed;
+    bool catalogChanged = false;
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        try
+        {
+            if (!libraries[i].handle)
+            {
+                winrt::throw_hresult(HRESULT_FROM_WIN32(libraries[i].error));
+            }
+
+            const auto createStart = steady_clock::now();
+            auto pt_module = create_powertoy(libraries[i].handle);
+            Logger::info(L"Startup: loaded {} in {} ms, created in {} ms",
+                         filenames[i],
+                         libraries[i].loadTime.count(),
+                         duration_cast<milliseconds>(steady_clock::now() - createStart).count());
+            catalogChanged |= update_module_catalog(filenames[i], pt_module);
+            modules().emplace(pt_module->get_key(), std::move(pt_module));
+        }
+        catch (...)
+        {
+            Logger::error(L"Startup: failed to load {}", filenames[i]);
+            failed.push_back(filenames[i]);
+        }
+    }
+
+    if (catalogChanged)
+    {
+        save_module_catalog();
+    }
+
+    Logger::info(L"Startup: loaded {} of {} modules in {} ms ({} ms reading DLLs on {} threads, {} ms summed over the DLLs), {} deferred",
+                 modules().size(),
+                 filenames.size(),
+                 duration_cast<milliseconds>(steady_clock::now() - start).count(),
+                 duration_cast<milliseconds>(librariesLoaded - start).count(),
+                 workerCount,
+                 sequentialLoadTime.count(),
+                 deferred_modules().size());
+    return failed;
+}
+
+PowertoyModule* find_powertoy(const std::wstring& key)
+{
+    using namespace std::chrono;
+
+    if (auto it = modules().find(key); it != modules().end())
+    {
+        return &it->second;
+    }
+
+    auto deferredIt = deferred_modules().find(key);
+    if (deferredIt == deferred_modules().end())
+    {
+        return nullptr;
+    }
+
+    const auto filename = std::move(deferredIt->second);
+    deferred_modules().erase(deferredIt);
+    try
+    {
+        const auto loadStart = steady_clock::now();
+        auto pt_module = load_powertoy(filename);
+        Logger::info(L"Loaded deferred {} in {} ms", filename, duration_cast<milliseconds>(steady_clock::now() - loadStart).count());
+        if (update_module_catalog(filename, pt_module))
+        {
+            save_module_catalog();
+        }
+
+        // The key comes from the last run, an updated module could have changed it
+        auto [it, inserted] = modules().emplace(pt_module->get_key(), std::move(pt_module));
+        return it->first == key ? &it->second : nullptr;
+    }
+    catch (...)
+    {
+        Logger::error(L"Failed to load deferred {}", filename);
+        return nullptr;
+    }
+}
+
+void load_deferred_powertoys()
+{
+    while (!deferred_modules().empty())
+    {
+        find_powertoy(deferred_modules().begin()->first);
+    }
+}
+
+bool is_powertoy_deferred(const std::wstring& key)
+{
+    return deferred_modules().contains(key);
+}
+
+std::vector<std::wstring> deferred_powertoys()
+{
+    std::vector<std::wstring> keys;
+    for (const auto& [key, filename] : deferred_modules())
     {
-        FreeLibrary(handle);
-        winrt::throw_hresult(winrt::hresult(E_POINTER));
+        keys.push_back(key);
     }
-    return PowertoyModule(pt_module, handle);
+    return keys;
 }
 
 json::JsonObject PowertoyModule::json_config() const
@@ -50,4 +50,19 @@ private:
 };
 
 PowertoyModule load_powertoy(const std::wstring_view filename);
+
+// Loads the module DLLs in parallel and adds the created modules to modules().
+// Modules that the general settings disable are deferred instead, if the last run recorded their key.
+// Returns the filenames of the modules that failed to load.
+std::vector<std::wstring_view> load_powertoys(const std::vector<std::wstring_view>& filenames);
 std::map<std::wstring, PowertoyModule>& modules();
+
+// Returns the module with the given key, loading it first if it was deferred, or nullptr.
+PowertoyModule* find_powertoy(const std::wstring& key);
+
+// Loads all the deferred modules, for the code that needs the settings of every module.
+void load_deferred_powertoys();
+
+// Deferred modules are disabled and aren't in modules() until they're loaded.
+bool is_powertoy_deferred(const std::wstring& key);
+std::vector<std::wstring> deferred_powertoys();
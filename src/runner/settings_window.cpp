@@ -39,6 +39,8 @@ HANDLE g_terminateSettingsEvent = CreateEventW(nullptr, false, false, CommonShar
 
 json::JsonObject get_power_toys_settings()
 {
+    load_deferred_powertoys();
+
     json::JsonObject result;
     for (const auto& [name, powertoy] : modules())
     {
@@ -137,10 +139,10 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
             {
             }
         }
-        else if (modules().find(name) != modules().end())
+        else if (auto powertoy = find_powertoy(name))
         {
             const auto element = powertoy_element.Value().Stringify();
-            modules().at(name)->call_custom_action(element.c_str());
+            (*powertoy)->call_custom_action(element.c_str());
         }
     }
 
@@ -149,12 +151,11 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
 
 void send_json_config_to_module(const std::wstring& module_key, const std::wstring& settings)
 {
-    auto moduleIt = modules().find(module_key);
-    if (moduleIt != modules().end())
+    if (auto powertoy = find_powertoy(module_key))
     {
-        moduleIt->second->set_config(settings.c_str());
-        moduleIt->second.update_hotkeys();
-        moduleIt->second.UpdateHotkeyEx();
+        (*powertoy)->set_config(settings.c_str());
+        powertoy->update_hotkeys();
+        powertoy->UpdateHotkeyEx();
     }
 }
 
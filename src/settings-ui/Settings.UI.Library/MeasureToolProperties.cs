@@ -23,6 +23,7 @@ namespace Microsoft.PowerToys.Settings.UI.Library
             ContinuousCapture = false;
             DrawFeetOnCross = true;
             PerColorChannelEdgeDetection = false;
+            PrecomputeEdges = false;
             MeasureCrossColor = new StringProperty("#FF4500");
             DefaultMeasureStyle = new IntProperty((int)MeasureToolMeasureStyle.None);
         }
@@ -38,6 +39,9 @@ namespace Microsoft.PowerToys.Settings.UI.Library
         [JsonConverter(typeof(BoolPropertyJsonConverter))]
         public bool PerColorChannelEdgeDetection { get; set; }
 
+        [JsonConverter(typeof(BoolPropertyJsonConverter))]
+        public bool PrecomputeEdges { get; set; }
+
         public IntProperty UnitsOfMeasure { get; set; }
 
         public IntProperty PixelTolerance { get; set; }
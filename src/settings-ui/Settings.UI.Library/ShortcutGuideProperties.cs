@@ -21,6 +21,7 @@ namespace Microsoft.PowerToys.Settings.UI.Library
             PressTimeForTaskbarIconShortcuts = new IntProperty(900);
             Theme = new StringProperty("system");
             DisabledApps = new StringProperty();
+            KeepOverlayResident = new BoolProperty(false);
             OpenShortcutGuide = DefaultOpenShortcutGuide;
         }
 
@@ -44,5 +45,8 @@ namespace Microsoft.PowerToys.Settings.UI.Library
 
         [JsonPropertyName("disabled_apps")]
         public StringProperty DisabledApps { get; set; }
+
+        [JsonPropertyName("keep_overlay_resident")]
+        public BoolProperty KeepOverlayResident { get; set; }
     }
 }
@@ -160,6 +160,23 @@ namespace Microsoft.PowerToys.Settings.UI.ViewModels
             }
         }
 
+        public bool PrecomputeEdges
+        {
+            get
+            {
+                return Settings.Properties.PrecomputeEdges;
+            }
+
+            set
+            {
+                if (Settings.Properties.PrecomputeEdges != value)
+                {
+                    Settings.Properties.PrecomputeEdges = value;
+                    NotifyPropertyChanged();
+                }
+            }
+        }
+
         public int UnitsOfMeasure
         {
             get
@@ -55,6 +55,7 @@ namespace Microsoft.PowerToys.Settings.UI.ViewModels
             _pressTimeForTaskbarIconShortcuts = Settings.Properties.PressTimeForTaskbarIconShortcuts.Value;
             _opacity = Settings.Properties.OverlayOpacity.Value;
             _disabledApps = Settings.Properties.DisabledApps.Value;
+            _keepOverlayResident = Settings.Properties.KeepOverlayResident.Value;
 
             switch (Settings.Properties.Theme.Value)
             {
@@ -87,6 +88,7 @@ namespace Microsoft.PowerToys.Settings.UI.ViewModels
         private int _pressTimeForGlobalWindowsShortcuts;
         private int _pressTimeForTaskbarIconShortcuts;
         private int _opacity;
+        private bool _keepOverlayResident;
 
         public bool IsEnabled
         {
@@ -163,6 +165,24 @@ namespace Microsoft.PowerToys.Settings.UI.ViewModels
             }
         }
 
+        public bool KeepOverlayResident
+        {
+            get
+            {
+                return _keepOverlayResident;
+            }
+
+            set
+            {
+                if (_keepOverlayResident != value)
+                {
+                    _keepOverlayResident = value;
+                    Settings.Properties.KeepOverlayResident.Value = value;
+                    NotifyPropertyChanged();
+                }
+            }
+        }
+
         public int OverlayOpacity
         {
             get